@@ -0,0 +1,725 @@
+/******************************************************************************
+ * File: benchmark.cpp
+ * Description: microbenchmarks of state generation parts.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "concurrent_store.h"
+#include "frontier.h"
+#include "lts_writer.h"
+#include "output_writer.h"
+#include "parallel_explorer.h"
+#include "program.h"
+#include "state_codec.h"
+#include "state_dump.h"
+#include "visited_store.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+#ifdef SPECIALIZED_MODELS
+// models are generated by model_compiler before build, see README
+#include "task_model.h"
+#include "generated_model.h"
+#endif
+using namespace std;
+
+const char* Info = "Usage: <binary name> <benchmark> [number]\n"
+                   "Benchmarks:\n"
+                   "visited [lookups]: std::set against VisitedStore on packed states\n"
+                   "threads [max threads]: scaling of ParallelExplorer from 1 thread\n"
+                   "output [lines]: printing of states with endl against OutputWriter\n"
+                   "dump [states]: writing and reading of text against binary file\n"
+                   "lts [edges]: writing of lts in dot, aut and binary formats against\n"
+                   "    lookups of target states in VisitedStore\n"
+                   "program [threads]: prints generated program of several threads (3 by\n"
+                   "    default), which is larger than task.txt\n"
+                   "symmetry [threads]: exploration of replicas of one thread of generated\n"
+                   "    program (3 by default) with and without symmetry reduction\n"
+                   "specialized [repeats]: exploration by models, generated by model_compiler,\n"
+                   "    against interpreted programs, build with -DSPECIALIZED_MODELS\n\n"
+                   "Author: Valery Bitsoev. March 2013\n";
+
+/**
+ * @brief checks is string consist of only digits
+ * @param string - string to check
+ */
+bool isNumber(char * string)
+{
+    for(int i=0;string[i]!='\0';i++)
+        if(!isdigit(string[i]))
+            return false;
+    return true;
+}
+
+/**
+ * @brief current time in seconds
+ */
+double Now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief makes packed states with counters and global variable for lookups,
+ * every state is met twice in average
+ * @param number - number of lookups
+ */
+vector<uint64_t> MakeStates(size_t number)
+{
+    int range = number / 2 / (12 * 18) + 1;
+    StateLayout layout;
+    size_t f_counter = layout.AddCounter("f.counter", 11);
+    size_t g_counter = layout.AddCounter("g.counter", 17);
+    size_t h = layout.AddVariable("h", 0, range);
+    vector<uint64_t> states;
+    states.reserve(number);
+    srand(47);
+    for(size_t i = 0; i < number; ++i)
+    {
+        PackedState state;
+        layout.Clear(state);
+        layout.Set(state, f_counter, rand() % 12);
+        layout.Set(state, g_counter, rand() % 18);
+        layout.Set(state, h, rand() % range);
+        states.push_back(state.words[0]);
+    }
+    return states;
+}
+
+/**
+ * @brief compares std::set with count and insert against
+ * VisitedStore with single find-or-insert
+ * @param number - number of lookups
+ */
+void BenchVisited(size_t number)
+{
+    vector<uint64_t> states = MakeStates(number);
+
+    double start = Now();
+    set<uint64_t> old;
+    size_t set_new = 0;
+    for(size_t i = 0; i < states.size(); ++i)
+    {
+        if(old.count(states[i]) != 0)
+            continue;
+        old.insert(states[i]);
+        ++set_new;
+    }
+    double set_time = Now() - start;
+
+    start = Now();
+    VisitedStore store(1, 1024, 0.7);
+    size_t store_new = 0;
+    for(size_t i = 0; i < states.size(); ++i)
+    {
+        if(store.FindOrInsert(&states[i]))
+            ++store_new;
+    }
+    double store_time = Now() - start;
+
+    cout<<"lookups: "<<number<<", new states: "<<set_new<<" / "<<store_new<<endl;
+    cout<<"std::set:     "<<set_time<<" s, "<<number / set_time / 1e6<<" Mlookups/s"<<endl;
+    cout<<"VisitedStore: "<<store_time<<" s, "<<number / store_time / 1e6<<" Mlookups/s, ";
+    cout<<store.Capacity() * (sizeof(uint64_t) + sizeof(uint32_t) + 1) / store_new<<" bytes per state"<<endl;
+}
+
+/**
+ * @brief synthetic model: independent counters, every step increments one of them
+ */
+class CounterModel
+{
+public:
+/**
+ * @brief class constructor
+ * @param counters - number of counters
+ * @param max - maximal value of counter
+ */
+    CounterModel(size_t counters, int max):m_layout()
+                                          ,m_store(1, size_t(pow(max + 1.0, double(counters))))
+    {
+        for(size_t i = 0; i < counters; ++i)
+            m_layout.AddCounter("counter", max);
+        assert(m_layout.Words() == 1);
+        m_max = max;
+    }
+
+/**
+ * @brief stores state and makes its successors
+ * @param worker - number of thread
+ * @param state - generated state
+ * @param next - place for successors
+ */
+    void Expand(size_t /*worker*/, const PackedState& state, vector<PackedState>& next)
+    {
+        if(!m_store.FindOrInsert(state.words))
+            return;
+        for(size_t i = 0; i < m_layout.Fields(); ++i)
+        {
+            int value = m_layout.Value(state, i);
+            if(value == m_max)
+                continue;
+            next.push_back(state);
+            m_layout.Set(next.back(), i, value + 1);
+        }
+    }
+
+/**
+ * @brief number of generated states
+ */
+    size_t States() const
+    {
+        return m_store.Size();
+    }
+private:
+/**
+ * @brief placement of counters
+ */
+    StateLayout m_layout;
+
+/**
+ * @brief generated states
+ */
+    ConcurrentStore m_store;
+
+/**
+ * @brief maximal value of counter
+ */
+    int m_max;
+};
+
+/**
+ * @brief explores synthetic model by 1, 2, 4 ... threads
+ * @param max_threads - maximal number of threads
+ */
+void BenchThreads(size_t max_threads)
+{
+    double single_time = 0;
+    for(size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        CounterModel model(6, 11);
+        PackedState initial;
+        memset(&initial, 0, sizeof(initial));
+        double start = Now();
+        ParallelExplorer<PackedState, CounterModel> explorer(model, threads);
+        explorer.Run(initial);
+        double time = Now() - start;
+        if(threads == 1)
+            single_time = time;
+        cout<<"threads: "<<threads<<", states: "<<model.States()<<", "<<time<<" s, ";
+        cout<<model.States() / time / 1e6<<" Mstates/s, speedup "<<single_time / time<<endl;
+    }
+}
+
+/**
+ * @brief file, written by output benchmark
+ */
+const char* OutputFile = "benchmark_output.txt";
+
+/**
+ * @brief compares printing of states to file by stream with endl after
+ * every line against buffered OutputWriter, files should be equal
+ * @param number - number of lines
+ */
+void BenchOutput(size_t number)
+{
+    vector<uint64_t> words = MakeStates(number);
+    StateLayout layout;
+    layout.AddCounter("f.counter", 11);
+    layout.AddCounter("g.counter", 17);
+    layout.AddVariable("h", 0, number / 2 / (12 * 18) + 1);
+    vector<PackedState> states(number);
+    for(size_t i = 0; i < number; ++i)
+    {
+        memset(&states[i], 0, sizeof(states[i]));
+        states[i].words[0] = words[i];
+    }
+
+    double start = Now();
+    {
+        ofstream file(OutputFile);
+        for(size_t i = 0; i < number; ++i)
+        {
+            layout.Print(file, states[i], ", ");
+            file<<endl;
+        }
+    }
+    double stream_time = Now() - start;
+    ifstream stream_file(OutputFile, ios::binary | ios::ate);
+    streamoff stream_size = stream_file.tellg();
+    stream_file.close();
+
+    start = Now();
+    {
+        ofstream file(OutputFile);
+        OutputWriter writer(file, false);
+        for(size_t i = 0; i < number; ++i)
+        {
+            layout.Print(writer.Buffer(), states[i], ", ");
+            writer.EndLine();
+        }
+    }
+    double writer_time = Now() - start;
+    ifstream writer_file(OutputFile, ios::binary | ios::ate);
+    streamoff writer_size = writer_file.tellg();
+    writer_file.close();
+    remove(OutputFile);
+
+    cout<<"lines: "<<number<<", bytes: "<<stream_size<<" / "<<writer_size<<endl;
+    cout<<"stream with endl: "<<stream_time<<" s, "<<number / stream_time / 1e6<<" Mlines/s"<<endl;
+    cout<<"OutputWriter:     "<<writer_time<<" s, "<<number / writer_time / 1e6<<" Mlines/s"<<endl;
+}
+
+/**
+ * @brief writes states to file as text or binary records
+ * @param layout - placement of variables in packed state
+ * @param states - states to write
+ * @param format - 0 for text, 1 for binary file, 2 for compressed binary file
+ */
+void WriteStates(const StateLayout& layout, const vector<PackedState>& states, int format)
+{
+    ofstream file(OutputFile, ios::binary);
+    OutputWriter writer(file, false);
+    DumpEncoder encoder(layout.Words(), format == 2);
+    if(format != 0)
+        AppendDumpHeader(writer.Buffer(), layout, format == 2);
+    for(size_t i = 0; i < states.size(); ++i)
+    {
+        if(format == 0)
+        {
+            layout.Print(writer.Buffer(), states[i], ", ");
+            writer.EndLine();
+        }
+        else
+        {
+            encoder.Append(writer.Buffer(), states[i]);
+            writer.Commit();
+        }
+    }
+    encoder.EndBlock(writer.Buffer());
+    writer.Finish();
+    if(format != 0)
+        WriteDumpRecords(file, states.size());
+}
+
+/**
+ * @brief reads states from file, written by WriteStates
+ * @param layout - placement of variables in packed state
+ * @param format - 0 for text, otherwise binary file
+ * @return sum of values of all fields, to compare read states
+ */
+uint64_t ReadStates(const StateLayout& layout, int format)
+{
+    uint64_t sum = 0;
+    if(format == 0)
+    {
+        ifstream file(OutputFile);
+        string line;
+        while(getline(file, line))
+        {
+            const char* text = line.c_str();
+            for(size_t i = 0; i < layout.Fields(); ++i)
+            {
+                char* end;
+                sum += strtol(text, &end, 10);
+                text = end + (*end == ',' ? 2 : 0);
+            }
+        }
+        return sum;
+    }
+    DumpReader reader;
+    if(!reader.Open(OutputFile))
+        return 0;
+    PackedState state;
+    while(reader.Next(state))
+        for(size_t i = 0; i < layout.Fields(); ++i)
+            sum += layout.Value(state, i);
+    return sum;
+}
+
+/**
+ * @brief compares writing and reading of text against binary file
+ * @param number - number of states
+ */
+void BenchDump(size_t number)
+{
+    vector<uint64_t> words = MakeStates(number);
+    StateLayout layout;
+    layout.AddCounter("f.counter", 11);
+    layout.AddCounter("g.counter", 17);
+    layout.AddVariable("h", 0, number / 2 / (12 * 18) + 1);
+    vector<PackedState> states(number);
+    for(size_t i = 0; i < number; ++i)
+    {
+        memset(&states[i], 0, sizeof(states[i]));
+        states[i].words[0] = words[i];
+    }
+    const char* names[] = {"text:         ", "binary:       ", "binary delta: "};
+    for(int format = 0; format < 3; ++format)
+    {
+        double start = Now();
+        WriteStates(layout, states, format);
+        double write_time = Now() - start;
+        ifstream file(OutputFile, ios::binary | ios::ate);
+        streamoff size = file.tellg();
+        file.close();
+        start = Now();
+        uint64_t sum = ReadStates(layout, format);
+        double read_time = Now() - start;
+        cout<<names[format]<<size<<" bytes, write "<<number / write_time / 1e6<<" Mstates/s, read ";
+        cout<<number / read_time / 1e6<<" Mstates/s, checksum "<<sum<<endl;
+    }
+    remove(OutputFile);
+}
+
+/**
+ * @brief compares writing of lts in every format with lookups of target
+ * states, which exploration does for every transition
+ * @param number - number of transitions
+ */
+void BenchLts(size_t number)
+{
+    vector<uint64_t> words = MakeStates(number);
+    StateLayout layout;
+    layout.AddCounter("f.counter", 11);
+    layout.AddCounter("g.counter", 17);
+    layout.AddVariable("h", 0, number / 2 / (12 * 18) + 1);
+    const char* labels[] = {"int x,y;", "x=6;", "y=1;", "h=6;", "h=x;", "!(y>2);", "y<8;", "!(y>5);", "x=5;"};
+    size_t label_number = sizeof(labels) / sizeof(labels[0]);
+
+    double start = Now();
+    VisitedStore store(1, 0, 0.7);
+    vector<size_t> ids(number);
+    size_t states = 0;
+    for(size_t i = 0; i < number; ++i)
+        states += store.FindOrInsert(&words[i], ids[i]) ? 1 : 0;
+    double store_time = Now() - start;
+    cout<<"transitions: "<<number<<", states: "<<states<<endl;
+    cout<<"VisitedStore: "<<store_time<<" s, "<<number / store_time / 1e6<<" Medges/s"<<endl;
+
+    const char* names[] = {"dot:          ", "aut:          ", "binary:       "};
+    LtsFormat formats[] = {LTS_DOT, LTS_AUT, LTS_BINARY};
+    for(int format = 0; format < 3; ++format)
+    {
+        start = Now();
+        {
+            ofstream file(OutputFile, ios::binary);
+            LtsWriter writer(file, formats[format], layout, false);
+            for(size_t i = 0; i < number; ++i)
+            {
+                PackedState state;
+                memset(&state, 0, sizeof(state));
+                state.words[0] = words[i];
+                size_t label = words[i] % label_number;
+                writer.Edge(i ? ids[i - 1] : 0, ids[i], label & 1 ? "g" : "f", labels[label], label & 1 ? "blue" : "red");
+                if(ids[i] + 1 > writer.States())
+                    writer.Node(ids[i], state);
+            }
+            writer.Finish();
+        }
+        double write_time = Now() - start;
+        ifstream file(OutputFile, ios::binary | ios::ate);
+        streamoff size = file.tellg();
+        file.close();
+        cout<<names[format]<<write_time<<" s, "<<number / write_time / 1e6<<" Medges/s, "<<size<<" bytes"<<endl;
+    }
+    remove(OutputFile);
+}
+
+/**
+ * @brief writes program of several equal threads, which read and write two
+ * global variables in loop
+ * @param stream - output stream
+ * @param threads - number of threads
+ */
+void WriteProgram(ostream& stream, size_t threads)
+{
+    stream<<"int h = 0, k = 0;\n";
+    for(size_t i = 0; i < threads; ++i)
+    {
+        stream<<"\nvoid t"<<i<<"(int a)\n"
+              "{\n"
+              "  int x, y;\n"
+              "  x = 0;\n"
+              "  y = a;\n"
+              "  while (x < 3)\n"
+              "    {\n"
+              "      if (h == x)\n"
+              "        h = y;\n"
+              "      else\n"
+              "        k = x;\n"
+              "      if (x == 0)\n"
+              "        x = 1;\n"
+              "      else if (x == 1)\n"
+              "        x = 2;\n"
+              "      else\n"
+              "        x = 3;\n"
+              "      if (k > y)\n"
+              "        y = k;\n"
+              "    }\n"
+              "  h = x;\n"
+              "}\n";
+    }
+}
+
+/**
+ * @brief explores all states of model by depth-first search
+ * @param model - Program or model, generated by model_compiler
+ * @param words - words of packed state
+ * @param capacity - number of states, allocated before exploration
+ * @param states - place for explored states, NULL if they aren't needed
+ * @return number of states
+ */
+/**
+ * @brief prints program of several equal threads
+ * @param threads - number of threads
+ */
+void PrintProgram(size_t threads)
+{
+    WriteProgram(cout, threads);
+}
+
+template <class Model>
+size_t ExploreModel(const Model& model, size_t words, size_t capacity, vector<PackedState>* states)
+{
+    VisitedStore store(words, capacity, 0.7);
+    Frontier<PackedState> frontier(DFS_ORDER, 1024);
+    size_t threads = model.Threads();
+    PackedState state;
+    model.Initial(state);
+    frontier.Push(state);
+    while(!frontier.Empty())
+    {
+        frontier.Pop(state);
+        if(!store.FindOrInsert(state.words))
+            continue;
+        if(states)
+            states->push_back(state);
+        for(size_t i = 0; i < threads; ++i)
+        {
+            PackedState next = state;
+            if(model.Step(next, i))
+                frontier.Push(next);
+        }
+    }
+    return store.Size();
+}
+
+/**
+ * @brief makes successors of all states without set of generated states
+ * @param model - Program or model, generated by model_compiler
+ * @param states - states of program
+ * @return xor of successors, so steps aren't removed by compiler
+ */
+template <class Model>
+uint64_t StepModel(const Model& model, const vector<PackedState>& states)
+{
+    uint64_t sum = 0;
+    size_t threads = model.Threads();
+    for(size_t j = 0; j < states.size(); ++j)
+    {
+        for(size_t i = 0; i < threads; ++i)
+        {
+            PackedState next = states[j];
+            if(model.Step(next, i))
+                sum ^= next.words[0] ^ next.words[1];
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief compares model, generated by model_compiler, with interpreted program
+ * of same file and arguments
+ * @param model - generated model
+ * @param repeats - number of explorations of every kind
+ */
+template <class Model>
+void BenchModel(const Model& model, size_t repeats)
+{
+    Program program;
+    map<string, size_t> replicas;
+    ParseReplicas(model.Replicas(), replicas);
+    if(!program.Load(model.Source(), model.Arguments(), replicas))
+        return;
+    size_t words = program.Layout().Words();
+    vector<PackedState> states;
+    size_t number = ExploreModel(program, words, 1024, &states);
+    cout<<model.Source()<<": "<<number<<" states, "<<program.Transitions()<<" transitions"<<endl;
+
+    double interpreted_time = 0;
+    double specialized_time = 0;
+    for(size_t i = 0; i < repeats; ++i)
+    {
+        double start = Now();
+        size_t interpreted = ExploreModel(program, words, number, NULL);
+        interpreted_time += Now() - start;
+        start = Now();
+        size_t specialized = ExploreModel(model, words, number, NULL);
+        specialized_time += Now() - start;
+        if(interpreted != number || specialized != number)
+            cerr<<"Different number of states: "<<interpreted<<" and "<<specialized<<endl;
+    }
+    double total = double(number) * repeats;
+    cout<<"exploration, interpreted: "<<total / interpreted_time / 1e6<<" Mstates/s"<<endl;
+    cout<<"exploration, specialized: "<<total / specialized_time / 1e6<<" Mstates/s"<<endl;
+
+    // steps without set of generated states show cost of interpretation itself
+    interpreted_time = 0;
+    specialized_time = 0;
+    for(size_t i = 0; i < repeats; ++i)
+    {
+        double start = Now();
+        uint64_t interpreted = StepModel(program, states);
+        interpreted_time += Now() - start;
+        start = Now();
+        uint64_t specialized = StepModel(model, states);
+        specialized_time += Now() - start;
+        if(interpreted != specialized)
+            cerr<<"Different successors of states"<<endl;
+    }
+    cout<<"steps only, interpreted:  "<<total / interpreted_time / 1e6<<" Mstates/s"<<endl;
+    cout<<"steps only, specialized:  "<<total / specialized_time / 1e6<<" Mstates/s"<<endl;
+}
+
+/**
+ * @brief program, which states are canonicalized after every step, so
+ * states with permuted replicas are explored once
+ */
+struct SymmetricModel
+{
+/**
+ * @brief class constructor
+ * @param program - program with replicated functions
+ */
+    SymmetricModel(const Program& program): m_program(program)
+    {
+    }
+
+    size_t Threads() const
+    {
+        return m_program.Threads();
+    }
+
+    void Initial(PackedState& state) const
+    {
+        m_program.Initial(state);
+        m_program.Canonicalize(state);
+    }
+
+    bool Step(PackedState& state, size_t thread) const
+    {
+        if(!m_program.Step(state, thread))
+            return false;
+        m_program.Canonicalize(state);
+        return true;
+    }
+
+    const Program& m_program;
+};
+
+/**
+ * @brief compares exploration of replicas of one thread with and without
+ * symmetry reduction
+ * @param threads - number of replicas
+ */
+void BenchSymmetry(size_t threads)
+{
+    {
+        ofstream file(OutputFile);
+        WriteProgram(file, 1);
+    }
+    map<string, size_t> replicas;
+    replicas["t0"] = threads;
+    Program program;
+    bool loaded = program.Load(OutputFile, vector<int>(1, 1), replicas);
+    remove(OutputFile);
+    if(!loaded)
+        return;
+    size_t words = program.Layout().Words();
+    double start = Now();
+    size_t full = ExploreModel(program, words, 1024, NULL);
+    double full_time = Now() - start;
+    start = Now();
+    size_t reduced = ExploreModel(SymmetricModel(program), words, 1024, NULL);
+    double reduced_time = Now() - start;
+    cout<<"full:      "<<full<<" states, "<<full_time<<" s, "<<full / full_time / 1e6<<" Mstates/s"<<endl;
+    cout<<"symmetric: "<<reduced<<" states, "<<reduced_time<<" s, "<<reduced / reduced_time / 1e6<<" Mstates/s"<<endl;
+    cout<<"reduction: "<<double(full) / reduced<<" times"<<endl;
+}
+
+/**
+ * @brief compares models, generated by model_compiler, with interpreter
+ * @param repeats - number of explorations of every kind
+ */
+void BenchSpecialized(size_t repeats)
+{
+#ifdef SPECIALIZED_MODELS
+    BenchModel(TaskModel(), repeats * 1000);
+    BenchModel(GeneratedModel(), repeats);
+#else
+    (void)repeats;
+    cerr<<"Models aren't compiled in, build with -DSPECIALIZED_MODELS (see README)"<<endl;
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    size_t number = 0;
+    if(argc < 2 || argc > 3 || (argc == 3 && !isNumber(argv[2])))
+    {
+        cout<<Info<<endl;
+        return 1;
+    }
+    if(argc == 3)
+        number = atol(argv[2]);
+    if(strcmp(argv[1], "visited") == 0)
+    {
+        BenchVisited(number ? number : 4000000);
+    }
+    else if(strcmp(argv[1], "threads") == 0)
+    {
+        BenchThreads(number ? number : thread::hardware_concurrency());
+    }
+    else if(strcmp(argv[1], "dump") == 0)
+    {
+        BenchDump(number ? number : 2000000);
+    }
+    else if(strcmp(argv[1], "output") == 0)
+    {
+        BenchOutput(number ? number : 2000000);
+    }
+    else if(strcmp(argv[1], "lts") == 0)
+    {
+        BenchLts(number ? number : 4000000);
+    }
+    else if(strcmp(argv[1], "program") == 0)
+    {
+        PrintProgram(number ? number : 3);
+    }
+    else if(strcmp(argv[1], "symmetry") == 0)
+    {
+        BenchSymmetry(number ? number : 3);
+    }
+    else if(strcmp(argv[1], "specialized") == 0)
+    {
+        BenchSpecialized(number ? number : 10);
+    }
+    else
+    {
+        cout<<Info<<endl;
+        return 1;
+    }
+}
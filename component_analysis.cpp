@@ -0,0 +1,167 @@
+/******************************************************************************
+ * File: component_analysis.cpp
+ * Description: deadlocks, cycles and longest path of state graph of program.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "component_analysis.h"
+#include <algorithm>
+#include <assert.h>
+using namespace std;
+
+/**
+ * @brief class constructor
+ * @param program - loaded program
+ * @param capacity - number of states, allocated before exploration
+ */
+ComponentAnalysis::ComponentAnalysis(const Program& program, size_t capacity):
+                                                                             m_program(program)
+                                                                           , m_layout(program.Layout())
+                                                                           , m_store(m_layout.Words(), capacity, 0.7)
+                                                                           , m_search(*this)
+                                                                           , m_height()
+                                                                           , m_initial()
+                                                                           , m_steps(0)
+                                                                           , m_terminal(0)
+                                                                           , m_deadlocks(0)
+                                                                           , m_cyclic(0)
+                                                                           , m_cyclic_states(0)
+                                                                           , m_largest(0)
+                                                                           , m_deadlock()
+{
+}
+
+/**
+ * @brief explores all states of program
+ */
+void ComponentAnalysis::Run()
+{
+    m_store.Clear();
+    m_search.Clear();
+    m_height.clear();
+    m_deadlock.clear();
+    m_steps = m_terminal = m_deadlocks = m_cyclic = m_cyclic_states = m_largest = 0;
+    m_program.Initial(m_initial);
+    m_search.Run(m_initial);
+}
+
+/**
+ * @brief prints numbers of terminal and deadlocked states, of cyclic
+ * components and longest path, and path to first deadlock
+ * @param stream - output stream
+ */
+void ComponentAnalysis::Print(ostream& stream) const
+{
+    stream<<"States number: "<<m_store.Size()<<"\n";
+    stream<<"Steps number: "<<m_steps<<"\n";
+    stream<<"Terminal states number: "<<m_terminal<<"\n";
+    stream<<"Deadlocked states number: "<<m_deadlocks<<"\n";
+    stream<<"Cyclic components number: "<<m_cyclic<<"\n";
+    stream<<"States in cycles number: "<<m_cyclic_states<<"\n";
+    stream<<"Largest component size: "<<m_largest<<"\n";
+    stream<<"Longest acyclic path: "<<(m_height.empty() ? 0 : m_height[0])<<"\n";
+    if(m_deadlocks > 0)
+    {
+        stream<<"First deadlock after "<<m_deadlock.size()<<" steps:\n";
+        m_layout.Print(stream, m_initial, ", ");
+        stream<<"\n";
+        for(size_t i = 0; i < m_deadlock.size(); ++i)
+        {
+            const Edge& edge = m_deadlock[i];
+            stream<<"    "<<m_program.ThreadName(edge.thread)<<": "<<edge.transition->label
+                  <<" (line "<<edge.transition->line<<")\n";
+            m_layout.Print(stream, edge.target, ", ");
+            stream<<"\n";
+        }
+    }
+    stream.flush();
+}
+
+/**
+ * @brief finds id of state, adds state if it isn't generated
+ * @param state - packed state
+ * @param id - place for id
+ * @return true if state is added
+ */
+bool ComponentAnalysis::Find(const PackedState& state, uint32_t& id)
+{
+    size_t index;
+    bool added = m_store.FindOrInsert(state.words, index);
+    id = uint32_t(index);
+    return added;
+}
+
+/**
+ * @brief makes steps of threads from state
+ * @param state - packed state
+ * @param edges - place, where steps are added
+ */
+void ComponentAnalysis::Successors(const PackedState& state, vector<Edge>& edges)
+{
+    for(size_t i = 0; i < m_program.Threads(); ++i)
+    {
+        Edge edge = {state, i, NULL};
+        edge.transition = m_program.Step(edge.target, i);
+        if(edge.transition)
+            edges.push_back(edge);
+    }
+}
+
+/**
+ * @brief counts new state as terminal or deadlock
+ * @param state - packed state
+ * @param id - id of state
+ * @param steps - number of steps from state
+ */
+void ComponentAnalysis::Enter(const PackedState& state, uint32_t id, size_t steps)
+{
+    // ids are given in order of exploration, so heights are indexed by them
+    assert(id == m_height.size());
+    m_height.push_back(0);
+    m_steps += steps;
+    if(steps > 0)
+        return;
+    bool finished = true;
+    for(size_t i = 0; i < m_program.Threads(); ++i)
+        finished = finished && m_program.Pc(state, i) == m_program.End(i);
+    if(finished)
+        ++m_terminal;
+    else if(m_deadlocks++ == 0)
+        m_search.Path(m_deadlock);
+}
+
+/**
+ * @brief takes height of explored state for path from other state
+ * @param from - id of state
+ * @param to - id of explored state
+ * @param closed - flag, indicates if component of explored state is closed
+ */
+void ComponentAnalysis::Leave(uint32_t from, uint32_t to, bool closed)
+{
+    // step inside open component doesn't make path longer
+    m_height[from] = max(m_height[from], m_height[to] + (closed ? 1 : 0));
+}
+
+/**
+ * @brief counts closed component, its members get height of root
+ * @param root - id of root
+ * @param begin - index of root in members of search
+ * @return false, search isn't stopped
+ */
+bool ComponentAnalysis::Close(uint32_t root, size_t begin)
+{
+    const vector<ComponentSearch<ComponentAnalysis>::Member>& members = m_search.Members();
+    size_t size = members.size() - begin;
+    if(size > 1 || members[begin].loop)
+    {
+        ++m_cyclic;
+        m_cyclic_states += size;
+        m_largest = max(m_largest, size);
+    }
+    // members get height of component for steps from later states
+    for(size_t i = begin; i < members.size(); ++i)
+        m_height[members[i].id] = m_height[root];
+    return false;
+}
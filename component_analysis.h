@@ -0,0 +1,145 @@
+/******************************************************************************
+ * File: component_analysis.h
+ * Description: deadlocks, cycles and longest path of state graph of program.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef COMPONENT_ANALYSIS_H
+#define COMPONENT_ANALYSIS_H
+
+#include <ostream>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "component_search.h"
+#include "program.h"
+#include "visited_store.h"
+
+/**
+ * @brief explores states of program once in depth-first order and finds
+ * strongly connected components by ComponentSearch, so graph of steps
+ * isn't stored. State without successors is terminal if all
+ * threads are finished, otherwise it's deadlock, first deadlock is kept
+ * with path of search to it. Component is cyclic if it has several states
+ * or step to itself. Height of component is longest path of steps to
+ * terminal component, where every component counts as one state, it's
+ * known when component is closed, because all components after it are
+ * closed before. Height of initial state is longest acyclic path.
+ */
+class ComponentAnalysis
+{
+public:
+/**
+ * @brief class constructor
+ * @param program - loaded program
+ * @param capacity - number of states, allocated before exploration
+ */
+    ComponentAnalysis(const Program& program, size_t capacity);
+
+/**
+ * @brief explores all states of program
+ */
+    void Run();
+
+/**
+ * @brief prints numbers of terminal and deadlocked states, of cyclic
+ * components and longest path, and path to first deadlock
+ * @param stream - output stream
+ */
+    void Print(std::ostream& stream) const;
+
+/**
+ * @brief number of generated states
+ */
+    size_t States() const
+    {
+        return m_store.Size();
+    }
+
+/**
+ * @brief number of deadlocked states
+ */
+    size_t Deadlocks() const
+    {
+        return m_deadlocks;
+    }
+private:
+    friend class ComponentSearch<ComponentAnalysis>;
+    typedef PackedState State;
+
+/**
+ * @brief step of thread to state
+ */
+    struct Edge
+    {
+        PackedState target;
+        size_t thread;
+        const Transition* transition;
+    };
+
+/**
+ * @brief finds id of state, adds state if it isn't generated
+ * @param state - packed state
+ * @param id - place for id
+ * @return true if state is added
+ */
+    bool Find(const PackedState& state, uint32_t& id);
+
+/**
+ * @brief makes steps of threads from state
+ * @param state - packed state
+ * @param edges - place, where steps are added
+ */
+    void Successors(const PackedState& state, std::vector<Edge>& edges);
+
+/**
+ * @brief counts new state as terminal or deadlock
+ * @param state - packed state
+ * @param id - id of state
+ * @param steps - number of steps from state
+ */
+    void Enter(const PackedState& state, uint32_t id, size_t steps);
+
+/**
+ * @brief takes height of explored state for path from other state
+ * @param from - id of state
+ * @param to - id of explored state
+ * @param closed - flag, indicates if component of explored state is closed
+ */
+    void Leave(uint32_t from, uint32_t to, bool closed);
+
+/**
+ * @brief counts closed component, its members get height of root
+ * @param root - id of root
+ * @param begin - index of root in members of search
+ * @return false, search isn't stopped
+ */
+    bool Close(uint32_t root, size_t begin);
+
+    const Program& m_program;
+    const StateLayout& m_layout;
+    VisitedStore m_store;
+    ComponentSearch<ComponentAnalysis> m_search;
+/**
+ * @brief longest path from state to terminal component, it's height of
+ * component, when component is closed
+ */
+    std::vector<uint32_t> m_height;
+    PackedState m_initial;
+    size_t m_steps;
+    size_t m_terminal;
+    size_t m_deadlocks;
+    size_t m_cyclic;
+    size_t m_cyclic_states;
+    size_t m_largest;
+/**
+ * @brief steps of search from initial state to first deadlock
+ */
+    std::vector<Edge> m_deadlock;
+// Copy isn't allowed
+    ComponentAnalysis(ComponentAnalysis&);
+    ComponentAnalysis& operator=(ComponentAnalysis&);
+};
+
+#endif //COMPONENT_ANALYSIS_H
@@ -0,0 +1,214 @@
+/******************************************************************************
+ * File: component_search.h
+ * Description: strongly connected components of graph, which is generated
+ *              during depth-first search.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef COMPONENT_SEARCH_H
+#define COMPONENT_SEARCH_H
+
+#include <algorithm>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief finds strongly connected components by iterative Tarjan algorithm
+ * on stack of depth-first search, so graph isn't stored: successors of
+ * state are kept only while it's on stack. Ids of states are given by graph
+ * in order of adding, so they are indexes of Tarjan. Component is closed,
+ * when search returns to its root, after all components reachable from it.
+ * Graph should have types State and Edge with field State target, and methods
+ * bool Find(const State& state, uint32_t& id) - finds id of state, adds
+ *     state with next id, if it isn't generated, returns true if it's added,
+ * void Successors(const State& state, std::vector<Edge>& edges) - adds steps,
+ * void Enter(const State& state, uint32_t id, size_t steps) - called for
+ *     new state with number of its steps, Path gives steps to it,
+ * void Leave(uint32_t from, uint32_t to, bool closed) - called for step to
+ *     explored state, which isn't on path of search, closed is set if
+ *     component of it is closed,
+ * bool Close(uint32_t root, size_t begin) - called for component, which
+ *     members are Members()[begin..], returns true to stop search.
+ */
+template <class Graph>
+class ComponentSearch
+{
+public:
+    typedef typename Graph::State State;
+    typedef typename Graph::Edge Edge;
+
+/**
+ * @brief state of open component, loop is set if state has step to itself
+ */
+    struct Member
+    {
+        State state;
+        uint32_t id;
+        bool loop;
+    };
+
+/**
+ * @brief class constructor
+ * @param graph - graph of states
+ */
+    ComponentSearch(Graph& graph):m_graph(graph)
+                                 ,m_low()
+                                 ,m_frames()
+                                 ,m_edges()
+                                 ,m_members()
+    {
+    }
+
+/**
+ * @brief forgets all states, graph should forget its ids too
+ */
+    void Clear()
+    {
+        m_low.clear();
+        m_frames.clear();
+        m_edges.clear();
+        m_members.clear();
+    }
+
+/**
+ * @brief explores states, reachable from root, which aren't generated before
+ * @param root - first state
+ * @return false if search is stopped by graph
+ */
+    bool Run(const State& root)
+    {
+        uint32_t id;
+        if(!m_graph.Find(root, id))
+            return true;
+        Enter(root, id);
+        while(!m_frames.empty())
+        {
+            Frame& frame = m_frames.back();
+            uint32_t current = frame.id;
+            if(frame.position < m_edges.size())
+            {
+                // edge is copied, because new frame adds edges
+                Edge edge = m_edges[frame.position++];
+                uint32_t next;
+                if(m_graph.Find(edge.target, next))
+                    Enter(edge.target, next);
+                else if(next == current)
+                    m_members[frame.member].loop = true;
+                else if(m_low[next] != Done)
+                    m_low[current] = std::min(m_low[current], next);
+                else
+                    m_graph.Leave(current, next, true);
+                continue;
+            }
+            if(m_low[current] == current && Close(current))
+                return false;
+            m_edges.resize(frame.first);
+            m_frames.pop_back();
+            if(m_frames.empty())
+                break;
+            // state, which isn't root, is in component of its parent
+            uint32_t parent = m_frames.back().id;
+            if(m_low[current] != Done)
+                m_low[parent] = std::min(m_low[parent], m_low[current]);
+            m_graph.Leave(parent, current, m_low[current] == Done);
+        }
+        return true;
+    }
+
+/**
+ * @brief checks if state belongs to component, which is passed to Close of graph
+ * @param id - id of state
+ * @param root - id of root of component
+ */
+    bool InComponent(uint32_t id, uint32_t root) const
+    {
+        return id >= root && m_low[id] != Done;
+    }
+
+/**
+ * @brief states of open components in order of exploration
+ */
+    const std::vector<Member>& Members() const
+    {
+        return m_members;
+    }
+
+/**
+ * @brief steps of search from root to last entered state, they are last
+ * taken edges of frames
+ * @param steps - place, where steps are added
+ */
+    void Path(std::vector<Edge>& steps) const
+    {
+        for(size_t i = 1; i < m_frames.size(); ++i)
+            steps.push_back(m_edges[m_frames[i - 1].position - 1]);
+    }
+private:
+/**
+ * @brief state, which successors are explored, its edges are
+ * m_edges[first..] up to edges of next frame
+ */
+    struct Frame
+    {
+        uint32_t id;
+        size_t member;
+        size_t first;
+        size_t position;
+    };
+
+/**
+ * @brief starts exploration of new state
+ * @param state - state
+ * @param id - id of state
+ */
+    void Enter(const State& state, uint32_t id)
+    {
+        m_low.push_back(id);
+        Frame frame = {id, m_members.size(), m_edges.size(), m_edges.size()};
+        Member member = {state, id, false};
+        m_members.push_back(member);
+        m_graph.Successors(state, m_edges);
+        m_frames.push_back(frame);
+        m_graph.Enter(state, id, m_edges.size() - frame.first);
+    }
+
+/**
+ * @brief closes component, which root is on top of stack
+ * @param root - id of root
+ * @return true if search is stopped by graph
+ */
+    bool Close(uint32_t root)
+    {
+        size_t begin = m_members.size() - 1;
+        while(m_members[begin].id != root)
+            --begin;
+        if(m_graph.Close(root, begin))
+            return true;
+        for(size_t i = begin; i < m_members.size(); ++i)
+            m_low[m_members[i].id] = Done;
+        m_members.resize(begin);
+        return false;
+    }
+
+/**
+ * @brief id of state, which component is closed
+ */
+    static const uint32_t Done = ~uint32_t(0);
+
+    Graph& m_graph;
+/**
+ * @brief lowest id, reachable from state by its id, Done if component of
+ * state is closed
+ */
+    std::vector<uint32_t> m_low;
+    std::vector<Frame> m_frames;
+    std::vector<Edge> m_edges;
+    std::vector<Member> m_members;
+// Copy isn't allowed
+    ComponentSearch(ComponentSearch&);
+    ComponentSearch& operator=(ComponentSearch&);
+};
+
+#endif //COMPONENT_SEARCH_H
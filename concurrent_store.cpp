@@ -0,0 +1,127 @@
+/******************************************************************************
+ * File: concurrent_store.cpp
+ * Description: hash table of already generated states, shared by threads.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "concurrent_store.h"
+#include "state_codec.h"
+using namespace std;
+
+/**
+ * @brief control byte of empty slot
+ */
+const uint8_t EmptySlot = 0;
+
+/**
+ * @brief control byte of slot, which key is being written
+ */
+const uint8_t BusySlot = 1;
+
+/**
+ * @brief maximal part of occupied slots
+ */
+const double MaxLoad = 0.9;
+
+/**
+ * @brief class constructor
+ * @param key_words - number of 64-bit words in key
+ * @param capacity - maximal number of stored states
+ */
+ConcurrentStore::ConcurrentStore(size_t key_words, size_t capacity): m_words(key_words)
+                                                                   , m_shift(0)
+                                                                   , m_limit(capacity)
+                                                                   , m_size(0)
+                                                                   , m_full(false)
+                                                                   , m_ctrl()
+                                                                   , m_keys()
+                                                                   , m_ids()
+{
+    size_t slots = 64;
+    unsigned int bits = 6;
+    while(slots * MaxLoad < capacity)
+    {
+        slots *= 2;
+        ++bits;
+    }
+    m_shift = 64 - bits;
+    vector<atomic<uint8_t> > ctrl(slots);
+    m_ctrl.swap(ctrl);
+    for(size_t i = 0; i < slots; ++i)
+        m_ctrl[i].store(EmptySlot, memory_order_relaxed);
+    m_keys.resize(slots * m_words);
+    m_ids.resize(slots);
+}
+
+/**
+ * @brief adds key to set, if it isn't stored yet
+ * @param key - pointer to key words
+ * @return true if key was added by this call, false if it was already
+ * stored or table is full
+ */
+bool ConcurrentStore::FindOrInsert(const uint64_t* key)
+{
+    size_t id;
+    return FindOrInsert(key, id);
+}
+
+/**
+ * @brief adds key to set, if it isn't stored yet, and gives its id.
+ * Id is taken from shared counter, when slot is claimed, so keys are
+ * numbered densely from zero, but order of ids depends on threads.
+ * @param key - pointer to key words
+ * @param id - place for id of key, undefined if table is full
+ * @return true if key was added by this call, false if it was already
+ * stored or table is full
+ */
+bool ConcurrentStore::FindOrInsert(const uint64_t* key, size_t& id)
+{
+    uint64_t hash = HashWords(key, m_words);
+    uint8_t tag = 0x80 | ((hash >> (m_shift - 7)) & 0x7f);
+    size_t mask = m_ctrl.size() - 1;
+    size_t slot = hash >> m_shift;
+    while(true)
+    {
+        uint8_t ctrl = m_ctrl[slot].load(memory_order_acquire);
+        if(ctrl == EmptySlot)
+        {
+            if(m_size.load(memory_order_relaxed) >= m_limit)
+            {
+                m_full.store(true);
+                return false;
+            }
+            if(m_ctrl[slot].compare_exchange_strong(ctrl, BusySlot, memory_order_acquire))
+            {
+                for(size_t i = 0; i < m_words; ++i)
+                    m_keys[slot * m_words + i] = key[i];
+                id = m_size.fetch_add(1, memory_order_relaxed);
+                m_ids[slot] = uint32_t(id);
+                // key and id are visible to thread, which sees tag
+                m_ctrl[slot].store(tag, memory_order_release);
+                return true;
+            }
+            // slot is claimed by other thread, check its key
+            continue;
+        }
+        if(ctrl == BusySlot)
+        {
+            // key is being written by other thread
+            continue;
+        }
+        if(ctrl == tag)
+        {
+            const uint64_t* stored = &m_keys[slot * m_words];
+            size_t i = 0;
+            while(i < m_words && stored[i] == key[i])
+                ++i;
+            if(i == m_words)
+            {
+                id = m_ids[slot];
+                return false;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+}
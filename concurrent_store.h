@@ -0,0 +1,122 @@
+/******************************************************************************
+ * File: concurrent_store.h
+ * Description: hash table of already generated states, shared by threads.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef CONCURRENT_STORE_H
+#define CONCURRENT_STORE_H
+
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief insert-only set of states with fixed-width keys for many threads.
+ * Open addressing table with linear probing and fixed number of slots.
+ * Thread claims empty slot by compare-and-swap of control byte, writes key
+ * and then publishes slot with hash tag, so no locks are taken. Table
+ * doesn't grow: if it is filled up to load limit, new keys are rejected
+ * and Full() becomes true.
+ */
+class ConcurrentStore
+{
+public:
+/**
+ * @brief class constructor
+ * @param key_words - number of 64-bit words in key
+ * @param capacity - maximal number of stored states
+ */
+    ConcurrentStore(size_t key_words, size_t capacity);
+
+/**
+ * @brief adds key to set, if it isn't stored yet
+ * @param key - pointer to key words
+ * @return true if key was added by this call, false if it was already
+ * stored or table is full
+ */
+    bool FindOrInsert(const uint64_t* key);
+
+/**
+ * @brief adds key to set, if it isn't stored yet, and gives its id.
+ * Id is taken from shared counter, when slot is claimed, so keys are
+ * numbered densely from zero, but order of ids depends on threads.
+ * @param key - pointer to key words
+ * @param id - place for id of key, undefined if table is full
+ * @return true if key was added by this call, false if it was already
+ * stored or table is full
+ */
+    bool FindOrInsert(const uint64_t* key, size_t& id);
+
+/**
+ * @brief number of stored keys
+ */
+    size_t Size() const
+    {
+        return m_size.load();
+    }
+
+/**
+ * @brief number of slots in table
+ */
+    size_t Capacity() const
+    {
+        return m_ctrl.size();
+    }
+
+/**
+ * @brief checks if some keys were rejected because table is full
+ */
+    bool Full() const
+    {
+        return m_full.load();
+    }
+private:
+/**
+ * @brief number of 64-bit words in key
+ */
+    size_t m_words;
+
+/**
+ * @brief shift of hash to get slot number
+ */
+    unsigned int m_shift;
+
+/**
+ * @brief maximal number of stored keys
+ */
+    size_t m_limit;
+
+/**
+ * @brief number of stored keys
+ */
+    std::atomic<size_t> m_size;
+
+/**
+ * @brief indicates that some keys were rejected
+ */
+    std::atomic<bool> m_full;
+
+/**
+ * @brief control bytes of slots: empty, busy or hash tag of stored key
+ */
+    std::vector<std::atomic<uint8_t> > m_ctrl;
+
+/**
+ * @brief keys of slots, m_words words per slot
+ */
+    std::vector<uint64_t> m_keys;
+
+/**
+ * @brief ids of keys of slots, written before slot is published
+ */
+    std::vector<uint32_t> m_ids;
+
+// Copy isn't allowed
+    ConcurrentStore(ConcurrentStore&);
+    ConcurrentStore& operator=(ConcurrentStore&);
+};
+
+#endif //CONCURRENT_STORE_H
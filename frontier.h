@@ -0,0 +1,137 @@
+/******************************************************************************
+ * File: frontier.h
+ * Description: preallocated worklist of states for iterative exploration.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <vector>
+#include <stddef.h>
+
+/**
+ * @brief order of states exploration
+ */
+enum SearchOrder
+{
+    DFS_ORDER,
+    BFS_ORDER
+};
+
+/**
+ * @brief worklist of states, waiting for exploration.
+ * Items are kept in ring buffer, so one storage serves both orders:
+ * DFS takes items from the back, BFS takes items from the front.
+ */
+template <class T>
+class Frontier
+{
+public:
+/**
+ * @brief class constructor
+ * @param order - order of taking items
+ * @param capacity - number of preallocated items
+ */
+    Frontier(SearchOrder order, size_t capacity):m_order(order)
+                                                ,m_items(capacity > 0 ? capacity : 1)
+                                                ,m_head(0)
+                                                ,m_size(0)
+                                                ,m_peak(0){}
+
+/**
+ * @brief adds item to frontier
+ * @param item - item to add
+ */
+    void Push(const T& item)
+    {
+        if(m_size == m_items.size())
+            Grow();
+        m_items[(m_head + m_size) % m_items.size()] = item;
+        ++m_size;
+        if(m_size > m_peak)
+            m_peak = m_size;
+    }
+
+/**
+ * @brief takes next item from frontier, frontier shouldn't be empty
+ * @param item - place for taken item
+ */
+    void Pop(T& item)
+    {
+        if(m_order == DFS_ORDER)
+        {
+            item = m_items[(m_head + m_size - 1) % m_items.size()];
+        }
+        else
+        {
+            item = m_items[m_head];
+            m_head = (m_head + 1) % m_items.size();
+        }
+        --m_size;
+    }
+
+/**
+ * @brief checks if frontier has no items
+ */
+    bool Empty() const
+    {
+        return m_size == 0;
+    }
+
+/**
+ * @brief order of taking items
+ */
+    SearchOrder Order() const
+    {
+        return m_order;
+    }
+
+/**
+ * @brief maximal number of items, stored at once
+ */
+    size_t Peak() const
+    {
+        return m_peak;
+    }
+private:
+/**
+ * @brief doubles storage, keeping items order
+ */
+    void Grow()
+    {
+        std::vector<T> items(m_items.size() * 2);
+        for(size_t i = 0; i < m_size; ++i)
+            items[i] = m_items[(m_head + i) % m_items.size()];
+        m_items.swap(items);
+        m_head = 0;
+    }
+
+/**
+ * @brief order of taking items
+ */
+    SearchOrder m_order;
+
+/**
+ * @brief ring buffer with items
+ */
+    std::vector<T> m_items;
+
+/**
+ * @brief position of first item
+ */
+    size_t m_head;
+
+/**
+ * @brief number of stored items
+ */
+    size_t m_size;
+
+/**
+ * @brief maximal number of stored items
+ */
+    size_t m_peak;
+};
+
+#endif //FRONTIER_H
@@ -0,0 +1,310 @@
+/******************************************************************************
+ * File: input_sweep.cpp
+ * Description: exploration of program for many values of parameters.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "input_sweep.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <string.h>
+#include <stdlib.h>
+using namespace std;
+
+/**
+ * @brief number of states, allocated by table of every thread before
+ * exploration of first tuple
+ */
+const size_t SweepCapacity = 1024;
+
+/**
+ * @brief minimal width of column of table
+ */
+const size_t ColumnWidth = 10;
+
+/**
+ * @brief parses list of swept parameters like "f.a=0..1000,g.b=2"
+ * @param list - comma separated list of name=min..max or name=value
+ * @param ranges - place for ranges in order of list
+ * @return false if list is malformed
+ */
+bool ParseSweep(const char* list, vector<SweepRange>& ranges)
+{
+    while(*list)
+    {
+        const char* equal = strchr(list, '=');
+        if(!equal || equal == list)
+            return false;
+        SweepRange range;
+        range.name.assign(list, equal);
+        char* end;
+        range.min = strtol(equal + 1, &end, 10);
+        if(end == equal + 1)
+            return false;
+        range.max = range.min;
+        if(strncmp(end, "..", 2) == 0)
+        {
+            const char* max = end + 2;
+            range.max = strtol(max, &end, 10);
+            if(end == max)
+                return false;
+        }
+        if(range.min > range.max || (*end != ',' && *end != '\0'))
+            return false;
+        ranges.push_back(range);
+        list = *end ? end + 1 : end;
+    }
+    return !ranges.empty();
+}
+
+/**
+ * @brief class constructor
+ * @param program - program, compiled with symbolic parameters
+ * @param ranges - swept parameters, other ones have values of arguments
+ * @param threads - number of exploring threads
+ * @param merge - flag, indicates if tuples are explored together by
+ * intervals of parameters
+ */
+InputSweep::InputSweep(const Program& program, const vector<SweepRange>& ranges, size_t threads, bool merge):
+                                                                                      m_program(program)
+                                                                                    , m_layout(program.Layout())
+                                                                                    , m_ranges(ranges)
+                                                                                    , m_parameters()
+                                                                                    , m_threads(threads > 0 ? threads : 1)
+                                                                                    , m_merge(merge)
+                                                                                    , m_tuples(1)
+                                                                                    , m_results()
+                                                                                    , m_next(0)
+                                                                                    , m_abstract()
+                                                                                    , m_key_mask()
+{
+    for(size_t i = 0; i < m_ranges.size(); ++i)
+        m_tuples *= uint64_t(int64_t(m_ranges[i].max) - m_ranges[i].min + 1);
+    // states of tuples are differed without bounds of parameters
+    vector<size_t> fields;
+    const vector<size_t>& parameters = m_program.Parameters();
+    for(size_t i = 0; i < m_layout.Fields(); ++i)
+        if(find(parameters.begin(), parameters.end(), i) == parameters.end() &&
+           find(parameters.begin(), parameters.end(), i - 1) == parameters.end())
+            fields.push_back(i);
+    m_layout.Mask(fields, m_key_mask);
+}
+
+/**
+ * @brief explores all tuples
+ * @return false if some swept parameter isn't parameter of program
+ */
+bool InputSweep::Run()
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    m_parameters.clear();
+    for(size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        size_t field;
+        string name = m_ranges[i].name + ".min";
+        if(!m_layout.Find(name.c_str(), field))
+        {
+            cerr<<"Unknown parameter "<<m_ranges[i].name<<" in sweep"<<endl;
+            return false;
+        }
+        m_parameters.push_back(find(parameters.begin(), parameters.end(), field) - parameters.begin());
+    }
+    m_results.assign(m_tuples, SweepResult());
+    m_next = 0;
+    if(m_merge)
+        ExploreAbstract();
+    vector<thread> workers;
+    for(size_t i = 1; i < m_threads; ++i)
+        workers.push_back(thread(&InputSweep::Work, this));
+    Work();
+    for(size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+    return true;
+}
+
+/**
+ * @brief prints table of tuples with numbers of their states
+ * @param stream - output stream
+ */
+void InputSweep::Print(ostream& stream) const
+{
+    for(size_t i = 0; i < m_ranges.size(); ++i)
+        stream<<setw(max(ColumnWidth, m_ranges[i].name.size()))<<m_ranges[i].name<<" ";
+    stream<<setw(ColumnWidth)<<"states"<<" "<<setw(ColumnWidth)<<"final"<<"\n";
+    for(uint64_t tuple = 0; tuple < m_tuples; ++tuple)
+    {
+        for(size_t i = 0; i < m_ranges.size(); ++i)
+            stream<<setw(max(ColumnWidth, m_ranges[i].name.size()))<<Value(tuple, i)<<" ";
+        stream<<setw(ColumnWidth)<<m_results[tuple].states<<" "<<setw(ColumnWidth)<<m_results[tuple].finals<<"\n";
+    }
+    stream.flush();
+}
+
+/**
+ * @brief makes initial state, where parameters have values of arguments
+ * @param state - place for state
+ */
+void InputSweep::Initial(PackedState& state) const
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    m_program.Initial(state);
+    for(size_t i = 0; i < parameters.size(); ++i)
+    {
+        m_layout.Set(state, parameters[i], m_program.ParameterValue(i));
+        m_layout.Set(state, parameters[i] + 1, m_program.ParameterValue(i));
+    }
+}
+
+/**
+ * @brief value of swept parameter in tuple, last parameter changes first
+ * @param tuple - index of tuple
+ * @param range - index of swept parameter
+ */
+int InputSweep::Value(uint64_t tuple, size_t range) const
+{
+    for(size_t i = m_ranges.size() - 1; i > range; --i)
+        tuple /= uint64_t(int64_t(m_ranges[i].max) - m_ranges[i].min + 1);
+    return int(m_ranges[range].min + int64_t(tuple % uint64_t(int64_t(m_ranges[range].max) - m_ranges[range].min + 1)));
+}
+
+/**
+ * @brief checks if all threads are finished
+ * @param state - packed state
+ */
+bool InputSweep::Final(const PackedState& state) const
+{
+    for(size_t i = 0; i < m_program.Threads(); ++i)
+        if(m_program.Pc(state, i) != m_program.End(i))
+            return false;
+    return true;
+}
+
+/**
+ * @brief takes tuples until all are explored
+ */
+void InputSweep::Work()
+{
+    VisitedStore store(m_layout.Words(), SweepCapacity, 0.7);
+    Frontier<PackedState> frontier(DFS_ORDER, SweepCapacity);
+    for(uint64_t tuple = m_next++; tuple < m_tuples; tuple = m_next++)
+        m_results[tuple] = m_merge ? Project(tuple, store) : Explore(tuple, store, frontier);
+}
+
+/**
+ * @brief explores states of one tuple
+ * @param tuple - index of tuple
+ * @param store - table of generated states, cleared before exploration
+ * @param frontier - empty frontier
+ */
+SweepResult InputSweep::Explore(uint64_t tuple, VisitedStore& store, Frontier<PackedState>& frontier) const
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    SweepResult result = {0, 0};
+    PackedState state;
+    Initial(state);
+    for(size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        int value = Value(tuple, i);
+        m_layout.Set(state, parameters[m_parameters[i]], value);
+        m_layout.Set(state, parameters[m_parameters[i]] + 1, value);
+    }
+    // all parameters are decided, so steps are same as steps of numbers
+    store.Clear();
+    frontier.Push(state);
+    while(!frontier.Empty())
+    {
+        frontier.Pop(state);
+        if(!store.FindOrInsert(state.words))
+            continue;
+        if(Final(state))
+            ++result.finals;
+        for(size_t i = 0; i < m_program.Threads(); ++i)
+        {
+            PackedState next = state;
+            if(m_program.Step(next, i))
+                frontier.Push(next);
+        }
+    }
+    result.states = store.Size();
+    return result;
+}
+
+/**
+ * @brief counts states of one tuple among abstract states
+ * @param tuple - index of tuple
+ * @param store - table of states without parameters, cleared before counting
+ */
+SweepResult InputSweep::Project(uint64_t tuple, VisitedStore& store) const
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    SweepResult result = {0, 0};
+    vector<int> values(m_ranges.size());
+    for(size_t i = 0; i < m_ranges.size(); ++i)
+        values[i] = Value(tuple, i);
+    store.Clear();
+    PackedState key;
+    for(size_t i = 0; i < m_abstract.size(); ++i)
+    {
+        const PackedState& state = m_abstract[i];
+        bool covered = true;
+        for(size_t j = 0; j < m_ranges.size() && covered; ++j)
+        {
+            int min;
+            int max;
+            m_program.Bounds(state, parameters[m_parameters[j]], min, max);
+            covered = min <= values[j] && values[j] <= max;
+        }
+        if(!covered)
+            continue;
+        // variables, which keep numbers of parameters, get values of tuple
+        PackedState concrete = state;
+        for(size_t j = 0; j < m_ranges.size(); ++j)
+        {
+            m_layout.Set(concrete, parameters[m_parameters[j]], values[j]);
+            m_layout.Set(concrete, parameters[m_parameters[j]] + 1, values[j]);
+        }
+        m_program.Settle(concrete);
+        // several abstract states can cover one concrete state
+        MaskState(concrete, m_key_mask, key);
+        if(store.FindOrInsert(key.words) && Final(state))
+            ++result.finals;
+    }
+    result.states = store.Size();
+    return result;
+}
+
+/**
+ * @brief explores abstract states, where swept parameters are intervals
+ */
+void InputSweep::ExploreAbstract()
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    PackedState state;
+    Initial(state);
+    for(size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        m_layout.Set(state, parameters[m_parameters[i]], m_ranges[i].min);
+        m_layout.Set(state, parameters[m_parameters[i]] + 1, m_ranges[i].max);
+    }
+    VisitedStore store(m_layout.Words(), SweepCapacity, 0.7);
+    Frontier<PackedState> frontier(DFS_ORDER, SweepCapacity);
+    vector<PackedState> next;
+    m_abstract.clear();
+    frontier.Push(state);
+    while(!frontier.Empty())
+    {
+        frontier.Pop(state);
+        if(!store.FindOrInsert(state.words))
+            continue;
+        m_abstract.push_back(state);
+        next.clear();
+        for(size_t i = 0; i < m_program.Threads(); ++i)
+            m_program.SymbolicSteps(state, i, next);
+        for(size_t i = 0; i < next.size(); ++i)
+            frontier.Push(next[i]);
+    }
+}
@@ -0,0 +1,182 @@
+/******************************************************************************
+ * File: input_sweep.h
+ * Description: exploration of program for many values of parameters.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef INPUT_SWEEP_H
+#define INPUT_SWEEP_H
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "frontier.h"
+#include "program.h"
+#include "visited_store.h"
+
+/**
+ * @brief values of one parameter, which are swept
+ */
+struct SweepRange
+{
+/**
+ * @brief name of parameter like f.a
+ */
+    std::string name;
+    int min;
+    int max;
+};
+
+/**
+ * @brief parses list of swept parameters like "f.a=0..1000,g.b=2"
+ * @param list - comma separated list of name=min..max or name=value
+ * @param ranges - place for ranges in order of list
+ * @return false if list is malformed
+ */
+bool ParseSweep(const char* list, std::vector<SweepRange>& ranges);
+
+/**
+ * @brief result of exploration of one tuple of parameters
+ */
+struct SweepResult
+{
+/**
+ * @brief number of states
+ */
+    uint64_t states;
+/**
+ * @brief number of states, where all threads are finished
+ */
+    uint64_t finals;
+};
+
+/**
+ * @brief explores program for every tuple of swept parameters. Program is
+ * compiled once with symbolic parameters, so tuples share its transitions,
+ * and tuple is initial state with bounds of parameters equal to its values.
+ * Tuples are shared by threads, every thread reuses its table and frontier.
+ * In merged mode states of all tuples are explored once with intervals of
+ * parameters, and states of tuple are abstract states, which cover it: if
+ * parameters don't influence steps, there is only one abstract exploration.
+ */
+class InputSweep
+{
+public:
+/**
+ * @brief class constructor
+ * @param program - program, compiled with symbolic parameters
+ * @param ranges - swept parameters, other ones have values of arguments
+ * @param threads - number of exploring threads
+ * @param merge - flag, indicates if tuples are explored together by
+ * intervals of parameters
+ */
+    InputSweep(const Program& program, const std::vector<SweepRange>& ranges, size_t threads, bool merge);
+
+/**
+ * @brief explores all tuples
+ * @return false if some swept parameter isn't parameter of program
+ */
+    bool Run();
+
+/**
+ * @brief prints table of tuples with numbers of their states
+ * @param stream - output stream
+ */
+    void Print(std::ostream& stream) const;
+
+/**
+ * @brief number of tuples of parameters
+ */
+    uint64_t Tuples() const
+    {
+        return m_tuples;
+    }
+
+/**
+ * @brief number of abstract states of merged mode, 0 otherwise
+ */
+    size_t AbstractStates() const
+    {
+        return m_abstract.size();
+    }
+private:
+/**
+ * @brief makes initial state, where parameters have values of arguments
+ * @param state - place for state
+ */
+    void Initial(PackedState& state) const;
+
+/**
+ * @brief value of swept parameter in tuple, last parameter changes first
+ * @param tuple - index of tuple
+ * @param range - index of swept parameter
+ */
+    int Value(uint64_t tuple, size_t range) const;
+
+/**
+ * @brief checks if all threads are finished
+ * @param state - packed state
+ */
+    bool Final(const PackedState& state) const;
+
+/**
+ * @brief takes tuples until all are explored
+ */
+    void Work();
+
+/**
+ * @brief explores states of one tuple
+ * @param tuple - index of tuple
+ * @param store - table of generated states, cleared before exploration
+ * @param frontier - empty frontier
+ */
+    SweepResult Explore(uint64_t tuple, VisitedStore& store, Frontier<PackedState>& frontier) const;
+
+/**
+ * @brief counts states of one tuple among abstract states
+ * @param tuple - index of tuple
+ * @param store - table of states without parameters, cleared before counting
+ */
+    SweepResult Project(uint64_t tuple, VisitedStore& store) const;
+
+/**
+ * @brief explores abstract states, where swept parameters are intervals
+ */
+    void ExploreAbstract();
+
+    const Program& m_program;
+    const StateLayout& m_layout;
+    std::vector<SweepRange> m_ranges;
+/**
+ * @brief index of every swept parameter in Program::Parameters()
+ */
+    std::vector<size_t> m_parameters;
+    size_t m_threads;
+    bool m_merge;
+    uint64_t m_tuples;
+/**
+ * @brief results by index of tuple
+ */
+    std::vector<SweepResult> m_results;
+/**
+ * @brief index of next unexplored tuple
+ */
+    std::atomic<uint64_t> m_next;
+/**
+ * @brief states of merged mode
+ */
+    std::vector<PackedState> m_abstract;
+/**
+ * @brief mask of all fields except bounds of parameters
+ */
+    PackedState m_key_mask;
+// Copy isn't allowed
+    InputSweep(InputSweep&);
+    InputSweep& operator=(InputSweep&);
+};
+
+#endif //INPUT_SWEEP_H
@@ -0,0 +1,346 @@
+/******************************************************************************
+ * File: invariant.cpp
+ * Description: property of states, which is checked during exploration.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "invariant.h"
+#include <iostream>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+using namespace std;
+
+/**
+ * @brief maximal number of items of expression, results of items are kept
+ * in array on stack during check
+ */
+const size_t MaxInvariantItems = 64;
+
+/**
+ * @brief class constructor, makes invariant, which always holds
+ */
+Invariant::Invariant(): m_text()
+                      , m_items()
+                      , m_layout(NULL)
+                      , m_position(NULL)
+                      , m_context(NULL)
+{
+}
+
+/**
+ * @brief parses expression, errors are printed to cerr
+ * @param layout - placement of fields in packed state
+ * @param text - text of expression
+ * @param context - name of text, which has expression, in errors
+ * @return false if expression is malformed or has unknown name
+ */
+bool Invariant::Parse(const StateLayout& layout, const char* text, const char* context)
+{
+    m_text = text;
+    m_items.clear();
+    m_layout = &layout;
+    m_position = text;
+    m_context = context;
+    bool parsed = ParseOr();
+    SkipSpaces();
+    if(parsed && *m_position != '\0')
+    {
+        cerr<<"Unexpected '"<<m_position<<"' in "<<m_context<<endl;
+        parsed = false;
+    }
+    if(parsed && m_items.size() > MaxInvariantItems)
+    {
+        cerr<<"Expression is too long in "<<m_context<<endl;
+        parsed = false;
+    }
+    if(!parsed)
+        m_items.clear();
+    m_layout = NULL;
+    m_position = NULL;
+    return parsed;
+}
+
+/**
+ * @brief checks if expression holds in state
+ * @param layout - placement of fields in packed state, same as of Parse
+ * @param state - packed state
+ */
+bool Invariant::Holds(const StateLayout& layout, const PackedState& state) const
+{
+    if(m_items.empty())
+        return true;
+    bool results[MaxInvariantItems];
+    size_t top = 0;
+    for(size_t i = 0; i < m_items.size(); ++i)
+    {
+        const Item& item = m_items[i];
+        switch(item.kind)
+        {
+            case ITEM_COMPARE:
+            {
+                int left;
+                int right;
+                bool init = Read(layout, state, item.left, left);
+                if(item.uninit)
+                    results[top++] = item.comparison == OP_EQUAL ? !init : init;
+                else
+                    results[top++] = init && Read(layout, state, item.right, right) &&
+                                     Compare(item.comparison, left, right);
+                break;
+            }
+            case ITEM_NOT:
+                results[top - 1] = !results[top - 1];
+                break;
+            case ITEM_AND:
+                --top;
+                results[top - 1] = results[top - 1] && results[top];
+                break;
+            case ITEM_OR:
+                --top;
+                results[top - 1] = results[top - 1] || results[top];
+                break;
+        }
+    }
+    return results[0];
+}
+
+/**
+ * @brief parses disjunction
+ * @return false if expression is malformed
+ */
+bool Invariant::ParseOr()
+{
+    if(!ParseAnd())
+        return false;
+    while(Accept("||"))
+    {
+        if(!ParseAnd())
+            return false;
+        Item item = {ITEM_OR, OP_TRUE, {NoField, 0}, {NoField, 0}, false};
+        m_items.push_back(item);
+    }
+    return true;
+}
+
+/**
+ * @brief parses conjunction
+ * @return false if expression is malformed
+ */
+bool Invariant::ParseAnd()
+{
+    if(!ParseUnary())
+        return false;
+    while(Accept("&&"))
+    {
+        if(!ParseUnary())
+            return false;
+        Item item = {ITEM_AND, OP_TRUE, {NoField, 0}, {NoField, 0}, false};
+        m_items.push_back(item);
+    }
+    return true;
+}
+
+/**
+ * @brief parses negation, expression in parentheses or comparison
+ * @return false if expression is malformed
+ */
+bool Invariant::ParseUnary()
+{
+    // != is comparison, so ! is negation only before operand
+    SkipSpaces();
+    if(m_position[0] == '!' && m_position[1] != '=')
+    {
+        ++m_position;
+        if(!ParseUnary())
+            return false;
+        Item item = {ITEM_NOT, OP_TRUE, {NoField, 0}, {NoField, 0}, false};
+        m_items.push_back(item);
+        return true;
+    }
+    if(Accept("("))
+    {
+        if(!ParseOr())
+            return false;
+        if(!Accept(")"))
+        {
+            cerr<<"Expected ')' in "<<m_context<<endl;
+            return false;
+        }
+        return true;
+    }
+    return ParseComparison();
+}
+
+/**
+ * @brief parses comparison of two operands or operand alone
+ * @return false if comparison is malformed
+ */
+bool Invariant::ParseComparison()
+{
+    Item item = {ITEM_COMPARE, OP_NOT_EQUAL, {NoField, 0}, {NoField, 0}, false};
+    bool uninit = false;
+    if(!ParseOperand(item.left, uninit))
+        return false;
+    if(uninit)
+    {
+        cerr<<"# can be only right operand in "<<m_context<<endl;
+        return false;
+    }
+    // longer symbols are tried first
+    const char* symbols[] = {"==", "!=", "<=", ">=", "<", ">"};
+    const Comparison comparisons[] = {OP_EQUAL, OP_NOT_EQUAL, OP_LESS_EQUAL, OP_GREATER_EQUAL, OP_LESS, OP_GREATER};
+    for(size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); ++i)
+    {
+        if(Accept(symbols[i]))
+        {
+            item.comparison = comparisons[i];
+            if(!ParseOperand(item.right, item.uninit))
+                return false;
+            if(item.uninit && item.comparison != OP_EQUAL && item.comparison != OP_NOT_EQUAL)
+            {
+                cerr<<"# can be compared only by == and != in "<<m_context<<endl;
+                return false;
+            }
+            break;
+        }
+    }
+    m_items.push_back(item);
+    return true;
+}
+
+/**
+ * @brief parses name of field, number or #
+ * @param operand - place for operand
+ * @param uninit - place for flag, indicates if operand is #
+ * @return false if operand is malformed or name is unknown
+ */
+bool Invariant::ParseOperand(Operand& operand, bool& uninit)
+{
+    SkipSpaces();
+    operand.field = NoField;
+    operand.value = 0;
+    uninit = false;
+    if(*m_position == '#')
+    {
+        ++m_position;
+        uninit = true;
+        return true;
+    }
+    if(isalpha(*m_position) || *m_position == '_')
+    {
+        // names of fields are like h, f.x, worker[1].counter
+        const char* begin = m_position;
+        while(*m_position != '\0' && (isalnum(*m_position) || strchr("_.[]", *m_position)))
+            ++m_position;
+        string name(begin, m_position);
+        if(m_layout->Find(name.c_str(), operand.field))
+            return true;
+        if(name.size() > 3 && name.compare(name.size() - 3, 3, ".pc") == 0 &&
+           m_layout->Find((name.substr(0, name.size() - 3) + ".counter").c_str(), operand.field))
+            return true;
+        // f.end is value of counter of finished thread
+        size_t counter;
+        if(name.size() > 4 && name.compare(name.size() - 4, 4, ".end") == 0 &&
+           m_layout->Find((name.substr(0, name.size() - 4) + ".counter").c_str(), counter))
+        {
+            operand.value = m_layout->Min(counter) + int(m_layout->Values(counter)) - 1;
+            return true;
+        }
+        cerr<<"Unknown variable '"<<name<<"' in "<<m_context<<endl;
+        return false;
+    }
+    const char* begin = m_position;
+    char* end;
+    errno = 0;
+    long number = strtol(begin, &end, 10);
+    if(end == begin || (*begin != '-' && !isdigit(*begin)))
+    {
+        cerr<<"Expected operand at '"<<begin<<"' in "<<m_context<<endl;
+        return false;
+    }
+    if(errno != 0 || number < INT_MIN || number > INT_MAX)
+    {
+        cerr<<"Number is out of int range in "<<m_context<<endl;
+        return false;
+    }
+    operand.value = int(number);
+    m_position = end;
+    return true;
+}
+
+/**
+ * @brief skips spaces of text
+ */
+void Invariant::SkipSpaces()
+{
+    while(isspace(*m_position))
+        ++m_position;
+}
+
+/**
+ * @brief takes symbol, if text continues with it
+ * @param symbol - expected symbol
+ * @return true if symbol is taken
+ */
+bool Invariant::Accept(const char* symbol)
+{
+    SkipSpaces();
+    size_t length = strlen(symbol);
+    if(strncmp(m_position, symbol, length) != 0)
+        return false;
+    m_position += length;
+    return true;
+}
+
+/**
+ * @brief reads value of operand
+ * @param layout - placement of fields in packed state
+ * @param state - packed state
+ * @param operand - operand
+ * @param value - place for value
+ * @return false if operand is uninitialized variable
+ */
+bool Invariant::Read(const StateLayout& layout, const PackedState& state, const Operand& operand, int& value)
+{
+    if(operand.field == NoField)
+    {
+        value = operand.value;
+        return true;
+    }
+    if(!layout.IsInit(state, operand.field))
+        return false;
+    value = layout.Value(state, operand.field);
+    return true;
+}
+
+/**
+ * @brief compares values
+ * @param comparison - comparison
+ * @param left - left value
+ * @param right - right value
+ */
+bool Invariant::Compare(Comparison comparison, int left, int right)
+{
+    switch(comparison)
+    {
+        case OP_EQUAL:
+            return left == right;
+        case OP_NOT_EQUAL:
+            return left != right;
+        case OP_LESS:
+            return left < right;
+        case OP_GREATER:
+            return left > right;
+        case OP_LESS_EQUAL:
+            return left <= right;
+        case OP_GREATER_EQUAL:
+            return left >= right;
+        default:
+            return true;
+    }
+}
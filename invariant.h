@@ -0,0 +1,124 @@
+/******************************************************************************
+ * File: invariant.h
+ * Description: property of states, which is checked during exploration.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef INVARIANT_H
+#define INVARIANT_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include "program.h"
+#include "state_codec.h"
+
+/**
+ * @brief boolean expression over fields of packed state like
+ * "h<7 && (f.counter!=3 || g.y==#)". Operands are names of fields, numbers
+ * and # for uninitialized value, counter of thread is named f.counter or
+ * f.pc, and f.end is value of counter after last step. Comparisons are
+ * combined by !, &&, || and parentheses, operand alone is true if it isn't
+ * zero. Comparison with uninitialized variable is false, as guard of
+ * program, unless it is == # or != #.
+ */
+class Invariant
+{
+public:
+/**
+ * @brief class constructor, makes invariant, which always holds
+ */
+    Invariant();
+
+/**
+ * @brief parses expression, errors are printed to cerr
+ * @param layout - placement of fields in packed state
+ * @param text - text of expression
+ * @param context - name of text, which has expression, in errors
+ * @return false if expression is malformed or has unknown name
+ */
+    bool Parse(const StateLayout& layout, const char* text, const char* context = "invariant");
+
+/**
+ * @brief checks if expression holds in state
+ * @param layout - placement of fields in packed state, same as of Parse
+ * @param state - packed state
+ */
+    bool Holds(const StateLayout& layout, const PackedState& state) const;
+
+/**
+ * @brief text of expression
+ */
+    const std::string& Text() const
+    {
+        return m_text;
+    }
+private:
+/**
+ * @brief kind of item of expression in postfix order
+ */
+    enum ItemKind
+    {
+        ITEM_COMPARE,
+        ITEM_NOT,
+        ITEM_AND,
+        ITEM_OR
+    };
+
+/**
+ * @brief item of expression, comparison takes operands, other items take
+ * results of previous items
+ */
+    struct Item
+    {
+        ItemKind kind;
+        Comparison comparison;
+        Operand left;
+        Operand right;
+/**
+ * @brief flag, indicates if right operand is #
+ */
+        bool uninit;
+    };
+
+    bool ParseOr();
+    bool ParseAnd();
+    bool ParseUnary();
+    bool ParseComparison();
+    bool ParseOperand(Operand& operand, bool& uninit);
+    void SkipSpaces();
+    bool Accept(const char* symbol);
+
+/**
+ * @brief reads value of operand
+ * @param layout - placement of fields in packed state
+ * @param state - packed state
+ * @param operand - operand
+ * @param value - place for value
+ * @return false if operand is uninitialized variable
+ */
+    static bool Read(const StateLayout& layout, const PackedState& state, const Operand& operand, int& value);
+
+/**
+ * @brief compares values
+ * @param comparison - comparison
+ * @param left - left value
+ * @param right - right value
+ */
+    static bool Compare(Comparison comparison, int left, int right);
+
+    std::string m_text;
+/**
+ * @brief items in postfix order, empty for invariant, which always holds
+ */
+    std::vector<Item> m_items;
+/**
+ * @brief layout, position in text and name of text in errors during parsing
+ */
+    const StateLayout* m_layout;
+    const char* m_position;
+    const char* m_context;
+};
+
+#endif //INVARIANT_H
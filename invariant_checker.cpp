@@ -0,0 +1,203 @@
+/******************************************************************************
+ * File: invariant_checker.cpp
+ * Description: check of invariant on generated states with traces to
+ *              violating states, shared by both state makers.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "invariant_checker.h"
+#include <iostream>
+#include <string>
+using namespace std;
+
+/**
+ * @brief number of states, allocated before exploration by frontier and table of parents
+ */
+const size_t TraceCapacity = 1024;
+
+/**
+ * @brief turns off flags, which are incompatible with check of invariant:
+ * reductions and projection drop states or values of variables, which
+ * invariant can read, and check is done by one thread
+ * @param others - flag, indicates if options of state maker, which aren't
+ * given here, are incompatible too, caller turns them off
+ * @param others_names - names of options of state maker, printed in message
+ * @param threads - number of exploring threads
+ * @param por - flag of partial-order reduction
+ * @param symmetry - flag of symmetry reduction
+ * @param liveness - flag of reset of dead variables
+ * @param blocks - flag of fused local steps
+ * @param projection - names of variables, which differ states
+ * @param dump_filename - name of binary file of states
+ * @return true if some flag is turned off
+ */
+bool TurnOffForCheck(bool others, const char* others_names, size_t& threads, bool& por, bool& symmetry, bool& liveness,
+                     bool& blocks, const char*& projection, const char*& dump_filename)
+{
+    if(!others && threads == 1 && !por && !symmetry && !liveness && !blocks && !projection && !dump_filename)
+        return false;
+    cerr<<"Invariant is checked by one thread with generated states without reductions, projection, "<<others_names<<endl;
+    threads = 1;
+    por = false;
+    symmetry = false;
+    liveness = false;
+    blocks = false;
+    projection = NULL;
+    dump_filename = NULL;
+    return true;
+}
+
+/**
+ * @brief class constructor
+ * @param program - loaded program
+ * @param invariant - property of all states
+ * @param old - set of generated states
+ * @param writer - output of traces
+ */
+InvariantChecker::InvariantChecker(const Program& program, const Invariant& invariant, StateSet& old, OutputWriter& writer):
+                                                                                                                            m_program(program)
+                                                                                                                          , m_layout(program.Layout())
+                                                                                                                          , m_invariant(invariant)
+                                                                                                                          , m_old(old)
+                                                                                                                          , m_writer(writer)
+                                                                                                                          , m_parents(TraceCapacity)
+                                                                                                                          , m_initial()
+                                                                                                                          , m_order(DFS_ORDER)
+                                                                                                                          , m_limit(0)
+                                                                                                                          , m_states(0)
+                                                                                                                          , m_levels(0)
+                                                                                                                          , m_violations(0)
+                                                                                                                          , m_stopped(false)
+{
+}
+
+/**
+ * @brief explores states from initial state
+ * @param order - order of states exploration
+ * @param limit - number of violations, after which exploration is stopped
+ * @return number of found violations
+ */
+size_t InvariantChecker::Run(SearchOrder order, size_t limit)
+{
+    m_order = order;
+    m_limit = limit;
+    m_program.Initial(m_initial);
+    TracedState item = {m_initial, NoParent, 0, 0};
+    vector<TracedState> next;
+    if(order == BFS_ORDER)
+    {
+        // levels are whole, so trace of every violation is shortest
+        vector<TracedState> level(1, item);
+        while(!level.empty() && m_violations < limit && !m_stopped)
+        {
+            next.clear();
+            for(size_t i = 0; i < level.size() && m_violations < limit && !m_stopped; ++i)
+                m_stopped = !Check(level[i], next);
+            level.swap(next);
+            ++m_levels;
+        }
+    }
+    else
+    {
+        Frontier<TracedState> frontier(DFS_ORDER, TraceCapacity);
+        frontier.Push(item);
+        while(!frontier.Empty() && m_violations < limit && !m_stopped)
+        {
+            frontier.Pop(item);
+            next.clear();
+            m_stopped = !Check(item, next);
+            // successors of first thread are taken first
+            for(size_t i = next.size(); i > 0; --i)
+                frontier.Push(next[i - 1]);
+        }
+    }
+    return m_violations;
+}
+
+/**
+ * @brief prints result of check in console
+ * @param count_flag - flag, indicates if numbers of states and levels are printed
+ */
+void InvariantChecker::Print(bool count_flag) const
+{
+    if(count_flag)
+    {
+        cout<<"Checked states number: "<<m_states<<endl;
+        if(m_order == BFS_ORDER)
+            cout<<"Levels number: "<<m_levels<<endl;
+        cout<<"Violations number: "<<m_violations<<endl;
+    }
+    if(m_violations == 0)
+        cout<<"Invariant holds"<<(m_old.Exact() && !m_stopped ? "" : " in explored states")<<endl;
+    else if(m_violations == m_limit)
+        cout<<"Exploration is stopped after "<<m_violations<<" violations"<<endl;
+}
+
+/**
+ * @brief stores state and makes its successors, prints trace if invariant
+ * is violated
+ * @param item - generated state with its parent
+ * @param next - place, where successors are added in order of threads
+ * @return false if ids of states are exhausted
+ */
+bool InvariantChecker::Check(const TracedState& item, vector<TracedState>& next)
+{
+    if(!m_old.FindOrInsert(item.state))
+        return true;
+    uint32_t id;
+    if(!m_parents.Add(item.parent, item.thread, item.transition, id))
+    {
+        cerr<<"Too many states for traces, exploration is stopped"<<endl;
+        return false;
+    }
+    ++m_states;
+    if(!m_invariant.Holds(m_layout, item.state))
+    {
+        // successors of violating state aren't explored
+        PrintTrace(id);
+        ++m_violations;
+        return true;
+    }
+    for(size_t i = 0; i < m_program.Threads(); ++i)
+    {
+        TracedState traced = {item.state, id, i, 0};
+        const Transition* transition = m_program.Step(traced.state, i);
+        if(!transition)
+            continue;
+        traced.transition = m_program.TransitionIndex(*transition);
+        next.push_back(traced);
+    }
+    return true;
+}
+
+/**
+ * @brief prints steps and states from initial state to violating state
+ * @param id - id of violating state
+ */
+void InvariantChecker::PrintTrace(uint32_t id)
+{
+    vector<TraceRecord> steps;
+    m_parents.Trace(id, steps);
+    m_writer.Buffer() += "Invariant " + m_invariant.Text() + " is violated after ";
+    AppendNumber(m_writer.Buffer(), steps.size());
+    m_writer.Buffer() += " steps:";
+    m_writer.EndLine();
+    // steps are repeated from initial state, so states aren't stored
+    PackedState state = m_initial;
+    m_layout.Print(m_writer.Buffer(), state, ", ");
+    m_writer.EndLine();
+    for(size_t i = 0; i < steps.size(); ++i)
+    {
+        const Transition* transition = m_program.Step(state, steps[i].thread);
+        if(steps[i].transition != NoTransition)
+            transition = &m_program.GetTransition(steps[i].transition);
+        m_writer.Buffer() += string("    ") + m_program.ThreadName(steps[i].thread) + ": " + transition->label + " (line ";
+        AppendNumber(m_writer.Buffer(), transition->line);
+        m_writer.Buffer() += ")";
+        m_writer.EndLine();
+        m_layout.Print(m_writer.Buffer(), state, ", ");
+        m_writer.EndLine();
+    }
+}
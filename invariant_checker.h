@@ -0,0 +1,116 @@
+/******************************************************************************
+ * File: invariant_checker.h
+ * Description: check of invariant on generated states with traces to
+ *              violating states, shared by both state makers.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef INVARIANT_CHECKER_H
+#define INVARIANT_CHECKER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "frontier.h"
+#include "invariant.h"
+#include "output_writer.h"
+#include "program.h"
+#include "state_set.h"
+#include "trace_table.h"
+
+/**
+ * @brief turns off flags, which are incompatible with check of invariant:
+ * reductions and projection drop states or values of variables, which
+ * invariant can read, and check is done by one thread
+ * @param others - flag, indicates if options of state maker, which aren't
+ * given here, are incompatible too, caller turns them off
+ * @param others_names - names of options of state maker, printed in message
+ * @param threads - number of exploring threads
+ * @param por - flag of partial-order reduction
+ * @param symmetry - flag of symmetry reduction
+ * @param liveness - flag of reset of dead variables
+ * @param blocks - flag of fused local steps
+ * @param projection - names of variables, which differ states
+ * @param dump_filename - name of binary file of states
+ * @return true if some flag is turned off
+ */
+bool TurnOffForCheck(bool others, const char* others_names, size_t& threads, bool& por, bool& symmetry, bool& liveness,
+                     bool& blocks, const char*& projection, const char*& dump_filename);
+
+/**
+ * @brief generates states of program by one thread without reductions until
+ * invariant is violated. Parent and step of every state are kept in
+ * TraceTable, so trace to violating state is repeated from initial state and
+ * printed instead of states. In breadth-first order levels are whole, so
+ * every trace is shortest.
+ */
+class InvariantChecker
+{
+public:
+/**
+ * @brief class constructor
+ * @param program - loaded program
+ * @param invariant - property of all states
+ * @param old - set of generated states
+ * @param writer - output of traces
+ */
+    InvariantChecker(const Program& program, const Invariant& invariant, StateSet& old, OutputWriter& writer);
+
+/**
+ * @brief explores states from initial state
+ * @param order - order of states exploration
+ * @param limit - number of violations, after which exploration is stopped
+ * @return number of found violations
+ */
+    size_t Run(SearchOrder order, size_t limit);
+
+/**
+ * @brief prints result of check in console
+ * @param count_flag - flag, indicates if numbers of states and levels are printed
+ */
+    void Print(bool count_flag) const;
+private:
+/**
+ * @brief stores state and makes its successors, prints trace if invariant
+ * is violated
+ * @param item - generated state with its parent
+ * @param next - place, where successors are added in order of threads
+ * @return false if ids of states are exhausted
+ */
+    bool Check(const TracedState& item, std::vector<TracedState>& next);
+
+/**
+ * @brief prints steps and states from initial state to violating state
+ * @param id - id of violating state
+ */
+    void PrintTrace(uint32_t id);
+
+    const Program& m_program;
+    const StateLayout& m_layout;
+    const Invariant& m_invariant;
+    StateSet& m_old;
+    OutputWriter& m_writer;
+/**
+ * @brief parents of generated states
+ */
+    TraceTable m_parents;
+/**
+ * @brief initial state, where traces start
+ */
+    PackedState m_initial;
+    SearchOrder m_order;
+    size_t m_limit;
+    size_t m_states;
+    size_t m_levels;
+    size_t m_violations;
+/**
+ * @brief flag, indicates if exploration is stopped, because ids of states are exhausted
+ */
+    bool m_stopped;
+// Copy isn't allowed
+    InvariantChecker(InvariantChecker&);
+    InvariantChecker& operator=(InvariantChecker&);
+};
+
+#endif //INVARIANT_CHECKER_H
@@ -0,0 +1,553 @@
+/******************************************************************************
+ * File: ltl.cpp
+ * Description: translation of LTL formula to Buchi automaton.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "ltl.h"
+#include <algorithm>
+#include <iostream>
+#include <ctype.h>
+#include <string.h>
+using namespace std;
+
+/**
+ * @brief checks if character continues name of variable or operator word
+ * @param c - character
+ */
+static bool IsNameChar(char c)
+{
+    return c != '\0' && (isalnum(c) || strchr("_.[]", c));
+}
+
+/**
+ * @brief class constructor, makes empty automaton
+ */
+BuchiAutomaton::BuchiAutomaton(): m_text()
+                                , m_formulas()
+                                , m_unique()
+                                , m_atoms()
+                                , m_targets()
+                                , m_literals()
+                                , m_accepting()
+                                , m_layout(NULL)
+                                , m_position(NULL)
+{
+}
+
+/**
+ * @brief parses formula and makes automaton of its negation, errors are
+ * printed to cerr
+ * @param layout - placement of fields in packed state
+ * @param text - text of formula
+ * @return false if formula is malformed or has unknown name
+ */
+bool BuchiAutomaton::Parse(const StateLayout& layout, const char* text)
+{
+    m_text = text;
+    m_formulas.clear();
+    m_unique.clear();
+    m_atoms.clear();
+    m_targets.clear();
+    m_literals.clear();
+    m_accepting.clear();
+    m_layout = &layout;
+    m_position = text;
+    size_t formula;
+    bool parsed = ParseImplication(formula);
+    SkipSpaces();
+    if(parsed && *m_position != '\0')
+    {
+        cerr<<"Unexpected '"<<m_position<<"' in LTL formula"<<endl;
+        parsed = false;
+    }
+    m_layout = NULL;
+    m_position = NULL;
+    if(!parsed)
+        return false;
+    // runs of automaton are counterexamples, so it accepts negation
+    TableauNode node;
+    node.incoming.insert(0);
+    node.pending.insert(Normal(formula, true));
+    vector<TableauNode> nodes;
+    Expand(node, nodes);
+    Build(nodes);
+    return true;
+}
+
+/**
+ * @brief finds values of atoms in state of program
+ * @param layout - placement of fields in packed state, same as of Parse
+ * @param state - packed state of program
+ * @param values - place for values by index of atom
+ */
+void BuchiAutomaton::Evaluate(const StateLayout& layout, const PackedState& state, vector<bool>& values) const
+{
+    values.resize(m_atoms.size());
+    for(size_t i = 0; i < m_atoms.size(); ++i)
+        values[i] = m_atoms[i].Holds(layout, state);
+}
+
+/**
+ * @brief finds states after state, which edges hold in entered state of
+ * program
+ * @param state - index of state
+ * @param values - values of atoms in entered state of program
+ * @param next - place, where indexes of states are added
+ */
+void BuchiAutomaton::Successors(size_t state, const vector<bool>& values, vector<size_t>& next) const
+{
+    const vector<size_t>& targets = m_targets[state];
+    for(size_t i = 0; i < targets.size(); ++i)
+    {
+        const vector<Literal>& literals = m_literals[targets[i]];
+        bool holds = true;
+        for(size_t j = 0; j < literals.size() && holds; ++j)
+            holds = values[literals[j].atom] == literals[j].positive;
+        if(holds)
+            next.push_back(targets[i]);
+    }
+}
+
+/**
+ * @brief finds or adds subformula
+ * @param kind - kind of subformula
+ * @param left - index of first operand or atom
+ * @param right - index of second operand
+ * @return index of subformula
+ */
+size_t BuchiAutomaton::MakeFormula(FormulaKind kind, size_t left, size_t right)
+{
+    pair<int, pair<size_t, size_t> > key(kind, make_pair(left, right));
+    map<pair<int, pair<size_t, size_t> >, size_t>::const_iterator found = m_unique.find(key);
+    if(found != m_unique.end())
+        return found->second;
+    Formula formula = {kind, left, right};
+    m_formulas.push_back(formula);
+    m_unique[key] = m_formulas.size() - 1;
+    return m_formulas.size() - 1;
+}
+
+/**
+ * @brief parses implication, it is weakest and right associative
+ * @param formula - place for index of formula
+ * @return false if formula is malformed
+ */
+bool BuchiAutomaton::ParseImplication(size_t& formula)
+{
+    if(!ParseOr(formula))
+        return false;
+    if(!Accept("->"))
+        return true;
+    size_t right;
+    if(!ParseImplication(right))
+        return false;
+    formula = MakeFormula(LTL_OR, MakeFormula(LTL_NOT, formula, 0), right);
+    return true;
+}
+
+/**
+ * @brief parses disjunction
+ * @param formula - place for index of formula
+ * @return false if formula is malformed
+ */
+bool BuchiAutomaton::ParseOr(size_t& formula)
+{
+    if(!ParseAnd(formula))
+        return false;
+    while(Accept("||"))
+    {
+        size_t right;
+        if(!ParseAnd(right))
+            return false;
+        formula = MakeFormula(LTL_OR, formula, right);
+    }
+    return true;
+}
+
+/**
+ * @brief parses conjunction
+ * @param formula - place for index of formula
+ * @return false if formula is malformed
+ */
+bool BuchiAutomaton::ParseAnd(size_t& formula)
+{
+    if(!ParseBinary(formula))
+        return false;
+    while(Accept("&&"))
+    {
+        size_t right;
+        if(!ParseBinary(right))
+            return false;
+        formula = MakeFormula(LTL_AND, formula, right);
+    }
+    return true;
+}
+
+/**
+ * @brief parses until and release, they are right associative
+ * @param formula - place for index of formula
+ * @return false if formula is malformed
+ */
+bool BuchiAutomaton::ParseBinary(size_t& formula)
+{
+    if(!ParseUnary(formula))
+        return false;
+    FormulaKind kind;
+    if(AcceptWord("U"))
+        kind = LTL_UNTIL;
+    else if(AcceptWord("R"))
+        kind = LTL_RELEASE;
+    else
+        return true;
+    size_t right;
+    if(!ParseBinary(right))
+        return false;
+    formula = MakeFormula(kind, formula, right);
+    return true;
+}
+
+/**
+ * @brief parses negation, temporal operator, formula in parentheses, constant
+ * or atom
+ * @param formula - place for index of formula
+ * @return false if formula is malformed
+ */
+bool BuchiAutomaton::ParseUnary(size_t& formula)
+{
+    // != is comparison, so ! is negation only before operand
+    SkipSpaces();
+    if(m_position[0] == '!' && m_position[1] != '=')
+    {
+        ++m_position;
+        if(!ParseUnary(formula))
+            return false;
+        formula = MakeFormula(LTL_NOT, formula, 0);
+        return true;
+    }
+    // F p is true U p, G p is false R p
+    const char* words[] = {"X", "F", "G"};
+    for(size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+    {
+        if(!AcceptWord(words[i]))
+            continue;
+        size_t operand;
+        if(!ParseUnary(operand))
+            return false;
+        if(i == 0)
+            formula = MakeFormula(LTL_NEXT, operand, 0);
+        else if(i == 1)
+            formula = MakeFormula(LTL_UNTIL, MakeFormula(LTL_TRUE, 0, 0), operand);
+        else
+            formula = MakeFormula(LTL_RELEASE, MakeFormula(LTL_FALSE, 0, 0), operand);
+        return true;
+    }
+    if(Accept("("))
+    {
+        if(!ParseImplication(formula))
+            return false;
+        if(!Accept(")"))
+        {
+            cerr<<"Expected ')' in LTL formula"<<endl;
+            return false;
+        }
+        return true;
+    }
+    if(AcceptWord("true"))
+    {
+        formula = MakeFormula(LTL_TRUE, 0, 0);
+        return true;
+    }
+    if(AcceptWord("false"))
+    {
+        formula = MakeFormula(LTL_FALSE, 0, 0);
+        return true;
+    }
+    return ParseAtom(formula);
+}
+
+/**
+ * @brief parses comparison of two operands or operand alone as invariant
+ * @param formula - place for index of formula
+ * @return false if atom is malformed
+ */
+bool BuchiAutomaton::ParseAtom(size_t& formula)
+{
+    // text of atom ends after second operand, invariant parses it
+    SkipSpaces();
+    const char* begin = m_position;
+    for(int operand = 0; operand < 2; ++operand)
+    {
+        if(*m_position == '#' || *m_position == '-')
+            ++m_position;
+        while(IsNameChar(*m_position))
+            ++m_position;
+        if(operand > 0)
+            break;
+        const char* end = m_position;
+        SkipSpaces();
+        const char* symbols[] = {"==", "!=", "<=", ">=", "<", ">"};
+        size_t i = 0;
+        while(i < sizeof(symbols) / sizeof(symbols[0]) && !Accept(symbols[i]))
+            ++i;
+        if(i == sizeof(symbols) / sizeof(symbols[0]))
+        {
+            m_position = end;
+            break;
+        }
+        SkipSpaces();
+    }
+    string text(begin, m_position);
+    if(text.empty())
+    {
+        cerr<<"Expected atom at '"<<begin<<"' in LTL formula"<<endl;
+        return false;
+    }
+    size_t atom = 0;
+    while(atom < m_atoms.size() && m_atoms[atom].Text() != text)
+        ++atom;
+    if(atom == m_atoms.size())
+    {
+        Invariant invariant;
+        if(!invariant.Parse(*m_layout, text.c_str(), "LTL formula"))
+            return false;
+        m_atoms.push_back(invariant);
+    }
+    formula = MakeFormula(LTL_ATOM, atom, 0);
+    return true;
+}
+
+/**
+ * @brief takes word, if text continues with it and it isn't part of name
+ * @param word - expected word
+ * @return true if word is taken
+ */
+bool BuchiAutomaton::AcceptWord(const char* word)
+{
+    SkipSpaces();
+    size_t length = strlen(word);
+    if(strncmp(m_position, word, length) != 0 || IsNameChar(m_position[length]))
+        return false;
+    m_position += length;
+    return true;
+}
+
+/**
+ * @brief takes symbol, if text continues with it
+ * @param symbol - expected symbol
+ * @return true if symbol is taken
+ */
+bool BuchiAutomaton::Accept(const char* symbol)
+{
+    SkipSpaces();
+    size_t length = strlen(symbol);
+    if(strncmp(m_position, symbol, length) != 0)
+        return false;
+    m_position += length;
+    return true;
+}
+
+/**
+ * @brief skips spaces of text
+ */
+void BuchiAutomaton::SkipSpaces()
+{
+    while(isspace(*m_position))
+        ++m_position;
+}
+
+/**
+ * @brief makes negation normal form of formula or of its negation
+ * @param formula - index of formula
+ * @param negate - flag, indicates if formula is negated
+ * @return index of normal formula
+ */
+size_t BuchiAutomaton::Normal(size_t formula, bool negate)
+{
+    // vector can grow, so formula is copied
+    Formula source = m_formulas[formula];
+    switch(source.kind)
+    {
+        case LTL_TRUE:
+        case LTL_FALSE:
+            return MakeFormula((source.kind == LTL_TRUE) != negate ? LTL_TRUE : LTL_FALSE, 0, 0);
+        case LTL_ATOM:
+        case LTL_NOT_ATOM:
+            return MakeFormula((source.kind == LTL_ATOM) != negate ? LTL_ATOM : LTL_NOT_ATOM, source.left, 0);
+        case LTL_NOT:
+            return Normal(source.left, !negate);
+        case LTL_AND:
+        case LTL_OR:
+        {
+            size_t left = Normal(source.left, negate);
+            size_t right = Normal(source.right, negate);
+            return MakeFormula((source.kind == LTL_AND) != negate ? LTL_AND : LTL_OR, left, right);
+        }
+        case LTL_NEXT:
+            return MakeFormula(LTL_NEXT, Normal(source.left, negate), 0);
+        case LTL_UNTIL:
+        case LTL_RELEASE:
+        {
+            size_t left = Normal(source.left, negate);
+            size_t right = Normal(source.right, negate);
+            return MakeFormula((source.kind == LTL_UNTIL) != negate ? LTL_UNTIL : LTL_RELEASE, left, right);
+        }
+    }
+    return formula;
+}
+
+/**
+ * @brief expands tableau node until all its formulas are processed
+ * @param node - expanded node
+ * @param nodes - place for complete nodes, index in vector is index of node
+ * minus 1
+ */
+void BuchiAutomaton::Expand(TableauNode node, vector<TableauNode>& nodes)
+{
+    if(node.pending.empty())
+    {
+        // node with same formulas gets edges of this one
+        for(size_t i = 0; i < nodes.size(); ++i)
+        {
+            if(nodes[i].old == node.old && nodes[i].next == node.next)
+            {
+                nodes[i].incoming.insert(node.incoming.begin(), node.incoming.end());
+                return;
+            }
+        }
+        nodes.push_back(node);
+        TableauNode successor;
+        successor.incoming.insert(nodes.size());
+        successor.pending = node.next;
+        Expand(successor, nodes);
+        return;
+    }
+    size_t formula = *node.pending.begin();
+    node.pending.erase(node.pending.begin());
+    if(node.old.count(formula))
+    {
+        Expand(node, nodes);
+        return;
+    }
+    Formula source = m_formulas[formula];
+    switch(source.kind)
+    {
+        case LTL_FALSE:
+            return;
+        case LTL_TRUE:
+            node.old.insert(formula);
+            Expand(node, nodes);
+            return;
+        case LTL_ATOM:
+        case LTL_NOT_ATOM:
+        {
+            // node with atom and its negation has no runs
+            size_t complement = MakeFormula(source.kind == LTL_ATOM ? LTL_NOT_ATOM : LTL_ATOM, source.left, 0);
+            if(node.old.count(complement))
+                return;
+            node.old.insert(formula);
+            Expand(node, nodes);
+            return;
+        }
+        case LTL_AND:
+            node.old.insert(formula);
+            node.pending.insert(source.left);
+            node.pending.insert(source.right);
+            Expand(node, nodes);
+            return;
+        case LTL_NEXT:
+            node.old.insert(formula);
+            node.next.insert(source.left);
+            Expand(node, nodes);
+            return;
+        case LTL_NOT:
+            // negations are removed by normalization
+            return;
+        case LTL_OR:
+        case LTL_UNTIL:
+        case LTL_RELEASE:
+        {
+            // p U q is q or p and next p U q, p R q is q and p or q and next p R q
+            TableauNode first = node;
+            TableauNode second = node;
+            first.old.insert(formula);
+            second.old.insert(formula);
+            if(source.kind == LTL_OR)
+            {
+                first.pending.insert(source.left);
+                second.pending.insert(source.right);
+            }
+            else if(source.kind == LTL_UNTIL)
+            {
+                first.pending.insert(source.left);
+                first.next.insert(formula);
+                second.pending.insert(source.right);
+            }
+            else
+            {
+                first.pending.insert(source.right);
+                first.next.insert(formula);
+                second.pending.insert(source.left);
+                second.pending.insert(source.right);
+            }
+            Expand(first, nodes);
+            Expand(second, nodes);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief makes degeneralized automaton of complete tableau nodes
+ * @param nodes - complete nodes
+ */
+void BuchiAutomaton::Build(const vector<TableauNode>& nodes)
+{
+    // every until subformula of nodes is acceptance condition
+    vector<size_t> untils;
+    for(size_t i = 0; i < nodes.size(); ++i)
+        for(set<size_t>::const_iterator j = nodes[i].old.begin(); j != nodes[i].old.end(); ++j)
+            if(m_formulas[*j].kind == LTL_UNTIL && find(untils.begin(), untils.end(), *j) == untils.end())
+                untils.push_back(*j);
+    size_t conditions = untils.empty() ? 1 : untils.size();
+    // node i of accepted set of condition c has p U q only with q
+    vector<vector<bool> > accepted(nodes.size() + 1, vector<bool>(conditions, untils.empty()));
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        const set<size_t>& old = nodes[i].old;
+        for(size_t c = 0; c < untils.size(); ++c)
+            accepted[i + 1][c] = !old.count(untils[c]) || old.count(m_formulas[untils[c]].right);
+    }
+    accepted[0].assign(conditions, false);
+    // state of automaton is node and number of awaited condition
+    size_t states = (nodes.size() + 1) * conditions;
+    m_targets.assign(states, vector<size_t>());
+    m_literals.assign(states, vector<Literal>());
+    m_accepting.assign(states, false);
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        vector<Literal> literals;
+        const set<size_t>& old = nodes[i].old;
+        for(set<size_t>::const_iterator j = old.begin(); j != old.end(); ++j)
+        {
+            if(m_formulas[*j].kind != LTL_ATOM && m_formulas[*j].kind != LTL_NOT_ATOM)
+                continue;
+            Literal literal = {m_formulas[*j].left, m_formulas[*j].kind == LTL_ATOM};
+            literals.push_back(literal);
+        }
+        for(size_t c = 0; c < conditions; ++c)
+            m_literals[(i + 1) * conditions + c] = literals;
+        for(set<size_t>::const_iterator j = nodes[i].incoming.begin(); j != nodes[i].incoming.end(); ++j)
+        {
+            for(size_t c = 0; c < conditions; ++c)
+            {
+                size_t next = accepted[*j][c] ? (c + 1) % conditions : c;
+                m_targets[*j * conditions + c].push_back((i + 1) * conditions + next);
+            }
+        }
+    }
+    for(size_t i = 0; i <= nodes.size(); ++i)
+        m_accepting[i * conditions] = accepted[i][0];
+}
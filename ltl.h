@@ -0,0 +1,215 @@
+/******************************************************************************
+ * File: ltl.h
+ * Description: translation of LTL formula to Buchi automaton.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef LTL_H
+#define LTL_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include "invariant.h"
+#include "state_codec.h"
+
+/**
+ * @brief Buchi automaton of negation of LTL formula like
+ * "G (h==# || h<7) && F g.counter==g.end". Formula has operators X, F, G,
+ * U, R, !, &&, ||, -> and parentheses, atoms are comparisons of invariants
+ * (see invariant.h). Negation is translated by tableau of Gerth, Peled,
+ * Vardi and Wolper, and generalized acceptance of until subformulas is
+ * counted by copies of tableau. Edge to automaton state holds, if literals
+ * of its tableau node hold in entered state of program, so accepted runs
+ * over states of program are runs, which violate formula.
+ */
+class BuchiAutomaton
+{
+public:
+/**
+ * @brief class constructor, makes empty automaton
+ */
+    BuchiAutomaton();
+
+/**
+ * @brief parses formula and makes automaton of its negation, errors are
+ * printed to cerr
+ * @param layout - placement of fields in packed state
+ * @param text - text of formula
+ * @return false if formula is malformed or has unknown name
+ */
+    bool Parse(const StateLayout& layout, const char* text);
+
+/**
+ * @brief text of formula
+ */
+    const std::string& Text() const
+    {
+        return m_text;
+    }
+
+/**
+ * @brief number of states
+ */
+    size_t States() const
+    {
+        return m_targets.size();
+    }
+
+/**
+ * @brief state before first state of program
+ */
+    size_t Initial() const
+    {
+        return 0;
+    }
+
+/**
+ * @brief checks if state is accepting
+ * @param state - index of state
+ */
+    bool Accepting(size_t state) const
+    {
+        return m_accepting[state];
+    }
+
+/**
+ * @brief finds values of atoms in state of program
+ * @param layout - placement of fields in packed state, same as of Parse
+ * @param state - packed state of program
+ * @param values - place for values by index of atom
+ */
+    void Evaluate(const StateLayout& layout, const PackedState& state, std::vector<bool>& values) const;
+
+/**
+ * @brief finds states after state, which edges hold in entered state of
+ * program
+ * @param state - index of state
+ * @param values - values of atoms in entered state of program
+ * @param next - place, where indexes of states are added
+ */
+    void Successors(size_t state, const std::vector<bool>& values, std::vector<size_t>& next) const;
+private:
+/**
+ * @brief kind of subformula, negation of atom is kept after normalization,
+ * other negations are pushed to atoms
+ */
+    enum FormulaKind
+    {
+        LTL_TRUE,
+        LTL_FALSE,
+        LTL_ATOM,
+        LTL_NOT_ATOM,
+        LTL_NOT,
+        LTL_AND,
+        LTL_OR,
+        LTL_NEXT,
+        LTL_UNTIL,
+        LTL_RELEASE
+    };
+
+/**
+ * @brief subformula, equal subformulas have one index
+ */
+    struct Formula
+    {
+        FormulaKind kind;
+/**
+ * @brief index of first operand or atom
+ */
+        size_t left;
+        size_t right;
+    };
+
+/**
+ * @brief node of tableau, formulas are sets of indexes of subformulas
+ */
+    struct TableauNode
+    {
+/**
+ * @brief nodes with edges to this node, 0 is initial node
+ */
+        std::set<size_t> incoming;
+/**
+ * @brief formulas, which aren't processed yet
+ */
+        std::set<size_t> pending;
+/**
+ * @brief formulas, which hold in node
+ */
+        std::set<size_t> old;
+/**
+ * @brief formulas, which hold in next node
+ */
+        std::set<size_t> next;
+    };
+
+/**
+ * @brief literal of tableau node
+ */
+    struct Literal
+    {
+        size_t atom;
+        bool positive;
+    };
+
+    size_t MakeFormula(FormulaKind kind, size_t left, size_t right);
+    bool ParseImplication(size_t& formula);
+    bool ParseOr(size_t& formula);
+    bool ParseAnd(size_t& formula);
+    bool ParseBinary(size_t& formula);
+    bool ParseUnary(size_t& formula);
+    bool ParseAtom(size_t& formula);
+    bool AcceptWord(const char* word);
+    bool Accept(const char* symbol);
+    void SkipSpaces();
+
+/**
+ * @brief makes negation normal form of formula or of its negation
+ * @param formula - index of formula
+ * @param negate - flag, indicates if formula is negated
+ * @return index of normal formula
+ */
+    size_t Normal(size_t formula, bool negate);
+
+/**
+ * @brief expands tableau node until all its formulas are processed
+ * @param node - expanded node
+ * @param nodes - place for complete nodes, index in vector is index of node
+ * minus 1
+ */
+    void Expand(TableauNode node, std::vector<TableauNode>& nodes);
+
+/**
+ * @brief makes degeneralized automaton of complete tableau nodes
+ * @param nodes - complete nodes
+ */
+    void Build(const std::vector<TableauNode>& nodes);
+
+    std::string m_text;
+    std::vector<Formula> m_formulas;
+/**
+ * @brief indexes of subformulas by their kind and operands
+ */
+    std::map<std::pair<int, std::pair<size_t, size_t> >, size_t> m_unique;
+    std::vector<Invariant> m_atoms;
+/**
+ * @brief states after every state
+ */
+    std::vector<std::vector<size_t> > m_targets;
+/**
+ * @brief literals of every state, which hold in entered state of program
+ */
+    std::vector<std::vector<Literal> > m_literals;
+    std::vector<bool> m_accepting;
+/**
+ * @brief layout and position in text during parsing
+ */
+    const StateLayout* m_layout;
+    const char* m_position;
+};
+
+#endif //LTL_H
@@ -0,0 +1,307 @@
+/******************************************************************************
+ * File: ltl_checker.cpp
+ * Description: on-the-fly check of LTL formula over states of program.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "ltl_checker.h"
+#include <algorithm>
+#include <map>
+using namespace std;
+
+/**
+ * @brief class constructor
+ * @param program - loaded program
+ * @param automaton - automaton of negation of formula
+ * @param fair - flag, indicates if only weakly fair runs are checked
+ * @param capacity - number of states, allocated before exploration
+ */
+LtlChecker::LtlChecker(const Program& program, const BuchiAutomaton& automaton, bool fair, size_t capacity):
+                                                                                                  m_program(program)
+                                                                                                , m_layout(program.Layout())
+                                                                                                , m_automaton(automaton)
+                                                                                                , m_fair(fair)
+                                                                                                , m_store(m_layout.Words() + 1, capacity, 0.7)
+                                                                                                , m_search(*this)
+                                                                                                , m_values()
+                                                                                                , m_targets()
+                                                                                                , m_initial()
+                                                                                                , m_prefix()
+                                                                                                , m_cycle()
+{
+}
+
+/**
+ * @brief explores product until counterexample is found
+ * @return true if formula holds
+ */
+bool LtlChecker::Run()
+{
+    m_store.Clear();
+    m_search.Clear();
+    m_prefix.clear();
+    m_cycle.clear();
+    m_program.Initial(m_initial);
+    // first states of product are edges of automaton to initial state of program
+    m_automaton.Evaluate(m_layout, m_initial, m_values);
+    vector<size_t> roots;
+    m_automaton.Successors(m_automaton.Initial(), m_values, roots);
+    for(size_t i = 0; i < roots.size(); ++i)
+    {
+        ProductState root = {m_initial, roots[i]};
+        if(!m_search.Run(root))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief prints steps from initial state to cycle and steps of cycle
+ * @param stream - output stream
+ */
+void LtlChecker::PrintCounterexample(ostream& stream) const
+{
+    stream<<"Formula "<<m_automaton.Text()<<" is violated by run:\n";
+    m_layout.Print(stream, m_initial, ", ");
+    stream<<"\n";
+    PrintSteps(stream, m_prefix);
+    stream<<"Cycle of run:\n";
+    PrintSteps(stream, m_cycle);
+    stream.flush();
+}
+
+/**
+ * @brief makes steps of product from state
+ * @param state - state of product
+ * @param edges - place, where steps are added
+ */
+void LtlChecker::Successors(const ProductState& state, vector<Edge>& edges)
+{
+    bool stepped = false;
+    for(size_t i = 0; i < m_program.Threads(); ++i)
+    {
+        Edge edge;
+        edge.target.state = state.state;
+        edge.thread = i;
+        edge.transition = m_program.Step(edge.target.state, i);
+        if(!edge.transition)
+            continue;
+        stepped = true;
+        m_automaton.Evaluate(m_layout, edge.target.state, m_values);
+        m_targets.clear();
+        m_automaton.Successors(state.automaton, m_values, m_targets);
+        for(size_t j = 0; j < m_targets.size(); ++j)
+        {
+            edge.target.automaton = m_targets[j];
+            edges.push_back(edge);
+        }
+    }
+    if(stepped)
+        return;
+    // finished or blocked program repeats its state forever
+    Edge edge;
+    edge.target.state = state.state;
+    edge.thread = NoThread;
+    edge.transition = NULL;
+    m_automaton.Evaluate(m_layout, state.state, m_values);
+    m_targets.clear();
+    m_automaton.Successors(state.automaton, m_values, m_targets);
+    for(size_t j = 0; j < m_targets.size(); ++j)
+    {
+        edge.target.automaton = m_targets[j];
+        edges.push_back(edge);
+    }
+}
+
+/**
+ * @brief finds id of state, adds state if it isn't generated
+ * @param state - state of product
+ * @param id - place for id
+ * @return true if state is added
+ */
+bool LtlChecker::Find(const ProductState& state, uint32_t& id)
+{
+    // state of automaton is word after words of program
+    uint64_t key[MaxStateWords + 1];
+    size_t words = m_layout.Words();
+    copy(state.state.words, state.state.words + words, key);
+    key[words] = state.automaton;
+    size_t index;
+    bool added = m_store.FindOrInsert(key, index);
+    id = uint32_t(index);
+    return added;
+}
+
+/**
+ * @brief checks closed component, makes counterexample if component is
+ * accepting and fair
+ * @param root - id of root
+ * @param begin - index of root in members of search
+ * @return true if counterexample is found
+ */
+bool LtlChecker::Close(uint32_t root, size_t begin)
+{
+    const vector<ComponentSearch<LtlChecker>::Member>& members = m_search.Members();
+    size_t threads = m_program.Threads();
+    size_t accepting = members.size();
+    bool cycle = false;
+    // witness of thread is its step inside component or state, where it's disabled
+    vector<bool> moved(threads, false);
+    vector<Edge> moves(threads);
+    vector<size_t> disabled(threads, members.size());
+    vector<Edge> edges;
+    for(size_t i = begin; i < members.size(); ++i)
+    {
+        const ProductState& state = members[i].state;
+        if(m_automaton.Accepting(state.automaton) && accepting == members.size())
+            accepting = i;
+        for(size_t j = 0; j < threads; ++j)
+        {
+            PackedState next = state.state;
+            if(disabled[j] == members.size() && !m_program.Step(next, j))
+                disabled[j] = i;
+        }
+        edges.clear();
+        Successors(state, edges);
+        for(size_t j = 0; j < edges.size(); ++j)
+        {
+            uint32_t id;
+            Find(edges[j].target, id);
+            if(!m_search.InComponent(id, root))
+                continue;
+            cycle = true;
+            if(edges[j].thread != NoThread && !moved[edges[j].thread])
+            {
+                moved[edges[j].thread] = true;
+                moves[edges[j].thread] = edges[j];
+                moves[edges[j].thread].target = state;
+            }
+        }
+    }
+    bool fair = true;
+    for(size_t i = 0; i < threads && m_fair; ++i)
+        fair = fair && (moved[i] || disabled[i] < members.size());
+    if(!cycle || accepting == members.size() || !fair)
+        return false;
+    // prefix is path of search to root of component
+    m_search.Path(m_prefix);
+    // cycle goes through accepting state and witnesses of fairness
+    ProductState current = members[begin].state;
+    uint32_t id;
+    Find(members[accepting].state, id);
+    FindPath(current, id, root, m_cycle);
+    current = members[accepting].state;
+    for(size_t i = 0; i < threads && m_fair; ++i)
+    {
+        if(moved[i])
+        {
+            // source of step is kept as target of witness
+            Edge step = moves[i];
+            Find(step.target, id);
+            FindPath(current, id, root, m_cycle);
+            edges.clear();
+            Successors(step.target, edges);
+            for(size_t j = 0; j < edges.size(); ++j)
+            {
+                Find(edges[j].target, id);
+                if(edges[j].thread == i && m_search.InComponent(id, root))
+                {
+                    m_cycle.push_back(edges[j]);
+                    current = edges[j].target;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            Find(members[disabled[i]].state, id);
+            FindPath(current, id, root, m_cycle);
+            current = members[disabled[i]].state;
+        }
+    }
+    Find(current, id);
+    if(m_cycle.empty() && id == root)
+    {
+        // cycle has at least one step
+        edges.clear();
+        Successors(current, edges);
+        for(size_t j = 0; j < edges.size(); ++j)
+        {
+            Find(edges[j].target, id);
+            if(m_search.InComponent(id, root))
+            {
+                m_cycle.push_back(edges[j]);
+                current = edges[j].target;
+                break;
+            }
+        }
+    }
+    FindPath(current, root, root, m_cycle);
+    return true;
+}
+
+/**
+ * @brief finds shortest steps inside component from state to state
+ * @param from - first state
+ * @param to - id of last state
+ * @param root - id of root of component
+ * @param steps - place, where steps are added
+ */
+void LtlChecker::FindPath(const ProductState& from, uint32_t to, uint32_t root, vector<Edge>& steps)
+{
+    uint32_t first;
+    Find(from, first);
+    if(first == to)
+        return;
+    // states of breadth-first search with their parents and steps to them
+    map<uint32_t, pair<uint32_t, Edge> > parents;
+    vector<ProductState> queue(1, from);
+    vector<uint32_t> ids(1, first);
+    vector<Edge> edges;
+    Edge none = {from, NoThread, NULL};
+    parents[first] = make_pair(first, none);
+    for(size_t i = 0; i < queue.size(); ++i)
+    {
+        edges.clear();
+        Successors(queue[i], edges);
+        for(size_t j = 0; j < edges.size(); ++j)
+        {
+            uint32_t id;
+            Find(edges[j].target, id);
+            if(!m_search.InComponent(id, root) || parents.count(id))
+                continue;
+            parents[id] = make_pair(ids[i], edges[j]);
+            if(id == to)
+            {
+                vector<Edge> path;
+                for(; id != first; id = parents[id].first)
+                    path.push_back(parents[id].second);
+                steps.insert(steps.end(), path.rbegin(), path.rend());
+                return;
+            }
+            queue.push_back(edges[j].target);
+            ids.push_back(id);
+        }
+    }
+}
+
+/**
+ * @brief prints steps and states after them
+ * @param stream - output stream
+ * @param steps - steps
+ */
+void LtlChecker::PrintSteps(ostream& stream, const vector<Edge>& steps) const
+{
+    for(size_t i = 0; i < steps.size(); ++i)
+    {
+        if(steps[i].thread == NoThread)
+            stream<<"    all threads are finished or blocked\n";
+        else
+            stream<<"    "<<m_program.ThreadName(steps[i].thread)<<": "<<steps[i].transition->label
+                  <<" (line "<<steps[i].transition->line<<")\n";
+        m_layout.Print(stream, steps[i].target.state, ", ");
+        stream<<"\n";
+    }
+}
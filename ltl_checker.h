@@ -0,0 +1,179 @@
+/******************************************************************************
+ * File: ltl_checker.h
+ * Description: on-the-fly check of LTL formula over states of program.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef LTL_CHECKER_H
+#define LTL_CHECKER_H
+
+#include <ostream>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "component_search.h"
+#include "ltl.h"
+#include "program.h"
+#include "visited_store.h"
+
+/**
+ * @brief thread of stutter step of product
+ */
+const size_t NoThread = ~size_t(0);
+
+/**
+ * @brief checks LTL formula by product of program and Buchi automaton of
+ * its negation. Product states are made lazily by steps of threads and
+ * edges of automaton, and are stored in visited store with automaton state
+ * as additional word of key. Strongly connected components are found by
+ * ComponentSearch, ids of store are indexes of states. Component, which
+ * has cycle and accepting state, is counterexample. With weak fairness
+ * every thread should step inside component or be disabled in some of its
+ * states, so run, which is always inside component, is fair. Finished or
+ * blocked program stutters, so finite runs are infinite too.
+ */
+class LtlChecker
+{
+public:
+/**
+ * @brief class constructor
+ * @param program - loaded program
+ * @param automaton - automaton of negation of formula
+ * @param fair - flag, indicates if only weakly fair runs are checked
+ * @param capacity - number of states, allocated before exploration
+ */
+    LtlChecker(const Program& program, const BuchiAutomaton& automaton, bool fair, size_t capacity);
+
+/**
+ * @brief explores product until counterexample is found
+ * @return true if formula holds
+ */
+    bool Run();
+
+/**
+ * @brief prints steps from initial state to cycle and steps of cycle
+ * @param stream - output stream
+ */
+    void PrintCounterexample(std::ostream& stream) const;
+
+/**
+ * @brief number of generated states of product
+ */
+    size_t States() const
+    {
+        return m_store.Size();
+    }
+private:
+    friend class ComponentSearch<LtlChecker>;
+
+/**
+ * @brief state of program and state of automaton
+ */
+    struct ProductState
+    {
+        PackedState state;
+        size_t automaton;
+    };
+    typedef ProductState State;
+
+/**
+ * @brief step of product, thread is NoThread for stutter of finished or
+ * blocked program
+ */
+    struct Edge
+    {
+        ProductState target;
+        size_t thread;
+        const Transition* transition;
+    };
+
+/**
+ * @brief makes steps of product from state
+ * @param state - state of product
+ * @param edges - place, where steps are added
+ */
+    void Successors(const ProductState& state, std::vector<Edge>& edges);
+
+/**
+ * @brief finds id of state, adds state if it isn't generated
+ * @param state - state of product
+ * @param id - place for id
+ * @return true if state is added
+ */
+    bool Find(const ProductState& state, uint32_t& id);
+
+/**
+ * @brief new state of product isn't checked before its component is closed
+ * @param state - state of product
+ * @param id - id of state
+ * @param steps - number of steps from state
+ */
+    void Enter(const ProductState&, uint32_t, size_t)
+    {
+    }
+
+/**
+ * @brief step to explored state isn't checked before its component is closed
+ * @param from - id of state
+ * @param to - id of explored state
+ * @param closed - flag, indicates if component of explored state is closed
+ */
+    void Leave(uint32_t, uint32_t, bool)
+    {
+    }
+
+/**
+ * @brief checks closed component, makes counterexample if component is
+ * accepting and fair
+ * @param root - id of root
+ * @param begin - index of root in members of search
+ * @return true if counterexample is found
+ */
+    bool Close(uint32_t root, size_t begin);
+
+/**
+ * @brief finds shortest steps inside component from state to state
+ * @param from - first state
+ * @param to - id of last state
+ * @param root - id of root of component
+ * @param steps - place, where steps are added
+ */
+    void FindPath(const ProductState& from, uint32_t to, uint32_t root, std::vector<Edge>& steps);
+
+/**
+ * @brief prints steps and states after them
+ * @param stream - output stream
+ * @param steps - steps
+ */
+    void PrintSteps(std::ostream& stream, const std::vector<Edge>& steps) const;
+
+    const Program& m_program;
+    const StateLayout& m_layout;
+    const BuchiAutomaton& m_automaton;
+    bool m_fair;
+    VisitedStore m_store;
+    ComponentSearch<LtlChecker> m_search;
+/**
+ * @brief values of atoms and states of automaton of successor
+ */
+    std::vector<bool> m_values;
+    std::vector<size_t> m_targets;
+/**
+ * @brief initial state of counterexample
+ */
+    PackedState m_initial;
+/**
+ * @brief steps from initial state to cycle of counterexample
+ */
+    std::vector<Edge> m_prefix;
+/**
+ * @brief steps of cycle of counterexample
+ */
+    std::vector<Edge> m_cycle;
+// Copy isn't allowed
+    LtlChecker(LtlChecker&);
+    LtlChecker& operator=(LtlChecker&);
+};
+
+#endif //LTL_CHECKER_H
@@ -0,0 +1,184 @@
+/******************************************************************************
+ * File: lts_writer.cpp
+ * Description: output of labelled transition system in several formats.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "lts_writer.h"
+#include <string.h>
+using namespace std;
+
+/**
+ * @brief first bytes of binary lts
+ */
+const char LtsMagic[8] = {'L', 'T', 'S', 'E', 'D', 'G', 'E', 'S'};
+
+/**
+ * @brief version of binary lts format
+ */
+const uint32_t LtsVersion = 1;
+
+/**
+ * @brief length of first line of aut format with end of line, numbers
+ * are written, when lts is finished, and line is padded by spaces
+ */
+const size_t AutHeaderSize = 64;
+
+/**
+ * @brief appends little-endian number to data
+ * @param data - data to append
+ * @param value - number
+ * @param bytes - size of number
+ */
+static void AppendFixed(string& data, uint64_t value, size_t bytes)
+{
+    for(size_t i = 0; i < bytes; ++i)
+        data += char((value >> (8 * i)) & 0xff);
+}
+
+/**
+ * @brief class constructor, writes beginning of lts
+ * @param stream - output stream, opened in binary mode
+ * @param format - format of lts
+ * @param layout - placement of variables in packed state
+ * @param sync - flag, indicates if every line is flushed at once
+ */
+LtsWriter::LtsWriter(ostream& stream, LtsFormat format, const StateLayout& layout, bool sync): m_stream(stream)
+                                                                                            , m_format(format)
+                                                                                            , m_layout(layout)
+                                                                                            , m_writer(NULL)
+                                                                                            , m_numbers()
+                                                                                            , m_names()
+                                                                                            , m_labels()
+                                                                                            , m_texts()
+                                                                                            , m_states(0)
+                                                                                            , m_edges(0)
+{
+    memset(m_cache, 0, sizeof(m_cache));
+    m_writer = new OutputWriter(m_stream, sync);
+    if(m_format == LTS_DOT)
+    {
+        m_writer->Buffer() += "digraph G{";
+        m_writer->EndLine();
+    }
+    else
+    {
+        // numbers are unknown yet, header is written again by Finish
+        AppendHeader(m_writer->Buffer());
+        m_writer->Commit();
+    }
+}
+
+/**
+ * @brief class destructor
+ */
+LtsWriter::~LtsWriter()
+{
+    delete m_writer;
+}
+
+/**
+ * @brief prints new state
+ * @param id - id of state
+ * @param state - packed state
+ */
+void LtsWriter::Node(size_t id, const PackedState& state)
+{
+    ++m_states;
+    if(m_format != LTS_DOT)
+        return;
+    string& text = m_writer->Buffer();
+    text += "    ";
+    AppendNumber(text, id);
+    text += " [label=\"";
+    m_layout.Print(text, state, " ");
+    text += "\"];";
+    m_writer->EndLine();
+}
+
+/**
+ * @brief writes end of lts and numbers of states and transitions
+ */
+void LtsWriter::Finish()
+{
+    if(m_format == LTS_DOT)
+    {
+        m_writer->Buffer() += "}";
+        m_writer->EndLine();
+        m_writer->Finish();
+        return;
+    }
+    if(m_format == LTS_BINARY)
+    {
+        string& data = m_writer->Buffer();
+        for(size_t i = 0; i < m_labels.size(); ++i)
+        {
+            AppendFixed(data, m_labels[i].size(), 2);
+            data += m_labels[i];
+        }
+    }
+    m_writer->Finish();
+    string header;
+    AppendHeader(header);
+    m_stream.seekp(0);
+    m_stream.write(header.data(), header.size());
+    m_stream.seekp(0, ios::end);
+    m_stream.flush();
+}
+
+/**
+ * @brief interns label, which isn't met by its pointers yet
+ * @param thread - name of thread, which does step
+ * @param label - text of step
+ * @param color - color of transition in dot format
+ */
+uint32_t LtsWriter::AddLabel(const char* thread, const char* label, const char* color)
+{
+    string name = string(thread) + ": " + label;
+    map<string, uint32_t>::const_iterator found = m_names.find(name);
+    uint32_t number = m_labels.size();
+    if(found != m_names.end())
+    {
+        number = found->second;
+    }
+    else
+    {
+        m_names[name] = number;
+        m_labels.push_back(name);
+        if(m_format == LTS_AUT)
+            m_texts.push_back("\"" + name + "\"");
+        else
+            m_texts.push_back(string(" [label = \"") + label + "\" color = \"" + color + "\"];");
+    }
+    m_numbers[LabelKey(thread, label)] = number;
+    return number;
+}
+
+/**
+ * @brief writes header of aut or binary format
+ * @param data - data to append
+ */
+void LtsWriter::AppendHeader(string& data) const
+{
+    if(m_format == LTS_BINARY)
+    {
+        data.append(LtsMagic, sizeof(LtsMagic));
+        AppendFixed(data, LtsVersion, 4);
+        AppendFixed(data, 0, 4);
+        AppendFixed(data, m_states, 8);
+        AppendFixed(data, m_edges, 8);
+        AppendFixed(data, m_labels.size(), 4);
+        AppendFixed(data, 0, 4);
+        return;
+    }
+    size_t begin = data.size();
+    data += "des (0, ";
+    AppendNumber(data, m_edges);
+    data += ", ";
+    AppendNumber(data, m_states);
+    data += ")";
+    data.append(AutHeaderSize - 1 - (data.size() - begin), ' ');
+    data += '\n';
+}
@@ -0,0 +1,263 @@
+/******************************************************************************
+ * File: lts_writer.h
+ * Description: output of labelled transition system in several formats.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef LTS_WRITER_H
+#define LTS_WRITER_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "output_writer.h"
+#include "state_codec.h"
+
+/*
+ * Formats of lts, states are numbered from 0, initial state is 0:
+ * LTS_DOT - Graphviz graph with labels of states, for small systems
+ * LTS_AUT - Aldebaran text
+ *     des (0, <transitions>, <states>)   padded by spaces to fixed length
+ *     (<from>,"<thread>: <label>",<to>)  for every transition
+ * LTS_BINARY - edge list, all numbers are little-endian
+ *     char[8]  magic "LTSEDGES"
+ *     uint32   version
+ *     uint32   flags, 0
+ *     uint64   number of states
+ *     uint64   number of transitions
+ *     uint32   number of labels
+ *     uint32   reserved, 0
+ *     transitions in order of generation
+ *         uint32   from, uint32 label, uint32 to
+ *     labels in order of numbers
+ *         uint16   length of text
+ *         char[]   text "<thread>: <label>"
+ * Edge list is written sequentially, CSR offsets of states are made by one
+ * counting pass over it.
+ */
+
+/**
+ * @brief format of lts file
+ */
+enum LtsFormat
+{
+    LTS_DOT,
+    LTS_AUT,
+    LTS_BINARY
+};
+
+/**
+ * @brief number of entries in cache of label numbers of LtsWriter
+ */
+const size_t LabelCacheSize = 64;
+
+/**
+ * @brief writes states and transitions of lts through OutputWriter. Labels
+ * of transitions are interned: text of label is formatted once, when it is
+ * met first time, and every transition appends ready text or label number.
+ * Numbers of states and transitions are written to header, when lts is
+ * finished, so stream should be seekable file for aut and binary formats.
+ */
+class LtsWriter
+{
+public:
+/**
+ * @brief class constructor, writes beginning of lts
+ * @param stream - output stream, opened in binary mode
+ * @param format - format of lts
+ * @param layout - placement of variables in packed state
+ * @param sync - flag, indicates if every line is flushed at once
+ */
+    LtsWriter(std::ostream& stream, LtsFormat format, const StateLayout& layout, bool sync);
+
+/**
+ * @brief class destructor
+ */
+    ~LtsWriter();
+
+/**
+ * @brief prints new state
+ * @param id - id of state
+ * @param state - packed state
+ */
+    void Node(size_t id, const PackedState& state);
+
+/**
+ * @brief prints transition
+ * @param from - id of source state
+ * @param to - id of target state
+ * @param thread - name of thread, which does step
+ * @param label - text of step
+ * @param color - color of transition in dot format
+ */
+    void Edge(size_t from, size_t to, const char* thread, const char* label, const char* color)
+    {
+        uint32_t number = Label(thread, label, color);
+        ++m_edges;
+        if(m_format == LTS_BINARY)
+        {
+            // records are written as is, so format expects little-endian host
+            uint32_t record[3] = {uint32_t(from), number, uint32_t(to)};
+            m_writer->Buffer().append(reinterpret_cast<const char*>(record), sizeof(record));
+            m_writer->Commit();
+            return;
+        }
+        std::string& text = m_writer->Buffer();
+        if(m_format == LTS_AUT)
+        {
+            text += '(';
+            AppendNumber(text, from);
+            text += ',';
+            text += m_texts[number];
+            text += ',';
+            AppendNumber(text, to);
+            text += ')';
+        }
+        else
+        {
+            text += "    ";
+            AppendNumber(text, from);
+            text += " -> ";
+            AppendNumber(text, to);
+            text += m_texts[number];
+        }
+        m_writer->EndLine();
+    }
+
+/**
+ * @brief writes end of lts and numbers of states and transitions
+ */
+    void Finish();
+
+/**
+ * @brief number of printed states
+ */
+    uint64_t States() const
+    {
+        return m_states;
+    }
+
+/**
+ * @brief number of printed transitions
+ */
+    uint64_t Edges() const
+    {
+        return m_edges;
+    }
+private:
+/**
+ * @brief key of interned label: pointers to thread name and text of step
+ */
+    typedef std::pair<const char*, const char*> LabelKey;
+
+/**
+ * @brief entry of cache of label numbers
+ */
+    struct CachedLabel
+    {
+        const char* thread;
+        const char* label;
+        uint32_t number;
+    };
+
+/**
+ * @brief number of label, formats its text, when label is met first time
+ * @param thread - name of thread, which does step
+ * @param label - text of step
+ * @param color - color of transition in dot format
+ */
+    uint32_t Label(const char* thread, const char* label, const char* color)
+    {
+        // labels are few, so almost every label is found in cache
+        CachedLabel& cached = m_cache[(reinterpret_cast<uintptr_t>(label) >> 3) % LabelCacheSize];
+        if(cached.thread == thread && cached.label == label)
+            return cached.number;
+        std::map<LabelKey, uint32_t>::const_iterator found = m_numbers.find(LabelKey(thread, label));
+        cached.thread = thread;
+        cached.label = label;
+        cached.number = found != m_numbers.end() ? found->second : AddLabel(thread, label, color);
+        return cached.number;
+    }
+
+/**
+ * @brief interns label, which isn't met by its pointers yet
+ * @param thread - name of thread, which does step
+ * @param label - text of step
+ * @param color - color of transition in dot format
+ */
+    uint32_t AddLabel(const char* thread, const char* label, const char* color);
+
+/**
+ * @brief writes header of aut or binary format
+ * @param data - data to append
+ */
+    void AppendHeader(std::string& data) const;
+
+/**
+ * @brief output stream
+ */
+    std::ostream& m_stream;
+
+/**
+ * @brief format of lts
+ */
+    LtsFormat m_format;
+
+/**
+ * @brief placement of variables in packed state
+ */
+    StateLayout m_layout;
+
+/**
+ * @brief writer of stream
+ */
+    OutputWriter* m_writer;
+
+/**
+ * @brief numbers of labels, which were met last, by their pointers
+ */
+    CachedLabel m_cache[LabelCacheSize];
+
+/**
+ * @brief numbers of labels by their pointers
+ */
+    std::map<LabelKey, uint32_t> m_numbers;
+
+/**
+ * @brief numbers of labels by their names, equal labels with different
+ * pointers get one number
+ */
+    std::map<std::string, uint32_t> m_names;
+
+/**
+ * @brief names of labels "<thread>: <label>" by numbers
+ */
+    std::vector<std::string> m_labels;
+
+/**
+ * @brief formatted text of labels by numbers: quoted name for aut format,
+ * attributes of edge for dot format
+ */
+    std::vector<std::string> m_texts;
+
+/**
+ * @brief number of printed states
+ */
+    uint64_t m_states;
+
+/**
+ * @brief number of printed transitions
+ */
+    uint64_t m_edges;
+
+// Copy isn't allowed
+    LtsWriter(LtsWriter&);
+    LtsWriter& operator=(LtsWriter&);
+};
+
+#endif //LTS_WRITER_H
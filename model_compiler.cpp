@@ -0,0 +1,113 @@
+/******************************************************************************
+ * File: model_compiler.cpp
+ * Description: generation of C++ model of program, specialized at compile time.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "model_writer.h"
+#include "program.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+using namespace std;
+
+const char* Info = "Usage: <binary name> <program> [values of parameters]\n"
+                   "Writes C++ header with step functions of threads of program,\n"
+                   "specialized for its layout of packed state.\n"
+                   "Allowed flags:\n"
+                   "-name <struct>: name of generated struct (Model by default)\n"
+                   "-replicate <functions>: run several threads of function, for example\n"
+                   "    worker=4,f=2\n"
+                   "-file <out file>: redirect output to specified file\n\n"
+                   "Author: Valery Bitsoev. March 2013\n";
+
+/**
+ * @brief checks is string consist of only digits
+ * @param string - string to check
+ */
+bool isNumber(char * string)
+{
+    for(int i=0;string[i]!='\0';i++)
+        if(!isdigit(string[i]))
+            return false;
+    return true;
+}
+
+/**
+ * @brief checks is string integer: digits with optional minus before them
+ * @param string - string to check
+ */
+bool isInteger(char * string)
+{
+    if(string[0] == '-')
+        ++string;
+    return string[0] != '\0' && isNumber(string);
+}
+
+int main(int argc, char** argv)
+{
+    int i = 2;
+    bool bad_args = argc < 2;
+    char* filename = NULL;
+    const char* name = "Model";
+    vector<int> arguments;
+    const char* replicate = "";
+    map<string, size_t> replicas;
+    //parse argv
+    while(!bad_args && i < argc)
+    {
+        if(isInteger(argv[i]))
+        {
+            arguments.push_back(atoi(argv[i]));
+            ++i;
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-file") == 0)
+        {
+            filename = argv[i+1];
+            i+=2;
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-name") == 0)
+        {
+            name = argv[i+1];
+            i+=2;
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-replicate") == 0)
+        {
+            replicate = argv[i+1];
+            bad_args = !ParseReplicas(replicate, replicas);
+            i+=2;
+        }
+        else
+        {
+            bad_args = true;
+        }
+    }
+    if(bad_args)
+    {
+        // print info about program
+        cout<<Info<<endl;
+        return 1;
+    }
+
+    Program program;
+    if(!program.Load(argv[1], arguments, replicas))
+        return 1;
+    ofstream file;
+    if(filename)
+    {
+        file.open(filename);
+        if(!file)
+        {
+            cerr<<"Can't open file "<<filename<<endl;
+            return 1;
+        }
+    }
+    WriteModel(filename ? static_cast<ostream&>(file) : cout, program, name, argv[1], arguments, replicate);
+}
@@ -0,0 +1,211 @@
+/******************************************************************************
+ * File: model_writer.cpp
+ * Description: generation of C++ model of program, specialized at compile time.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "model_writer.h"
+#include <set>
+#include <sstream>
+#include <string>
+#include <ctype.h>
+using namespace std;
+
+/**
+ * @brief C++ operators of comparisons by their index in enum
+ */
+const char* const ComparisonOperators[] = {"", "==", "!=", "<", ">", "<=", ">="};
+
+/**
+ * @brief hexadecimal literal of 64-bit number
+ * @param value - number
+ */
+static string Hex(uint64_t value)
+{
+    ostringstream text;
+    text<<"0x"<<hex<<value<<"ull";
+    return text.str();
+}
+
+/**
+ * @brief int literal, negative one in parentheses
+ * @param value - number
+ */
+static string Int(int value)
+{
+    ostringstream text;
+    if(value < 0)
+        text<<"("<<value<<")";
+    else
+        text<<value;
+    return text.str();
+}
+
+/**
+ * @brief expression of raw bits of field
+ * @param layout - placement of variables in packed state
+ * @param field - index of field
+ */
+static string Raw(const StateLayout& layout, size_t field)
+{
+    ostringstream text;
+    text<<"((w["<<layout.Word(field)<<"] >> "<<layout.Shift(field)<<") & "<<Hex(layout.RawMask(field))<<")";
+    return text.str();
+}
+
+/**
+ * @brief expression of value of operand, variable is read to local r<field>
+ * @param layout - placement of variables in packed state
+ * @param operand - operand
+ */
+static string Value(const StateLayout& layout, const Operand& operand)
+{
+    if(operand.field == NoField)
+        return Int(operand.value);
+    ostringstream text;
+    text<<"(int(r"<<operand.field<<" >> 1) + "<<Int(layout.Min(operand.field))<<")";
+    return text.str();
+}
+
+/**
+ * @brief writes assignment of raw bits to field
+ * @param stream - output stream
+ * @param layout - placement of variables in packed state
+ * @param field - index of field
+ * @param raw - expression of raw bits
+ * @param indent - indentation of line
+ */
+static void WriteStore(ostream& stream, const StateLayout& layout, size_t field, const string& raw, const string& indent)
+{
+    size_t word = layout.Word(field);
+    uint64_t clear = ~(layout.RawMask(field) << layout.Shift(field));
+    stream<<indent<<"w["<<word<<"] = (w["<<word<<"] & "<<Hex(clear)<<") | ("<<raw<<" << "<<layout.Shift(field)<<");\n";
+}
+
+/**
+ * @brief writes transitions of one program counter
+ * @param stream - output stream
+ * @param program - compiled program
+ * @param thread - number of thread
+ * @param pc - value of program counter
+ */
+static void WriteCase(ostream& stream, const Program& program, size_t thread, unsigned int pc)
+{
+    const StateLayout& layout = program.Layout();
+    size_t first = program.First(thread, pc);
+    size_t last = program.First(thread, pc + 1);
+    if(first == last)
+        return;
+    stream<<"            case "<<pc<<":\n            {\n";
+    // fields of guards are read once for all branches
+    set<size_t> fields;
+    for(size_t i = first; i < last; ++i)
+    {
+        const Transition& transition = program.GetTransition(i);
+        if(transition.comparison == OP_TRUE)
+            continue;
+        if(transition.left.field != NoField)
+            fields.insert(transition.left.field);
+        if(transition.right.field != NoField)
+            fields.insert(transition.right.field);
+    }
+    for(set<size_t>::const_iterator field = fields.begin(); field != fields.end(); ++field)
+        stream<<"                const uint64_t r"<<*field<<" = "<<Raw(layout, *field)<<";\n";
+    for(size_t i = first; i < last; ++i)
+    {
+        const Transition& transition = program.GetTransition(i);
+        stream<<"                // "<<transition.label<<"\n";
+        string indent = "                ";
+        if(transition.comparison != OP_TRUE)
+        {
+            // comparison with uninitialized variable blocks thread
+            stream<<indent<<"if(";
+            if(transition.left.field != NoField)
+                stream<<"(r"<<transition.left.field<<" & 1) && ";
+            if(transition.right.field != NoField && transition.right.field != transition.left.field)
+                stream<<"(r"<<transition.right.field<<" & 1) && ";
+            stream<<Value(layout, transition.left)<<" "<<ComparisonOperators[transition.comparison]<<" "
+                  <<Value(layout, transition.right)<<")\n"<<indent<<"{\n";
+            indent += "    ";
+        }
+        if(transition.target != NoField)
+        {
+            const Operand& source = transition.source;
+            if(source.field == NoField)
+            {
+                uint64_t raw = (uint64_t(int64_t(source.value) - layout.Min(transition.target)) << 1) | 1;
+                WriteStore(stream, layout, transition.target, Hex(raw), indent);
+            }
+            else
+            {
+                // raw bits of initialized source are moved to range of target
+                uint64_t offset = uint64_t(int64_t(layout.Min(source.field)) - layout.Min(transition.target)) << 1;
+                stream<<indent<<"const uint64_t s = "<<Raw(layout, source.field)<<";\n";
+                WriteStore(stream, layout, transition.target, "((s & 1) ? s + " + Hex(offset) + " : 0)", indent);
+            }
+        }
+        WriteStore(stream, layout, program.CounterField(thread), Hex(transition.next), indent);
+        stream<<indent<<"return true;\n";
+        if(transition.comparison != OP_TRUE)
+            stream<<"                }\n";
+    }
+    if(program.GetTransition(last - 1).comparison != OP_TRUE)
+        stream<<"                return false;\n";
+    stream<<"            }\n";
+}
+
+/**
+ * @brief writes header with model of compiled program
+ * @param stream - output stream
+ * @param program - compiled program
+ * @param name - name of generated struct, valid C++ identifier
+ * @param source - file of program
+ * @param arguments - values of parameters, which program is compiled with
+ * @param replicas - list of replicated functions, which program is compiled with
+ */
+void WriteModel(ostream& stream, const Program& program, const char* name, const char* source,
+                const vector<int>& arguments, const char* replicas)
+{
+    const StateLayout& layout = program.Layout();
+    string guard;
+    for(const char* c = name; *c; ++c)
+        guard += char(toupper(*c));
+    guard += "_H";
+    stream<<"/* Model of "<<source<<", generated by model_compiler, don't edit */\n"
+          <<"#ifndef "<<guard<<"\n#define "<<guard<<"\n\n"
+          <<"#include <vector>\n#include <stddef.h>\n#include <stdint.h>\n#include \"state_codec.h\"\n\n"
+          <<"/**\n * @brief threads of "<<source<<" with step functions, specialized for layout:\n";
+    for(size_t i = 0; i < layout.Fields(); ++i)
+        stream<<" * "<<layout.Name(i)<<" - word "<<layout.Word(i)<<", shift "<<layout.Shift(i)<<"\n";
+    stream<<" */\nstruct "<<name<<"\n{\n"
+          <<"    static const char* Source()\n    {\n        return \""<<source<<"\";\n    }\n\n"
+          <<"    static std::vector<int> Arguments()\n    {\n        std::vector<int> arguments;\n";
+    for(size_t i = 0; i < arguments.size(); ++i)
+        stream<<"        arguments.push_back("<<arguments[i]<<");\n";
+    stream<<"        return arguments;\n    }\n\n"
+          <<"    static const char* Replicas()\n    {\n        return \""<<replicas<<"\";\n    }\n\n"
+          <<"    static size_t Threads()\n    {\n        return "<<program.Threads()<<";\n    }\n\n";
+    PackedState initial;
+    program.Initial(initial);
+    stream<<"    static void Initial(PackedState& state)\n    {\n";
+    for(size_t i = 0; i < MaxStateWords; ++i)
+        stream<<"        state.words["<<i<<"] = "<<Hex(initial.words[i])<<";\n";
+    stream<<"    }\n\n"
+          <<"    static bool Step(PackedState& state, size_t thread)\n    {\n        switch(thread)\n        {\n";
+    for(size_t i = 0; i < program.Threads(); ++i)
+        stream<<"            case "<<i<<":\n                return Step"<<i<<"(state.words);\n";
+    stream<<"            default:\n                return false;\n        }\n    }\n";
+    for(size_t i = 0; i < program.Threads(); ++i)
+    {
+        size_t counter = program.CounterField(i);
+        stream<<"\n    // thread "<<program.ThreadName(i)<<"\n"
+              <<"    static bool Step"<<i<<"(uint64_t* w)\n    {\n"
+              <<"        switch("<<Raw(layout, counter)<<")\n        {\n";
+        for(unsigned int pc = 0; pc < program.End(i); ++pc)
+            WriteCase(stream, program, i, pc);
+        stream<<"            default:\n                return false;\n        }\n    }\n";
+    }
+    stream<<"};\n\n#endif //"<<guard<<"\n";
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * File: model_writer.h
+ * Description: generation of C++ model of program, specialized at compile time.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef MODEL_WRITER_H
+#define MODEL_WRITER_H
+
+#include <ostream>
+#include <vector>
+#include "program.h"
+
+/*
+ * Generated header defines struct with static methods, which have same
+ * meaning as methods of Program:
+ *     static const char* Source()          file of program
+ *     static std::vector<int> Arguments()  values of parameters
+ *     static const char* Replicas()        replicated functions, see ParseReplicas
+ *     static size_t Threads()
+ *     static void Initial(PackedState& state)
+ *     static bool Step(PackedState& state, size_t thread)
+ * Step of every thread is switch by program counter, every transition is
+ * straight-line code with constant shifts and masks of fields, so there
+ * are no tables and no calls of StateLayout.
+ */
+
+/**
+ * @brief writes header with model of compiled program
+ * @param stream - output stream
+ * @param program - compiled program
+ * @param name - name of generated struct, valid C++ identifier
+ * @param source - file of program
+ * @param arguments - values of parameters, which program is compiled with
+ * @param replicas - list of replicated functions, which program is compiled with
+ */
+void WriteModel(std::ostream& stream, const Program& program, const char* name, const char* source,
+                const std::vector<int>& arguments, const char* replicas);
+
+#endif //MODEL_WRITER_H
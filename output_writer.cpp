@@ -0,0 +1,148 @@
+/******************************************************************************
+ * File: output_writer.cpp
+ * Description: buffered output of generated states by background thread.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "output_writer.h"
+using namespace std;
+
+/**
+ * @brief size of buffer, which is given to background thread
+ */
+const size_t BlockSize = 1 << 20;
+
+/**
+ * @brief appends decimal number to text
+ * @param text - text to append
+ * @param value - number
+ */
+void AppendNumber(string& text, int64_t value)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    uint64_t rest = value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+    do
+    {
+        *--begin = char('0' + rest % 10);
+        rest /= 10;
+    }
+    while(rest != 0);
+    if(value < 0)
+        *--begin = '-';
+    text.append(begin, end);
+}
+
+/**
+ * @brief class constructor
+ * @param stream - output stream
+ * @param sync - flag, indicates if every line is flushed at once
+ */
+OutputWriter::OutputWriter(ostream& stream, bool sync): m_stream(stream)
+                                                      , m_sync(sync)
+                                                      , m_block_size(BlockSize)
+                                                      , m_current()
+                                                      , m_pending()
+                                                      , m_busy(false)
+                                                      , m_stop(false)
+                                                      , m_mutex()
+                                                      , m_changed()
+                                                      , m_thread()
+{
+    if(!m_sync)
+    {
+        m_current.reserve(m_block_size * 2);
+        m_pending.reserve(m_block_size * 2);
+        m_thread = thread(&OutputWriter::Run, this);
+    }
+}
+
+/**
+ * @brief class destructor, writes remaining text and stops background thread
+ */
+OutputWriter::~OutputWriter()
+{
+    Finish();
+    if(m_thread.joinable())
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+}
+
+/**
+ * @brief adds text of complete lines
+ * @param text - text to add
+ */
+void OutputWriter::Write(const string& text)
+{
+    m_current += text;
+    if(m_sync || m_current.size() >= m_block_size)
+        Hand();
+}
+
+/**
+ * @brief writes all added text to stream and flushes it
+ */
+void OutputWriter::Finish()
+{
+    if(!m_current.empty())
+        Hand();
+    if(m_sync)
+        return;
+    unique_lock<mutex> lock(m_mutex);
+    while(m_busy)
+        m_changed.wait(lock);
+    m_stream.flush();
+}
+
+/**
+ * @brief gives current buffer for writing
+ */
+void OutputWriter::Hand()
+{
+    if(m_sync)
+    {
+        m_stream.write(m_current.data(), m_current.size());
+        m_stream.flush();
+        m_current.clear();
+        return;
+    }
+    unique_lock<mutex> lock(m_mutex);
+    // previous buffer should be written before it is filled again
+    while(m_busy)
+        m_changed.wait(lock);
+    m_current.swap(m_pending);
+    m_busy = true;
+    lock.unlock();
+    m_changed.notify_all();
+    m_current.clear();
+}
+
+/**
+ * @brief loop of background thread
+ */
+void OutputWriter::Run()
+{
+    unique_lock<mutex> lock(m_mutex);
+    while(true)
+    {
+        while(!m_busy && !m_stop)
+            m_changed.wait(lock);
+        if(!m_busy)
+            return;
+        // producer doesn't touch m_pending, while it is busy
+        lock.unlock();
+        m_stream.write(m_pending.data(), m_pending.size());
+        lock.lock();
+        m_busy = false;
+        m_changed.notify_all();
+    }
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * File: output_writer.h
+ * Description: buffered output of generated states by background thread.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <stdint.h>
+
+/**
+ * @brief appends decimal number to text
+ * @param text - text to append
+ * @param value - number
+ */
+void AppendNumber(std::string& text, int64_t value);
+
+/**
+ * @brief writes text to stream by big blocks. Lines are formatted in
+ * current buffer, full buffer is given to background thread, which writes
+ * it while next buffer is filled, so exploration doesn't wait for system
+ * calls. In synchronous mode every line is written and flushed at once.
+ * Producers aren't synchronized, only one thread should add text at a time.
+ */
+class OutputWriter
+{
+public:
+/**
+ * @brief class constructor
+ * @param stream - output stream
+ * @param sync - flag, indicates if every line is flushed at once
+ */
+    OutputWriter(std::ostream& stream, bool sync);
+
+/**
+ * @brief class destructor, writes remaining text and stops background thread
+ */
+    ~OutputWriter();
+
+/**
+ * @brief buffer, where text of current line is appended
+ */
+    std::string& Buffer()
+    {
+        return m_current;
+    }
+
+/**
+ * @brief ends line in buffer
+ */
+    void EndLine()
+    {
+        m_current += '\n';
+        Commit();
+    }
+
+/**
+ * @brief marks end of complete data in buffer, so it can be written
+ */
+    void Commit()
+    {
+        if(m_sync || m_current.size() >= m_block_size)
+            Hand();
+    }
+
+/**
+ * @brief adds text of complete lines
+ * @param text - text to add
+ */
+    void Write(const std::string& text);
+
+/**
+ * @brief writes all added text to stream and flushes it
+ */
+    void Finish();
+private:
+/**
+ * @brief gives current buffer for writing
+ */
+    void Hand();
+
+/**
+ * @brief loop of background thread
+ */
+    void Run();
+
+/**
+ * @brief output stream
+ */
+    std::ostream& m_stream;
+
+/**
+ * @brief flag, indicates if every line is flushed at once
+ */
+    bool m_sync;
+
+/**
+ * @brief size of buffer, which is given for writing
+ */
+    size_t m_block_size;
+
+/**
+ * @brief buffer, filled by producer
+ */
+    std::string m_current;
+
+/**
+ * @brief buffer, written by background thread
+ */
+    std::string m_pending;
+
+/**
+ * @brief flag, indicates if m_pending is given for writing
+ */
+    bool m_busy;
+
+/**
+ * @brief flag, indicates if background thread should stop
+ */
+    bool m_stop;
+
+/**
+ * @brief guard of m_busy and m_stop
+ */
+    std::mutex m_mutex;
+
+/**
+ * @brief signals change of m_busy or m_stop
+ */
+    std::condition_variable m_changed;
+
+/**
+ * @brief background thread
+ */
+    std::thread m_thread;
+
+// Copy isn't allowed
+    OutputWriter(OutputWriter&);
+    OutputWriter& operator=(OutputWriter&);
+};
+
+#endif //OUTPUT_WRITER_H
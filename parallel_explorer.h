@@ -0,0 +1,181 @@
+/******************************************************************************
+ * File: parallel_explorer.h
+ * Description: exploration of states by several threads with work stealing.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef PARALLEL_EXPLORER_H
+#define PARALLEL_EXPLORER_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * @brief worklist of one thread. Owner takes items from the back,
+ * other threads steal items from the front.
+ */
+template <class T>
+class WorkDeque
+{
+public:
+/**
+ * @brief adds item to the back
+ * @param item - item to add
+ */
+    void Push(const T& item)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.push_back(item);
+    }
+
+/**
+ * @brief takes item from the back
+ * @param item - place for taken item
+ * @return false if deque is empty
+ */
+    bool Pop(T& item)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_items.empty())
+            return false;
+        item = m_items.back();
+        m_items.pop_back();
+        return true;
+    }
+
+/**
+ * @brief moves half of items from the front to other deque
+ * @param thief - deque of stealing thread
+ * @return false if deque is empty
+ */
+    bool Steal(WorkDeque& thief)
+    {
+        std::vector<T> stolen;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t number = (m_items.size() + 1) / 2;
+            stolen.assign(m_items.begin(), m_items.begin() + number);
+            m_items.erase(m_items.begin(), m_items.begin() + number);
+        }
+        if(stolen.empty())
+            return false;
+        std::lock_guard<std::mutex> lock(thief.m_mutex);
+        thief.m_items.insert(thief.m_items.end(), stolen.begin(), stolen.end());
+        return true;
+    }
+private:
+/**
+ * @brief guard of items
+ */
+    std::mutex m_mutex;
+
+/**
+ * @brief stored items
+ */
+    std::deque<T> m_items;
+};
+
+/**
+ * @brief explores states by several threads.
+ * Model should have method
+ * void Expand(size_t worker, const Item& item, std::vector<Item>& next),
+ * which is called once for every taken item from any thread, checks
+ * and stores item and appends its successors to next.
+ */
+template <class Item, class Model>
+class ParallelExplorer
+{
+public:
+/**
+ * @brief class constructor
+ * @param model - model, which expands items
+ * @param threads - number of threads
+ */
+    ParallelExplorer(Model& model, size_t threads):m_model(model)
+                                                  ,m_deques(threads > 0 ? threads : 1)
+                                                  ,m_pending(0){}
+
+/**
+ * @brief explores all items after initial one, returns when all threads finish
+ * @param initial - initial item
+ */
+    void Run(const Item& initial)
+    {
+        m_pending.store(1);
+        m_deques[0].Push(initial);
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < m_deques.size(); ++i)
+            threads.push_back(std::thread(&ParallelExplorer::Work, this, i));
+        Work(0);
+        for(size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+    }
+private:
+/**
+ * @brief loop of one thread
+ * @param worker - number of thread
+ */
+    void Work(size_t worker)
+    {
+        Item item;
+        std::vector<Item> next;
+        while(true)
+        {
+            if(!Take(worker, item))
+            {
+                // all items are expanded, when there are no pending ones
+                if(m_pending.load() == 0)
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+            next.clear();
+            m_model.Expand(worker, item, next);
+            // successors become pending before their parent is finished
+            m_pending.fetch_add(next.size());
+            for(size_t i = next.size(); i > 0; --i)
+                m_deques[worker].Push(next[i - 1]);
+            m_pending.fetch_sub(1);
+        }
+    }
+
+/**
+ * @brief takes item from own deque or steals it from other threads
+ * @param worker - number of thread
+ * @param item - place for taken item
+ */
+    bool Take(size_t worker, Item& item)
+    {
+        if(m_deques[worker].Pop(item))
+            return true;
+        for(size_t i = 1; i < m_deques.size(); ++i)
+        {
+            size_t victim = (worker + i) % m_deques.size();
+            if(m_deques[victim].Steal(m_deques[worker]))
+                return m_deques[worker].Pop(item);
+        }
+        return false;
+    }
+
+/**
+ * @brief model, which expands items
+ */
+    Model& m_model;
+
+/**
+ * @brief worklists of threads
+ */
+    std::vector<WorkDeque<Item> > m_deques;
+
+/**
+ * @brief number of items, which are stored in deques or being expanded
+ */
+    std::atomic<size_t> m_pending;
+};
+
+#endif //PARALLEL_EXPLORER_H
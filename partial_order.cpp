@@ -0,0 +1,49 @@
+/******************************************************************************
+ * File: partial_order.cpp
+ * Description: access of statements to variables for partial-order reduction.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "partial_order.h"
+using namespace std;
+
+/**
+ * @brief class constructor
+ * @param statements - statements of thread
+ * @param number - number of statements
+ * @param end - value of program counter after last statement
+ */
+ThreadAccess::ThreadAccess(const Statement* statements, size_t number, unsigned int end): m_current()
+                                                                                        , m_future()
+{
+    Access none = {0, 0};
+    m_current.assign(end + 1, none);
+    m_future.assign(end + 1, none);
+    // several statements of one program counter are branches of condition
+    for(size_t i = 0; i < number; ++i)
+    {
+        m_current[statements[i].pc].reads |= statements[i].access.reads;
+        m_current[statements[i].pc].writes |= statements[i].access.writes;
+    }
+    // future access is closed over transitions until nothing changes,
+    // so loops of thread are taken into account too
+    m_future = m_current;
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        for(size_t i = 0; i < number; ++i)
+        {
+            Access& future = m_future[statements[i].pc];
+            const Access& next = m_future[statements[i].next];
+            Access joined = {future.reads | next.reads, future.writes | next.writes};
+            if(joined.reads != future.reads || joined.writes != future.writes)
+            {
+                future = joined;
+                changed = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/******************************************************************************
+ * File: partial_order.h
+ * Description: access of statements to variables for partial-order reduction.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef PARTIAL_ORDER_H
+#define PARTIAL_ORDER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief variables, read and written by statements, one bit per field of
+ * packed state. Program counters aren't included, they are thread-local.
+ */
+struct Access
+{
+    uint64_t reads;
+    uint64_t writes;
+};
+
+/**
+ * @brief one statement of thread
+ */
+struct Statement
+{
+/**
+ * @brief value of program counter before statement
+ */
+    unsigned int pc;
+/**
+ * @brief value of program counter after statement
+ */
+    unsigned int next;
+/**
+ * @brief variables, read and written by statement
+ */
+    Access access;
+};
+
+/**
+ * @brief access of thread statements, indexed by program counter
+ */
+class ThreadAccess
+{
+public:
+/**
+ * @brief class constructor
+ * @param statements - statements of thread
+ * @param number - number of statements
+ * @param end - value of program counter after last statement
+ */
+    ThreadAccess(const Statement* statements, size_t number, unsigned int end);
+
+/**
+ * @brief access of statement at program counter
+ * @param pc - value of program counter
+ */
+    const Access& Current(unsigned int pc) const
+    {
+        return m_current[pc];
+    }
+
+/**
+ * @brief access of all statements, which can be executed from program counter
+ * @param pc - value of program counter
+ */
+    const Access& Future(unsigned int pc) const
+    {
+        return m_future[pc];
+    }
+private:
+/**
+ * @brief access of statements
+ */
+    std::vector<Access> m_current;
+
+/**
+ * @brief access of statements, reachable from program counter
+ */
+    std::vector<Access> m_future;
+};
+
+/**
+ * @brief checks if statement commutes with every statement, other thread
+ * can still execute: they don't write variables, used by each other
+ * @param statement - access of statement
+ * @param other - future access of other thread
+ */
+inline bool Independent(const Access& statement, const Access& other)
+{
+    return (statement.writes & (other.reads | other.writes)) == 0
+        && (statement.reads & other.writes) == 0;
+}
+
+#endif //PARTIAL_ORDER_H
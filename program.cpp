@@ -0,0 +1,1970 @@
+/******************************************************************************
+ * File: program.cpp
+ * Description: C program of several threads, compiled to table of transitions.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "program.h"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+using namespace std;
+
+/**
+ * @brief maximal number of fields, which have bits in Access
+ */
+const size_t MaxAccessFields = 64;
+
+/**
+ * @brief kind of token of program text
+ */
+enum TokenKind
+{
+    TOKEN_END,
+    TOKEN_NAME,
+    TOKEN_NUMBER,
+    TOKEN_SYMBOL
+};
+
+/**
+ * @brief token of program text
+ */
+struct Token
+{
+    TokenKind kind;
+    string text;
+    int line;
+};
+
+/**
+ * @brief kind of statement
+ */
+enum StatementKind
+{
+    STMT_DECLARATION,
+    STMT_ASSIGNMENT,
+    STMT_IF,
+    STMT_WHILE,
+    STMT_BREAK
+};
+
+/**
+ * @brief condition of if or while, text is like "y>2"
+ */
+struct Condition
+{
+    Comparison comparison;
+    Operand left;
+    Operand right;
+    string text;
+};
+
+/**
+ * @brief parsed statement, operands refer to variables by their numbers
+ */
+struct Node
+{
+    StatementKind kind;
+    unsigned int pc;
+    int line;
+    Condition condition;
+    size_t target;
+    Operand source;
+    string text;
+/**
+ * @brief statements of then branch or loop body
+ */
+    vector<size_t> body;
+/**
+ * @brief statements of else branch
+ */
+    vector<size_t> other;
+};
+
+/**
+ * @brief global or local variable of program
+ */
+struct Variable
+{
+    string name;
+    bool global;
+    size_t thread;
+    bool initialized;
+    int initial;
+    bool has_range;
+    int min;
+    int max;
+/**
+ * @brief flag, indicates if variable is symbolic parameter, which gets two
+ * fields: bounds of its interval
+ */
+    bool parameter;
+};
+
+/**
+ * @brief values, which variable can have, for analysis before exploration
+ */
+struct ValueSet
+{
+/**
+ * @brief flag, indicates if variable can be uninitialized
+ */
+    bool uninit;
+/**
+ * @brief flag, indicates if variable can have any value of its range
+ */
+    bool any;
+/**
+ * @brief sorted values
+ */
+    vector<int> values;
+};
+
+/**
+ * @brief parsed function
+ */
+struct Function
+{
+    string name;
+    vector<size_t> body;
+    unsigned int end;
+/**
+ * @brief parameters and their values
+ */
+    vector<pair<string, int> > parameters;
+/**
+ * @brief local variables by names
+ */
+    vector<pair<string, size_t> > locals;
+};
+
+/**
+ * @brief parses program text and compiles it to transitions of Program.
+ * First error stops parsing, every parse method returns at once after it.
+ */
+class ProgramCompiler
+{
+public:
+/**
+ * @brief class constructor
+ * @param filename - name of file, used in errors
+ * @param arguments - values of parameters of all functions in order of text
+ * @param replicas - numbers of threads of functions, 1 by default
+ * @param symbolic - range of symbolic parameters, NULL if arguments are values
+ */
+    ProgramCompiler(const char* filename, const vector<int>& arguments, const map<string, size_t>& replicas,
+                    const ParameterRange* symbolic):
+                                                                         m_filename(filename)
+                                                                       , m_arguments(arguments)
+                                                                       , m_replicas(replicas)
+                                                                       , m_symbolic(symbolic)
+                                                                       , m_used_arguments(0)
+                                                                       , m_tokens()
+                                                                       , m_position(0)
+                                                                       , m_failed(false)
+                                                                       , m_nodes()
+                                                                       , m_variables()
+                                                                       , m_functions()
+                                                                       , m_assignments()
+                                                                       , m_pc(0)
+    {
+    }
+
+/**
+ * @brief parses text and fills program
+ * @param text - program text
+ * @param program - empty program
+ * @return false if program isn't accepted, error is printed
+ */
+    bool Compile(const string& text, Program& program);
+private:
+    bool Tokenize(const string& text);
+    void ParseProgram();
+    void ParseGlobals();
+    void ParseFunction();
+    void ParseStatement(vector<size_t>& list, bool in_loop);
+    void ParseDeclaration(vector<size_t>& list);
+    void ParseAssignment(vector<size_t>& list);
+    void ParseCondition(Condition& condition);
+    void ParseOperand(Operand& operand, string& text);
+    bool ParseNumber(int& value);
+    bool Find(const string& name, Operand& operand) const;
+    size_t AddNode(StatementKind kind);
+    void ComputeRanges();
+    ValueSet Values(const Operand& operand, const vector<ValueSet>& locals, const vector<ValueSet>& globals) const;
+    bool Post(const Transition& transition, const vector<ValueSet>& globals, vector<ValueSet>& state) const;
+    size_t Analyze(vector<vector<Transition> >& code);
+    vector<vector<bool> > Liveness(const vector<Transition>& transitions, size_t function) const;
+    void Emit(const vector<size_t>& list, unsigned int cont, unsigned int exit, vector<Transition>& transitions,
+              deque<string>& labels) const;
+    void AddTransition(const Condition* condition, bool negate, const Node& node, unsigned int next,
+                       const string& label, vector<Transition>& transitions, deque<string>& labels) const;
+    bool Fail(const string& message, int line);
+    bool Fail(const string& message)
+    {
+        return Fail(message, m_tokens[m_position].line);
+    }
+    const Token& Peek(size_t ahead = 0) const
+    {
+        size_t index = min(m_position + ahead, m_tokens.size() - 1);
+        return m_tokens[index];
+    }
+    bool Is(const char* text, size_t ahead = 0) const
+    {
+        const Token& token = Peek(ahead);
+        return token.kind != TOKEN_END && token.kind != TOKEN_NUMBER && token.text == text;
+    }
+    bool Accept(const char* text)
+    {
+        if(m_failed || !Is(text))
+            return false;
+        ++m_position;
+        return true;
+    }
+    bool Expect(const char* text)
+    {
+        if(Accept(text))
+            return true;
+        return Fail(string("expected '") + text + "'");
+    }
+
+    const char* m_filename;
+    const vector<int>& m_arguments;
+    const map<string, size_t>& m_replicas;
+    const ParameterRange* m_symbolic;
+    size_t m_used_arguments;
+    vector<Token> m_tokens;
+    size_t m_position;
+    bool m_failed;
+    vector<Node> m_nodes;
+    vector<Variable> m_variables;
+    vector<Function> m_functions;
+/**
+ * @brief number of assigned variable and assigned operand
+ */
+    vector<pair<size_t, Operand> > m_assignments;
+/**
+ * @brief next value of program counter of parsed function
+ */
+    unsigned int m_pc;
+};
+
+/**
+ * @brief prints first error
+ * @param message - text of error
+ * @param line - line of program text
+ * @return false
+ */
+bool ProgramCompiler::Fail(const string& message, int line)
+{
+    if(!m_failed)
+        cerr<<m_filename<<":"<<line<<": "<<message<<endl;
+    m_failed = true;
+    return false;
+}
+
+/**
+ * @brief splits text to tokens, comments are skipped
+ * @param text - program text
+ * @return false if text has unknown character
+ */
+bool ProgramCompiler::Tokenize(const string& text)
+{
+    int line = 1;
+    size_t i = 0;
+    while(i < text.size())
+    {
+        char c = text[i];
+        if(c == '\n')
+        {
+            ++line;
+            ++i;
+            continue;
+        }
+        if(isspace(c))
+        {
+            ++i;
+            continue;
+        }
+        if(text.compare(i, 2, "//") == 0)
+        {
+            while(i < text.size() && text[i] != '\n')
+                ++i;
+            continue;
+        }
+        if(text.compare(i, 2, "/*") == 0)
+        {
+            size_t end = text.find("*/", i + 2);
+            if(end == string::npos)
+                return Fail("comment isn't closed", line);
+            line += count(text.begin() + i, text.begin() + end, '\n');
+            i = end + 2;
+            continue;
+        }
+        Token token;
+        token.line = line;
+        size_t begin = i;
+        if(isalpha(c) || c == '_')
+        {
+            token.kind = TOKEN_NAME;
+            while(i < text.size() && (isalnum(text[i]) || text[i] == '_'))
+                ++i;
+        }
+        else if(isdigit(c))
+        {
+            token.kind = TOKEN_NUMBER;
+            while(i < text.size() && isdigit(text[i]))
+                ++i;
+        }
+        else if(text.compare(i, 2, "==") == 0 || text.compare(i, 2, "!=") == 0
+             || text.compare(i, 2, "<=") == 0 || text.compare(i, 2, ">=") == 0)
+        {
+            token.kind = TOKEN_SYMBOL;
+            i += 2;
+        }
+        else if(string("{}();,=<>-").find(c) != string::npos)
+        {
+            token.kind = TOKEN_SYMBOL;
+            ++i;
+        }
+        else
+        {
+            return Fail(string("unexpected character '") + c + "'", line);
+        }
+        token.text = text.substr(begin, i - begin);
+        m_tokens.push_back(token);
+    }
+    Token end;
+    end.kind = TOKEN_END;
+    end.text = "end of file";
+    end.line = line;
+    m_tokens.push_back(end);
+    return true;
+}
+
+/**
+ * @brief parses global variables and functions until end of text
+ */
+void ProgramCompiler::ParseProgram()
+{
+    while(!m_failed && Peek().kind != TOKEN_END)
+    {
+        if(Is("void") || (Is("int") && Is("(", 2)))
+            ParseFunction();
+        else if(Is("int"))
+            ParseGlobals();
+        else
+            Fail("expected global variable or function, found '" + Peek().text + "'");
+    }
+}
+
+/**
+ * @brief parses declaration of global variables with optional initializers
+ */
+void ProgramCompiler::ParseGlobals()
+{
+    Expect("int");
+    do
+    {
+        const Token& name = Peek();
+        if(m_failed || name.kind != TOKEN_NAME)
+        {
+            Fail("expected name of variable");
+            return;
+        }
+        for(size_t i = 0; i < m_variables.size(); ++i)
+            if(m_variables[i].global && m_variables[i].name == name.text)
+                Fail("variable '" + name.text + "' is already declared");
+        Variable variable = {name.text, true, 0, false, 0, false, 0, 0, false};
+        m_variables.push_back(variable);
+        ++m_position;
+        if(Accept("="))
+        {
+            int value;
+            if(!ParseNumber(value))
+                return;
+            Operand source = {NoField, value};
+            m_assignments.push_back(make_pair(m_variables.size() - 1, source));
+            m_variables.back().initialized = true;
+            m_variables.back().initial = value;
+        }
+    }
+    while(Accept(","));
+    Expect(";");
+}
+
+/**
+ * @brief parses function, which becomes thread
+ */
+void ProgramCompiler::ParseFunction()
+{
+    if(!Accept("void"))
+        Expect("int");
+    const Token& name = Peek();
+    if(m_failed || name.kind != TOKEN_NAME)
+    {
+        Fail("expected name of function");
+        return;
+    }
+    for(size_t i = 0; i < m_functions.size(); ++i)
+        if(m_functions[i].name == name.text)
+            Fail("function '" + name.text + "' is already defined");
+    m_functions.push_back(Function());
+    m_functions.back().name = name.text;
+    ++m_position;
+    Expect("(");
+    if(!Accept(")") && !(Is("void") && Is(")", 1) && Accept("void") && Accept(")")))
+    {
+        do
+        {
+            Expect("int");
+            const Token& parameter = Peek();
+            if(m_failed || parameter.kind != TOKEN_NAME)
+            {
+                Fail("expected name of parameter");
+                return;
+            }
+            int value = m_used_arguments < m_arguments.size() ? m_arguments[m_used_arguments] : 0;
+            ++m_used_arguments;
+            m_functions.back().parameters.push_back(make_pair(parameter.text, value));
+            if(m_symbolic)
+            {
+                // symbolic parameter is local variable with interval of values
+                Function& function = m_functions.back();
+                Variable variable = {function.name + "." + parameter.text, false, m_functions.size() - 1,
+                                     true, value, true, m_symbolic->min, m_symbolic->max, true};
+                function.locals.push_back(make_pair(parameter.text, m_variables.size()));
+                m_variables.push_back(variable);
+            }
+            ++m_position;
+        }
+        while(Accept(","));
+        Expect(")");
+    }
+    m_pc = 0;
+    Expect("{");
+    vector<size_t> body;
+    while(!m_failed && !Is("}") && Peek().kind != TOKEN_END)
+        ParseStatement(body, false);
+    Expect("}");
+    m_functions.back().body = body;
+    m_functions.back().end = m_pc;
+}
+
+/**
+ * @brief parses statement and appends it to list, block is appended
+ * statement by statement
+ * @param list - statements of enclosing block
+ * @param in_loop - flag, indicates if statement is inside while
+ */
+void ProgramCompiler::ParseStatement(vector<size_t>& list, bool in_loop)
+{
+    if(m_failed)
+        return;
+    if(Accept("{"))
+    {
+        while(!m_failed && !Is("}") && Peek().kind != TOKEN_END)
+            ParseStatement(list, in_loop);
+        Expect("}");
+    }
+    else if(Accept(";"))
+    {
+        // empty statement has no program counter
+    }
+    else if(Is("int"))
+    {
+        ParseDeclaration(list);
+    }
+    else if(Is("if") || Is("while"))
+    {
+        bool loop = Is("while");
+        ++m_position;
+        size_t node = AddNode(loop ? STMT_WHILE : STMT_IF);
+        list.push_back(node);
+        Expect("(");
+        Condition condition;
+        ParseCondition(condition);
+        Expect(")");
+        m_nodes[node].condition = condition;
+        vector<size_t> body;
+        ParseStatement(body, in_loop || loop);
+        m_nodes[node].body = body;
+        if(!loop && Accept("else"))
+        {
+            vector<size_t> other;
+            ParseStatement(other, in_loop);
+            m_nodes[node].other = other;
+        }
+    }
+    else if(Is("break"))
+    {
+        if(!in_loop)
+        {
+            Fail("break outside of while");
+            return;
+        }
+        ++m_position;
+        list.push_back(AddNode(STMT_BREAK));
+        m_nodes[list.back()].text = "break;";
+        Expect(";");
+    }
+    else if(Peek().kind == TOKEN_NAME && Is("=", 1))
+    {
+        ParseAssignment(list);
+    }
+    else
+    {
+        Fail("unexpected '" + Peek().text + "'");
+    }
+}
+
+/**
+ * @brief parses declaration of local variables
+ * @param list - statements of enclosing block
+ */
+void ProgramCompiler::ParseDeclaration(vector<size_t>& list)
+{
+    Expect("int");
+    size_t node = AddNode(STMT_DECLARATION);
+    list.push_back(node);
+    string text = "int ";
+    Function& function = m_functions.back();
+    do
+    {
+        const Token& name = Peek();
+        if(m_failed || name.kind != TOKEN_NAME)
+        {
+            Fail("expected name of variable");
+            return;
+        }
+        for(size_t i = 0; i < function.locals.size(); ++i)
+            if(function.locals[i].first == name.text)
+                Fail("variable '" + name.text + "' is already declared");
+        for(size_t i = 0; i < function.parameters.size(); ++i)
+            if(function.parameters[i].first == name.text)
+                Fail("variable '" + name.text + "' hides parameter");
+        Variable variable = {function.name + "." + name.text, false, m_functions.size() - 1, false, 0, false, 0, 0, false};
+        function.locals.push_back(make_pair(name.text, m_variables.size()));
+        m_variables.push_back(variable);
+        if(text.size() > 4)
+            text += ",";
+        text += name.text;
+        ++m_position;
+    }
+    while(Accept(","));
+    if(Is("="))
+        Fail("initializer of local variable isn't supported, use assignment");
+    Expect(";");
+    m_nodes[node].text = text + ";";
+}
+
+/**
+ * @brief parses assignment of constant, variable or parameter
+ * @param list - statements of enclosing block
+ */
+void ProgramCompiler::ParseAssignment(vector<size_t>& list)
+{
+    const Token& name = Peek();
+    Operand target;
+    if(!Find(name.text, target))
+    {
+        Fail("unknown variable '" + name.text + "'");
+        return;
+    }
+    if(target.field == NoField || m_variables[target.field].parameter)
+    {
+        Fail("parameter '" + name.text + "' can't be assigned");
+        return;
+    }
+    size_t node = AddNode(STMT_ASSIGNMENT);
+    list.push_back(node);
+    string text = name.text + "=";
+    m_position += 2;
+    Operand source;
+    string source_text;
+    ParseOperand(source, source_text);
+    Expect(";");
+    m_nodes[node].target = target.field;
+    m_nodes[node].source = source;
+    m_nodes[node].text = text + source_text + ";";
+    m_assignments.push_back(make_pair(target.field, source));
+}
+
+/**
+ * @brief parses condition of if or while
+ * @param condition - place for condition
+ */
+void ProgramCompiler::ParseCondition(Condition& condition)
+{
+    ParseOperand(condition.left, condition.text);
+    const char* symbols[] = {"==", "!=", "<", ">", "<=", ">="};
+    const Comparison comparisons[] = {OP_EQUAL, OP_NOT_EQUAL, OP_LESS, OP_GREATER, OP_LESS_EQUAL, OP_GREATER_EQUAL};
+    for(size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); ++i)
+    {
+        if(Accept(symbols[i]))
+        {
+            condition.comparison = comparisons[i];
+            condition.text += symbols[i];
+            string right;
+            ParseOperand(condition.right, right);
+            condition.text += right;
+            return;
+        }
+    }
+    // operand alone is true, if it isn't zero
+    condition.comparison = OP_NOT_EQUAL;
+    condition.right.field = NoField;
+    condition.right.value = 0;
+}
+
+/**
+ * @brief parses number, variable or parameter, parameter becomes constant
+ * @param operand - place for operand, field is number of variable
+ * @param text - text of operand to append
+ */
+void ProgramCompiler::ParseOperand(Operand& operand, string& text)
+{
+    operand.field = NoField;
+    operand.value = 0;
+    if(m_failed)
+        return;
+    const Token& token = Peek();
+    if(token.kind == TOKEN_NAME)
+    {
+        if(!Find(token.text, operand))
+            Fail("unknown variable '" + token.text + "'");
+        text += token.text;
+        ++m_position;
+        return;
+    }
+    if(ParseNumber(operand.value))
+    {
+        ostringstream number;
+        number<<operand.value;
+        text += number.str();
+    }
+}
+
+/**
+ * @brief parses number with optional minus
+ * @param value - place for value
+ * @return false if number isn't found or is out of int range
+ */
+bool ProgramCompiler::ParseNumber(int& value)
+{
+    bool negative = Accept("-");
+    const Token& token = Peek();
+    if(m_failed || token.kind != TOKEN_NUMBER)
+        return Fail("expected number");
+    errno = 0;
+    long long number = strtoll(token.text.c_str(), NULL, 10);
+    if(negative)
+        number = -number;
+    if(errno != 0 || number < INT_MIN || number > INT_MAX)
+        return Fail("number " + token.text + " is out of int range");
+    value = int(number);
+    ++m_position;
+    return true;
+}
+
+/**
+ * @brief finds name in scope of parsed function: local variable, parameter,
+ * global variable
+ * @param name - name of variable
+ * @param operand - place for operand, field is number of variable, parameter
+ * is constant
+ * @return false if name is unknown
+ */
+bool ProgramCompiler::Find(const string& name, Operand& operand) const
+{
+    operand.field = NoField;
+    operand.value = 0;
+    if(!m_functions.empty())
+    {
+        const Function& function = m_functions.back();
+        for(size_t i = 0; i < function.locals.size(); ++i)
+        {
+            if(function.locals[i].first == name)
+            {
+                operand.field = function.locals[i].second;
+                return true;
+            }
+        }
+        for(size_t i = 0; i < function.parameters.size(); ++i)
+        {
+            if(function.parameters[i].first == name)
+            {
+                operand.value = function.parameters[i].second;
+                return true;
+            }
+        }
+    }
+    for(size_t i = 0; i < m_variables.size(); ++i)
+    {
+        if(m_variables[i].global && m_variables[i].name == name)
+        {
+            operand.field = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief adds statement with next value of program counter
+ * @param kind - kind of statement
+ * @return index of statement
+ */
+size_t ProgramCompiler::AddNode(StatementKind kind)
+{
+    Node node;
+    node.kind = kind;
+    node.pc = m_pc++;
+    node.line = Peek().line;
+    node.condition.comparison = OP_TRUE;
+    node.target = NoField;
+    node.source.field = NoField;
+    node.source.value = 0;
+    m_nodes.push_back(node);
+    return m_nodes.size() - 1;
+}
+
+/**
+ * @brief computes range of every variable from assigned values, variable,
+ * which is never assigned, gets range 0..0
+ */
+void ProgramCompiler::ComputeRanges()
+{
+    // copies only join ranges, so few passes are enough
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        for(size_t i = 0; i < m_assignments.size(); ++i)
+        {
+            Variable& target = m_variables[m_assignments[i].first];
+            const Operand& source = m_assignments[i].second;
+            int min = source.value;
+            int max = source.value;
+            if(source.field != NoField)
+            {
+                const Variable& variable = m_variables[source.field];
+                if(!variable.has_range)
+                    continue;
+                min = variable.min;
+                max = variable.max;
+            }
+            if(!target.has_range || min < target.min || max > target.max)
+            {
+                target.min = target.has_range ? std::min(target.min, min) : min;
+                target.max = target.has_range ? std::max(target.max, max) : max;
+                target.has_range = true;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief adds transition of statement
+ * @param condition - guard, NULL for unconditional transition
+ * @param negate - flag, indicates if guard is negated
+ * @param node - statement
+ * @param next - value of program counter after transition
+ * @param label - text of step
+ * @param transitions - place for transitions
+ * @param labels - place for texts of steps
+ */
+void ProgramCompiler::AddTransition(const Condition* condition, bool negate, const Node& node, unsigned int next,
+                                    const string& label, vector<Transition>& transitions, deque<string>& labels) const
+{
+    // negation of comparison by its index in enum
+    const Comparison negations[] = {OP_TRUE, OP_NOT_EQUAL, OP_EQUAL, OP_GREATER_EQUAL, OP_LESS_EQUAL, OP_GREATER, OP_LESS};
+    Transition transition;
+    transition.comparison = OP_TRUE;
+    transition.left.field = NoField;
+    transition.left.value = 0;
+    transition.right = transition.left;
+    if(condition)
+    {
+        transition.comparison = negate ? negations[condition->comparison] : condition->comparison;
+        transition.left = condition->left;
+        transition.right = condition->right;
+    }
+    transition.target = node.target;
+    transition.source = node.source;
+    transition.pc = node.pc;
+    transition.next = next;
+    transition.line = node.line;
+    // texts in deque aren't moved, when new ones are added
+    labels.push_back(label);
+    transition.label = labels.back().c_str();
+    transition.access.reads = 0;
+    transition.access.writes = 0;
+    transitions.push_back(transition);
+}
+
+/**
+ * @brief adds transitions of statements
+ * @param list - statements of block
+ * @param cont - value of program counter after block
+ * @param exit - value of program counter after enclosing while
+ * @param transitions - place for transitions
+ * @param labels - place for texts of steps
+ */
+void ProgramCompiler::Emit(const vector<size_t>& list, unsigned int cont, unsigned int exit,
+                           vector<Transition>& transitions, deque<string>& labels) const
+{
+    for(size_t i = 0; i < list.size(); ++i)
+    {
+        const Node& node = m_nodes[list[i]];
+        unsigned int next = i + 1 < list.size() ? m_nodes[list[i + 1]].pc : cont;
+        switch(node.kind)
+        {
+            case STMT_DECLARATION:
+            case STMT_ASSIGNMENT:
+                AddTransition(NULL, false, node, next, node.text, transitions, labels);
+                break;
+            case STMT_BREAK:
+                AddTransition(NULL, false, node, exit, node.text, transitions, labels);
+                break;
+            case STMT_IF:
+            {
+                unsigned int then_pc = node.body.empty() ? next : m_nodes[node.body[0]].pc;
+                unsigned int else_pc = node.other.empty() ? next : m_nodes[node.other[0]].pc;
+                AddTransition(&node.condition, false, node, then_pc, node.condition.text + ";", transitions, labels);
+                AddTransition(&node.condition, true, node, else_pc, "!(" + node.condition.text + ");", transitions, labels);
+                Emit(node.body, next, exit, transitions, labels);
+                Emit(node.other, next, exit, transitions, labels);
+                break;
+            }
+            case STMT_WHILE:
+            {
+                unsigned int body_pc = node.body.empty() ? node.pc : m_nodes[node.body[0]].pc;
+                AddTransition(&node.condition, false, node, body_pc, node.condition.text + ";", transitions, labels);
+                AddTransition(&node.condition, true, node, next, "!(" + node.condition.text + ");", transitions, labels);
+                // body continues with condition, break leaves loop
+                Emit(node.body, node.pc, next, transitions, labels);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief orders transitions by program counter
+ * @param left - transition
+ * @param right - transition
+ */
+static bool ByPc(const Transition& left, const Transition& right)
+{
+    return left.pc < right.pc;
+}
+
+/**
+ * @brief maps number of variable in operand to field
+ * @param operand - operand
+ * @param fields - fields of variables
+ */
+static void MapOperand(Operand& operand, const vector<size_t>& fields)
+{
+    if(operand.field != NoField)
+        operand.field = fields[operand.field];
+}
+
+/**
+ * @brief adds field of operand to access bits
+ * @param operand - operand
+ * @param bits - bits of fields
+ */
+static void AddAccess(const Operand& operand, uint64_t& bits)
+{
+    if(operand.field != NoField)
+        bits |= uint64_t(1) << operand.field;
+}
+
+/**
+ * @brief adds values of one set to other one
+ * @param target - changed set
+ * @param source - added set
+ * @return true if target is changed
+ */
+static bool Join(ValueSet& target, const ValueSet& source)
+{
+    bool changed = (source.uninit && !target.uninit) || (source.any && !target.any);
+    target.uninit = target.uninit || source.uninit;
+    target.any = target.any || source.any;
+    for(size_t i = 0; i < source.values.size(); ++i)
+    {
+        vector<int>::iterator place = lower_bound(target.values.begin(), target.values.end(), source.values[i]);
+        if(place == target.values.end() || *place != source.values[i])
+        {
+            target.values.insert(place, source.values[i]);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief checks comparison of two numbers
+ * @param comparison - comparison
+ * @param left - left number
+ * @param right - right number
+ */
+static bool Compare(Comparison comparison, int left, int right)
+{
+    switch(comparison)
+    {
+        case OP_EQUAL:
+            return left == right;
+        case OP_NOT_EQUAL:
+            return left != right;
+        case OP_LESS:
+            return left < right;
+        case OP_GREATER:
+            return left > right;
+        case OP_LESS_EQUAL:
+            return left <= right;
+        case OP_GREATER_EQUAL:
+            return left >= right;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief keeps values of one side of guard, which hold with some value of
+ * other side, uninitialized value blocks guard
+ * @param comparison - comparison of guard
+ * @param side - values of changed side
+ * @param other - values of other side
+ * @param mirrored - flag, indicates if changed side is right one
+ */
+static void Filter(Comparison comparison, ValueSet& side, const ValueSet& other, bool mirrored)
+{
+    side.uninit = false;
+    if(side.any || other.any)
+        return;
+    vector<int> values;
+    for(size_t i = 0; i < side.values.size(); ++i)
+    {
+        bool holds = false;
+        for(size_t j = 0; j < other.values.size() && !holds; ++j)
+            holds = mirrored ? Compare(comparison, other.values[j], side.values[i])
+                             : Compare(comparison, side.values[i], other.values[j]);
+        if(holds)
+            values.push_back(side.values[i]);
+    }
+    side.values.swap(values);
+}
+
+/**
+ * @brief values of operand
+ * @param operand - operand, field is number of variable
+ * @param locals - values of variables at program counter
+ * @param globals - values of global variables in all states
+ */
+ValueSet ProgramCompiler::Values(const Operand& operand, const vector<ValueSet>& locals, const vector<ValueSet>& globals) const
+{
+    if(operand.field == NoField)
+    {
+        ValueSet constant = {false, false, vector<int>(1, operand.value)};
+        return constant;
+    }
+    return m_variables[operand.field].global ? globals[operand.field] : locals[operand.field];
+}
+
+/**
+ * @brief does transition on values of variables at its program counter
+ * @param transition - transition, fields of operands are numbers of variables
+ * @param globals - values of global variables in all states
+ * @param state - values of variables, changed to values after transition
+ * @return false if guard never holds
+ */
+bool ProgramCompiler::Post(const Transition& transition, const vector<ValueSet>& globals, vector<ValueSet>& state) const
+{
+    if(transition.comparison != OP_TRUE)
+    {
+        ValueSet left = Values(transition.left, state, globals);
+        ValueSet right = Values(transition.right, state, globals);
+        Filter(transition.comparison, left, Values(transition.right, state, globals), false);
+        Filter(transition.comparison, right, Values(transition.left, state, globals), true);
+        if((!left.any && left.values.empty()) || (!right.any && right.values.empty()))
+            return false;
+        // local variables keep values, which pass guard, globals can be changed by other threads
+        if(transition.left.field != NoField && !m_variables[transition.left.field].global)
+            state[transition.left.field] = left;
+        if(transition.right.field != NoField && !m_variables[transition.right.field].global)
+            state[transition.right.field] = right;
+    }
+    if(transition.target != NoField && !m_variables[transition.target].global)
+        state[transition.target] = Values(transition.source, state, globals);
+    return true;
+}
+
+/**
+ * @brief finds values of variables at every program counter and removes
+ * transitions, which guards never hold. Local variables are changed only
+ * by their thread, so their values are found for every program counter,
+ * global variables get all values, assigned by reachable transitions.
+ * @param code - transitions of functions, sorted by program counter
+ * @return number of removed transitions
+ */
+size_t ProgramCompiler::Analyze(vector<vector<Transition> >& code)
+{
+    ValueSet uninit = {true, false, vector<int>()};
+    ValueSet any = {false, true, vector<int>()};
+    vector<ValueSet> globals(m_variables.size(), uninit);
+    for(size_t i = 0; i < m_variables.size(); ++i)
+        if(m_variables[i].global && m_variables[i].initialized)
+        {
+            Operand initial = {NoField, m_variables[i].initial};
+            globals[i] = Values(initial, globals, globals);
+        }
+    vector<ValueSet> values(m_variables.size(), uninit);
+    vector<vector<bool> > live(code.size());
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        values.assign(m_variables.size(), uninit);
+        for(size_t function = 0; function < code.size(); ++function)
+        {
+            const vector<Transition>& transitions = code[function];
+            unsigned int end = m_functions[function].end;
+            vector<size_t> first(end + 2, 0);
+            for(size_t i = 0; i < transitions.size(); ++i)
+                ++first[transitions[i].pc + 1];
+            for(size_t pc = 0; pc <= end; ++pc)
+                first[pc + 1] += first[pc];
+            // values of variables at program counters, parameters are constants or intervals
+            vector<vector<ValueSet> > states(end + 1);
+            vector<bool> reached(end + 1, false);
+            states[0].assign(m_variables.size(), uninit);
+            for(size_t i = 0; i < m_variables.size(); ++i)
+                if(m_variables[i].parameter)
+                    states[0][i] = any;
+            reached[0] = true;
+            live[function].assign(transitions.size(), false);
+            vector<unsigned int> work(1, 0);
+            while(!work.empty())
+            {
+                unsigned int pc = work.back();
+                work.pop_back();
+                for(size_t i = first[pc]; i < first[pc + 1]; ++i)
+                {
+                    const Transition& transition = transitions[i];
+                    vector<ValueSet> state = states[pc];
+                    if(!Post(transition, globals, state))
+                        continue;
+                    live[function][i] = true;
+                    if(transition.target != NoField && m_variables[transition.target].global)
+                        changed = Join(globals[transition.target], Values(transition.source, state, globals)) || changed;
+                    bool grown = !reached[transition.next];
+                    if(grown)
+                    {
+                        states[transition.next] = state;
+                        reached[transition.next] = true;
+                    }
+                    else
+                    {
+                        for(size_t j = 0; j < state.size(); ++j)
+                            grown = Join(states[transition.next][j], state[j]) || grown;
+                    }
+                    if(grown)
+                        work.push_back(transition.next);
+                }
+            }
+            for(size_t pc = 0; pc <= end; ++pc)
+                if(reached[pc])
+                    for(size_t i = 0; i < m_variables.size(); ++i)
+                        if(!m_variables[i].global)
+                            Join(values[i], states[pc][i]);
+        }
+    }
+
+    // ranges of variables are narrowed to found values
+    for(size_t i = 0; i < m_variables.size(); ++i)
+    {
+        const ValueSet& found = m_variables[i].global ? globals[i] : values[i];
+        Variable& variable = m_variables[i];
+        if(found.any || variable.parameter)
+            continue;
+        variable.has_range = !found.values.empty();
+        if(variable.has_range)
+        {
+            variable.min = found.values.front();
+            variable.max = found.values.back();
+        }
+    }
+    size_t removed = 0;
+    for(size_t function = 0; function < code.size(); ++function)
+    {
+        vector<Transition> transitions;
+        for(size_t i = 0; i < code[function].size(); ++i)
+            if(live[function][i])
+                transitions.push_back(code[function][i]);
+        removed += code[function].size() - transitions.size();
+        code[function].swap(transitions);
+    }
+    return removed;
+}
+
+/**
+ * @brief finds local variables, which can be read later, for every program
+ * counter of function: variable is live, if some path reads it before
+ * assignment. Parameters are always live, they aren't reset.
+ * @param transitions - transitions of function, fields are numbers of variables
+ * @param function - number of function
+ * @return flags of live variables by program counter and number of variable
+ */
+vector<vector<bool> > ProgramCompiler::Liveness(const vector<Transition>& transitions, size_t function) const
+{
+    unsigned int end = m_functions[function].end;
+    vector<vector<bool> > live(end + 1, vector<bool>(m_variables.size(), false));
+    for(size_t pc = 0; pc <= end; ++pc)
+        for(size_t i = 0; i < m_variables.size(); ++i)
+            live[pc][i] = m_variables[i].global || m_variables[i].parameter;
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        // transitions go forward mostly, so backward order converges fast
+        for(size_t i = transitions.size(); i-- > 0;)
+        {
+            const Transition& transition = transitions[i];
+            vector<bool> before = live[transition.next];
+            if(transition.target != NoField)
+                before[transition.target] = m_variables[transition.target].global;
+            if(transition.comparison != OP_TRUE && transition.left.field != NoField)
+                before[transition.left.field] = true;
+            if(transition.comparison != OP_TRUE && transition.right.field != NoField)
+                before[transition.right.field] = true;
+            if(transition.target != NoField && transition.source.field != NoField)
+                before[transition.source.field] = true;
+            for(size_t j = 0; j < before.size(); ++j)
+            {
+                if(before[j] && !live[transition.pc][j])
+                {
+                    live[transition.pc][j] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return live;
+}
+
+/**
+ * @brief number of bits in mask of lowest bits
+ * @param mask - mask
+ */
+static unsigned int BitsOf(uint64_t mask)
+{
+    unsigned int bits = 0;
+    while(bits < 64 && (mask >> bits) != 0)
+        ++bits;
+    return bits;
+}
+
+/**
+ * @brief parses text and fills program
+ * @param text - program text
+ * @param program - empty program
+ * @return false if program isn't accepted, error is printed
+ */
+bool ProgramCompiler::Compile(const string& text, Program& program)
+{
+    if(!Tokenize(text))
+        return false;
+    ParseProgram();
+    if(m_failed)
+        return false;
+    if(m_functions.empty())
+        return Fail("program has no functions", Peek().line);
+    if(m_functions.size() > MaxThreads)
+        return Fail("program has too many functions", Peek().line);
+    if(!m_symbolic && m_used_arguments > m_arguments.size())
+        cerr<<"Program has "<<m_used_arguments<<" parameters, but "<<m_arguments.size()
+            <<" values are given, missing values are 0"<<endl;
+    if(!m_symbolic && m_used_arguments < m_arguments.size())
+        cerr<<"Program has "<<m_used_arguments<<" parameters, but "<<m_arguments.size()
+            <<" values are given, extra values are ignored"<<endl;
+    ComputeRanges();
+    vector<vector<Transition> > code_of_functions(m_functions.size());
+    for(size_t i = 0; i < m_functions.size(); ++i)
+    {
+        const Function& function = m_functions[i];
+        Emit(function.body, function.end, function.end, code_of_functions[i], program.m_labels);
+        stable_sort(code_of_functions[i].begin(), code_of_functions[i].end(), ByPc);
+    }
+    // dead transitions aren't tried by exploration, narrowed ranges take fewer bits
+    program.m_removed = Analyze(code_of_functions);
+
+    // replicas of function are threads with same code and own local variables
+    vector<pair<size_t, size_t> > threads;
+    vector<size_t> counts(m_functions.size(), 1);
+    for(map<string, size_t>::const_iterator replica = m_replicas.begin(); replica != m_replicas.end(); ++replica)
+    {
+        size_t function = 0;
+        while(function < m_functions.size() && m_functions[function].name != replica->first)
+            ++function;
+        if(function == m_functions.size())
+            return Fail("replicated function '" + replica->first + "' isn't defined", Peek().line);
+        counts[function] = replica->second;
+    }
+    for(size_t i = 0; i < m_functions.size(); ++i)
+        for(size_t j = 0; j < counts[i]; ++j)
+            threads.push_back(make_pair(i, j));
+    if(threads.empty())
+        return Fail("program has no threads", Peek().line);
+    if(threads.size() > MaxThreads)
+        return Fail("program has too many threads", Peek().line);
+
+    // fields are counters, global variables and local variables of threads
+    program.m_names.reserve(threads.size() * (1 + 2 * m_variables.size()));
+    vector<string> names;
+    for(size_t i = 0; i < threads.size(); ++i)
+    {
+        const Function& function = m_functions[threads[i].first];
+        ostringstream name;
+        name<<function.name;
+        if(counts[threads[i].first] > 1)
+            name<<"["<<threads[i].second<<"]";
+        names.push_back(name.str());
+        program.m_names.push_back(names.back() + ".counter");
+        program.m_layout.AddCounter(program.m_names.back().c_str(), function.end);
+    }
+    vector<vector<size_t> > fields(threads.size(), vector<size_t>(m_variables.size(), NoField));
+    // symbolic variables can keep numbers of parameters, globals of all ones
+    size_t parameters_number = 0;
+    for(size_t i = 0; m_symbolic && i < threads.size(); ++i)
+        parameters_number += m_functions[threads[i].first].parameters.size();
+    vector<pair<size_t, Program::Alias> > aliases;
+    vector<bool> replicated;
+    for(size_t pass = 0; pass <= threads.size(); ++pass)
+    {
+        size_t base = program.m_parameters.size();
+        for(size_t i = 0; i < m_variables.size(); ++i)
+        {
+            const Variable& variable = m_variables[i];
+            if(pass == 0 ? !variable.global : variable.global || variable.thread != threads[pass - 1].first)
+                continue;
+            // local variable is named by its thread, name of function is replaced
+            string name = pass == 0 ? variable.name
+                                    : names[pass - 1] + variable.name.substr(m_functions[variable.thread].name.size());
+            program.m_names.push_back(variable.parameter ? name + ".min" : name);
+            size_t field = program.m_layout.AddVariable(program.m_names.back().c_str(),
+                                                        variable.has_range ? variable.min : 0,
+                                                        variable.has_range ? variable.max : 0);
+            if(variable.parameter)
+            {
+                // bounds of interval are next to each other, operands refer to lower one
+                program.m_names.push_back(name + ".max");
+                program.m_layout.AddVariable(program.m_names.back().c_str(), variable.min, variable.max);
+                Operand min = {field, variable.min};
+                Operand max = {field + 1, variable.max};
+                program.m_initial.push_back(min);
+                program.m_initial.push_back(max);
+                program.m_parameters.push_back(field);
+                program.m_parameter_values.push_back(variable.initial);
+                replicated.push_back(counts[threads[pass - 1].first] > 1);
+            }
+            else if(m_symbolic && parameters_number > 0)
+            {
+                size_t count = pass == 0 ? parameters_number : m_functions[threads[pass - 1].first].parameters.size();
+                program.m_names.push_back(name + ".alias");
+                Program::Alias alias = {program.m_layout.AddVariable(program.m_names.back().c_str(), 0, int(count)),
+                                        pass == 0 ? 0 : base, count, pass == 0};
+                Operand none = {alias.field, 0};
+                program.m_initial.push_back(none);
+                aliases.push_back(make_pair(field, alias));
+            }
+            for(size_t j = 0; j < threads.size(); ++j)
+                if(pass == 0 || j == pass - 1)
+                    fields[j][i] = field;
+        }
+    }
+    if(program.m_layout.Words() > MaxStateWords)
+        return Fail("variables don't fit in packed state", Peek().line);
+    if(program.m_layout.Fields() > MaxAccessFields)
+        return Fail("program has too many variables", Peek().line);
+    for(size_t i = 0; i < program.m_parameters.size(); ++i)
+    {
+        program.m_parameter_mask |= uint64_t(1) << program.m_parameters[i];
+        if(replicated[i])
+            program.m_replicated_parameters |= uint64_t(1) << program.m_parameters[i];
+    }
+    if(!aliases.empty())
+    {
+        Program::Alias none = {NoField, 0, 0, false};
+        program.m_aliases.assign(program.m_layout.Fields(), none);
+        for(size_t i = 0; i < aliases.size(); ++i)
+            program.m_aliases[aliases[i].first] = aliases[i].second;
+    }
+    // globals with initializer are assigned before any other statement
+    for(size_t i = 0; i < m_variables.size(); ++i)
+    {
+        if(!m_variables[i].global || !m_variables[i].initialized)
+            continue;
+        Operand initial = {fields[0][i], m_variables[i].initial};
+        program.m_initial.push_back(initial);
+    }
+
+    vector<vector<vector<bool> > > live_of_functions(m_functions.size());
+    for(size_t i = 0; i < m_functions.size(); ++i)
+        live_of_functions[i] = Liveness(code_of_functions[i], i);
+    for(size_t thread = 0; thread < threads.size(); ++thread)
+    {
+        const Function& function = m_functions[threads[thread].first];
+        vector<Transition> transitions = code_of_functions[threads[thread].first];
+        Program::ThreadCode code;
+        code.name = names[thread];
+        code.counter = thread;
+        code.end = function.end;
+        code.first.assign(function.end + 2, 0);
+        // component of thread is its counter and local variables in order of layout
+        code.component.push_back(thread);
+        for(size_t i = 0; i < m_variables.size(); ++i)
+            if(!m_variables[i].global && m_variables[i].thread == threads[thread].first)
+            {
+                code.component.push_back(fields[thread][i]);
+                if(m_variables[i].parameter)
+                    code.component.push_back(fields[thread][i] + 1);
+                else if(!program.m_aliases.empty() && program.m_aliases[fields[thread][i]].field != NoField)
+                    code.component.push_back(program.m_aliases[fields[thread][i]].field);
+            }
+        vector<Statement> statements;
+        for(size_t i = 0; i < transitions.size(); ++i)
+        {
+            Transition& transition = transitions[i];
+            MapOperand(transition.left, fields[thread]);
+            MapOperand(transition.right, fields[thread]);
+            MapOperand(transition.source, fields[thread]);
+            if(transition.target != NoField)
+                transition.target = fields[thread][transition.target];
+            AddAccess(transition.left, transition.access.reads);
+            AddAccess(transition.right, transition.access.reads);
+            AddAccess(transition.source, transition.access.reads);
+            if(transition.target != NoField)
+                transition.access.writes = uint64_t(1) << transition.target;
+            ++code.first[transition.pc + 1];
+            Statement statement = {transition.pc, transition.next, transition.access};
+            statements.push_back(statement);
+        }
+        for(size_t pc = 0; pc <= function.end; ++pc)
+            code.first[pc + 1] += code.first[pc];
+        for(size_t pc = 0; pc < code.first.size(); ++pc)
+            code.first[pc] += program.m_transitions.size();
+        code.access = new ThreadAccess(statements.empty() ? NULL : &statements[0], statements.size(), function.end);
+        // dead local variables of thread are cleared by mask of its program counter
+        const vector<vector<bool> >& live = live_of_functions[threads[thread].first];
+        code.live.resize(function.end + 1);
+        for(size_t pc = 0; pc <= function.end; ++pc)
+        {
+            vector<size_t> kept;
+            for(size_t i = 0; i < program.m_layout.Fields(); ++i)
+                kept.push_back(i);
+            for(size_t i = 0; i < m_variables.size(); ++i)
+                if(!live[pc][i] && fields[thread][i] != NoField)
+                {
+                    kept[fields[thread][i]] = NoField;
+                    if(!program.m_aliases.empty() && program.m_aliases[fields[thread][i]].field != NoField)
+                        kept[program.m_aliases[fields[thread][i]].field] = NoField;
+                    program.m_resettable |= uint64_t(1) << fields[thread][i];
+                }
+            kept.erase(remove(kept.begin(), kept.end(), NoField), kept.end());
+            program.m_layout.Mask(kept, code.live[pc]);
+        }
+        program.m_threads.push_back(code);
+        program.m_transitions.insert(program.m_transitions.end(), transitions.begin(), transitions.end());
+    }
+
+    // replicas of one function are permuted by symmetry reduction
+    for(size_t i = 0; i < m_functions.size(); ++i)
+    {
+        if(counts[i] < 2)
+            continue;
+        Program::Symmetry symmetry;
+        symmetry.bits = 0;
+        for(size_t thread = 0; thread < threads.size(); ++thread)
+            if(threads[thread].first == i)
+                symmetry.threads.push_back(thread);
+        const vector<size_t>& component = program.m_threads[symmetry.threads[0]].component;
+        for(size_t j = 0; j < component.size(); ++j)
+        {
+            symmetry.widths.push_back(BitsOf(program.m_layout.RawMask(component[j])));
+            symmetry.bits += symmetry.widths.back();
+        }
+        if(symmetry.bits > 64)
+        {
+            cerr<<"Local state of "<<m_functions[i].name<<" is longer than 64 bits, its replicas aren't permuted"<<endl;
+            continue;
+        }
+        program.m_symmetries.push_back(symmetry);
+    }
+    return true;
+}
+
+/**
+ * @brief class constructor, makes empty program
+ */
+Program::Program(): m_layout()
+                  , m_names()
+                  , m_initial()
+                  , m_threads()
+                  , m_transitions()
+                  , m_labels()
+                  , m_symmetries()
+                  , m_parameters()
+                  , m_parameter_values()
+                  , m_parameter_mask(0)
+                  , m_replicated_parameters(0)
+                  , m_aliases()
+                  , m_removed(0)
+                  , m_resettable(0)
+                  , m_fused_points(0)
+{
+}
+
+/**
+ * @brief class destructor
+ */
+Program::~Program()
+{
+    Clear();
+}
+
+/**
+ * @brief removes compiled program
+ */
+void Program::Clear()
+{
+    for(size_t i = 0; i < m_threads.size(); ++i)
+        delete m_threads[i].access;
+    m_layout = StateLayout();
+    m_names.clear();
+    m_initial.clear();
+    m_threads.clear();
+    m_transitions.clear();
+    m_labels.clear();
+    m_symmetries.clear();
+    m_parameters.clear();
+    m_parameter_values.clear();
+    m_parameter_mask = 0;
+    m_replicated_parameters = 0;
+    m_aliases.clear();
+    m_removed = 0;
+    m_resettable = 0;
+    m_fused_points = 0;
+}
+
+/**
+ * @brief parses program and compiles it to transitions, prints error to cerr
+ * @param filename - name of file with program
+ * @param arguments - values of parameters of all functions in order of text,
+ * missing ones are 0
+ * @param replicas - numbers of threads of functions, 1 for missing ones
+ * @param symbolic - range of values of all parameters, which become
+ * intervals in state, NULL to use arguments
+ * @return false if file can't be read or program isn't accepted
+ */
+bool Program::Load(const char* filename, const vector<int>& arguments, const map<string, size_t>& replicas,
+                   const ParameterRange* symbolic)
+{
+    Clear();
+    ifstream file(filename);
+    if(!file)
+    {
+        cerr<<"Can't read program "<<filename<<endl;
+        return false;
+    }
+    stringstream text;
+    text<<file.rdbuf();
+    ProgramCompiler compiler(filename, arguments, replicas, symbolic);
+    if(compiler.Compile(text.str(), *this))
+        return true;
+    Clear();
+    return false;
+}
+
+/**
+ * @brief makes initial state: zero counters, initialized global variables
+ * @param state - place for state
+ */
+void Program::Initial(PackedState& state) const
+{
+    m_layout.Clear(state);
+    for(size_t i = 0; i < m_initial.size(); ++i)
+        m_layout.Set(state, m_initial[i].field, m_initial[i].value);
+}
+
+/**
+ * @brief local state of thread as one number, fields are concatenated
+ * @param state - packed state
+ * @param thread - number of thread
+ * @param symmetry - group of thread
+ */
+uint64_t Program::Component(const PackedState& state, size_t thread, const Symmetry& symmetry) const
+{
+    const vector<size_t>& component = m_threads[thread].component;
+    uint64_t result = 0;
+    for(size_t i = 0; i < component.size(); ++i)
+    {
+        size_t field = component[i];
+        uint64_t raw = (state.words[m_layout.Word(field)] >> m_layout.Shift(field)) & m_layout.RawMask(field);
+        // shift by 64 isn't defined, single field of 64 bits is whole number
+        result = symmetry.widths[i] < 64 ? (result << symmetry.widths[i]) | raw : raw;
+    }
+    return result;
+}
+
+/**
+ * @brief writes local state of thread, made by Component
+ * @param state - packed state
+ * @param thread - number of thread
+ * @param symmetry - group of thread
+ * @param component - local state
+ */
+void Program::SetComponent(PackedState& state, size_t thread, const Symmetry& symmetry, uint64_t component) const
+{
+    const vector<size_t>& fields = m_threads[thread].component;
+    for(size_t i = fields.size(); i-- > 0;)
+    {
+        size_t field = fields[i];
+        uint64_t mask = m_layout.RawMask(field);
+        uint64_t& word = state.words[m_layout.Word(field)];
+        word = (word & ~(mask << m_layout.Shift(field))) | ((component & mask) << m_layout.Shift(field));
+        component = symmetry.widths[i] < 64 ? component >> symmetry.widths[i] : 0;
+    }
+}
+
+/**
+ * @brief sorts local states of replicas of every function, so states, which
+ * differ by permutation of replicas, become equal
+ * @param state - packed state, changed in place
+ */
+void Program::Canonicalize(PackedState& state) const
+{
+    uint64_t components[MaxThreads];
+    for(size_t i = 0; i < m_symmetries.size(); ++i)
+    {
+        const Symmetry& symmetry = m_symmetries[i];
+        const vector<size_t>& threads = symmetry.threads;
+        // groups are small, insertion sort is fastest
+        for(size_t j = 0; j < threads.size(); ++j)
+        {
+            uint64_t component = Component(state, threads[j], symmetry);
+            size_t k = j;
+            for(; k > 0 && components[k - 1] > component; --k)
+                components[k] = components[k - 1];
+            components[k] = component;
+        }
+        for(size_t j = 0; j < threads.size(); ++j)
+            SetComponent(state, threads[j], symmetry, components[j]);
+    }
+}
+
+/**
+ * @brief parses list of replicated functions like "worker=4,f=2"
+ * @param list - comma separated list of function=count, count > 0
+ * @param replicas - place for numbers of threads of functions
+ * @return false if list is malformed
+ */
+bool ParseReplicas(const char* list, map<string, size_t>& replicas)
+{
+    while(*list)
+    {
+        const char* equal = strchr(list, '=');
+        if(!equal || equal == list)
+            return false;
+        char* end;
+        long count = strtol(equal + 1, &end, 10);
+        if(end == equal + 1 || count <= 0 || count > long(MaxThreads) || (*end != ',' && *end != '\0'))
+            return false;
+        replicas[string(list, equal)] = size_t(count);
+        list = *end ? end + 1 : end;
+    }
+    return true;
+}
+
+/**
+ * @brief narrows interval of parameter, bounds are cut to its range
+ * @param state - packed state
+ * @param field - lower bound field of parameter
+ * @param min - lower bound
+ * @param max - upper bound
+ * @param next - place for narrowed state, added if interval isn't empty
+ */
+void Program::Narrow(const PackedState& state, size_t field, int64_t min, int64_t max, vector<PackedState>& next) const
+{
+    min = std::max<int64_t>(min, m_layout.Value(state, field));
+    max = std::min<int64_t>(max, m_layout.Value(state, field + 1));
+    if(min > max)
+        return;
+    next.push_back(state);
+    m_layout.Set(next.back(), field, int(min));
+    m_layout.Set(next.back(), field + 1, int(max));
+}
+
+/**
+ * @brief decides comparison of all values of two intervals
+ * @param comparison - comparison
+ * @param min1 - lower bound of left interval
+ * @param max1 - upper bound of left interval
+ * @param min2 - lower bound of right interval
+ * @param max2 - upper bound of right interval
+ * @return 1 if comparison holds for all pairs of values, 0 if it holds for
+ * none, -1 otherwise
+ */
+static int Decide(Comparison comparison, int64_t min1, int64_t max1, int64_t min2, int64_t max2)
+{
+    bool all;
+    bool none;
+    switch(comparison)
+    {
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+            all = min1 == max1 && min2 == max2 && min1 == min2;
+            none = max1 < min2 || max2 < min1;
+            if(comparison == OP_NOT_EQUAL)
+                std::swap(all, none);
+            break;
+        case OP_LESS:
+            all = max1 < min2;
+            none = min1 >= max2;
+            break;
+        case OP_GREATER:
+            all = min1 > max2;
+            none = max1 <= min2;
+            break;
+        case OP_LESS_EQUAL:
+            all = max1 <= min2;
+            none = min1 > max2;
+            break;
+        case OP_GREATER_EQUAL:
+            all = min1 >= max2;
+            none = max1 < min2;
+            break;
+        default:
+            return 1;
+    }
+    return all ? 1 : (none ? 0 : -1);
+}
+
+/**
+ * @brief number of parameter, which variable can keep instead of value
+ * @param target - assigned variable
+ * @param parameter - lower bound field of parameter
+ * @return 0 if parameter isn't kept by variable
+ */
+size_t Program::AliasNumber(size_t target, size_t parameter) const
+{
+    if(m_aliases.empty() || m_aliases[target].field == NoField)
+        return 0;
+    const Alias& alias = m_aliases[target];
+    size_t index = find(m_parameters.begin(), m_parameters.end(), parameter) - m_parameters.begin();
+    if(index < alias.base || index >= alias.base + alias.count)
+        return 0;
+    // global variable isn't permuted with replicas, so it can't keep their parameters
+    if(alias.global && (m_replicated_parameters >> parameter & 1))
+        return 0;
+    return index - alias.base + 1;
+}
+
+/**
+ * @brief does assignment and step of program counter, variable keeps number
+ * of parameter with several values
+ * @param state - packed state, changed in place
+ * @param thread - number of thread
+ * @param transition - transition, which guard holds
+ * @param source - resolved source of assignment
+ */
+void Program::Assign(PackedState& state, size_t thread, const Transition& transition, const Operand& source) const
+{
+    size_t target = transition.target;
+    if(target != NoField)
+    {
+        size_t alias = m_aliases.empty() ? NoField : m_aliases[target].field;
+        size_t number = Undecided(state, source) ? AliasNumber(target, source.field) : 0;
+        if(number > 0)
+            m_layout.Reset(state, target);
+        else if(source.field == NoField)
+            m_layout.Set(state, target, source.value);
+        else
+            m_layout.Copy(state, target, source.field);
+        if(alias != NoField)
+            m_layout.Set(state, alias, int(number));
+    }
+    m_layout.Set(state, m_threads[thread].counter, int(transition.next));
+}
+
+/**
+ * @brief replaces numbers of parameters, which have one value, by value,
+ * so equal states have one form
+ * @param state - packed state, changed in place
+ */
+void Program::Settle(PackedState& state) const
+{
+    for(size_t i = 0; i < m_aliases.size(); ++i)
+    {
+        if(m_aliases[i].field == NoField)
+            continue;
+        Operand variable = {i, 0};
+        Operand parameter = Resolve(state, variable);
+        if(parameter.field == i || Undecided(state, parameter))
+            continue;
+        m_layout.Set(state, i, m_layout.Value(state, parameter.field));
+        m_layout.Set(state, m_aliases[i].field, 0);
+    }
+}
+
+/**
+ * @brief states, where comparison of resolved operands holds, parameters
+ * are narrowed
+ * @param state - packed state
+ * @param left - left operand
+ * @param comparison - comparison
+ * @param right - right operand
+ * @param next - place for states
+ */
+void Program::SymbolicCompare(const PackedState& state, Operand left, Comparison comparison, Operand right,
+                              vector<PackedState>& next) const
+{
+    const Comparison mirrored[] = {OP_TRUE, OP_EQUAL, OP_NOT_EQUAL, OP_GREATER, OP_LESS, OP_GREATER_EQUAL, OP_LESS_EQUAL};
+    if(Undecided(state, right) && !Undecided(state, left))
+    {
+        // parameter is kept left, comparison is mirrored
+        std::swap(left, right);
+        comparison = mirrored[comparison];
+    }
+    if(!Undecided(state, left) || left.field == right.field)
+    {
+        // operand is compared with itself, if both have value of one parameter
+        int known1;
+        int known2;
+        if(Read(state, left, known1) && Read(state, right, known2) && Decide(comparison, known1, known1, known2, known2) == 1)
+            next.push_back(state);
+        return;
+    }
+    if(Undecided(state, right))
+    {
+        int min1;
+        int max1;
+        int min2;
+        int max2;
+        Bounds(state, left.field, min1, max1);
+        Bounds(state, right.field, min2, max2);
+        int decided = Decide(comparison, min1, max1, min2, max2);
+        if(decided >= 0)
+        {
+            if(decided)
+                next.push_back(state);
+            return;
+        }
+        if(max1 - min1 > max2 - min2)
+        {
+            // narrower parameter is split
+            std::swap(left, right);
+            std::swap(min1, min2);
+            std::swap(max1, max2);
+            comparison = mirrored[comparison];
+        }
+        // values out of other interval are decided at once, common ones are split
+        vector<PackedState> parts;
+        Narrow(state, left.field, INT64_MIN, int64_t(min2) - 1, parts);
+        Narrow(state, left.field, int64_t(max2) + 1, INT64_MAX, parts);
+        for(int64_t value = std::max(min1, min2); value <= std::min(max1, max2); ++value)
+            Narrow(state, left.field, value, value, parts);
+        for(size_t i = 0; i < parts.size(); ++i)
+            SymbolicCompare(parts[i], left, comparison, right, next);
+        return;
+    }
+    int64_t value;
+    {
+        int known;
+        if(!Read(state, right, known))
+            return;
+        value = known;
+    }
+    const int64_t low = INT64_MIN;
+    const int64_t high = INT64_MAX;
+    switch(comparison)
+    {
+        case OP_EQUAL:
+            Narrow(state, left.field, value, value, next);
+            break;
+        case OP_NOT_EQUAL:
+            Narrow(state, left.field, low, value - 1, next);
+            Narrow(state, left.field, value + 1, high, next);
+            break;
+        case OP_LESS:
+            Narrow(state, left.field, low, value - 1, next);
+            break;
+        case OP_GREATER:
+            Narrow(state, left.field, value + 1, high, next);
+            break;
+        case OP_LESS_EQUAL:
+            Narrow(state, left.field, low, value, next);
+            break;
+        case OP_GREATER_EQUAL:
+            Narrow(state, left.field, value, high, next);
+            break;
+        default:
+            next.push_back(state);
+            break;
+    }
+}
+
+/**
+ * @brief states, where guard of transition holds, parameters of guard are
+ * narrowed
+ * @param state - packed state
+ * @param transition - transition
+ * @param next - place for states
+ */
+void Program::SymbolicHolds(const PackedState& state, const Transition& transition, vector<PackedState>& next) const
+{
+    if(transition.comparison == OP_TRUE)
+        next.push_back(state);
+    else
+        SymbolicCompare(state, Resolve(state, transition.left), transition.comparison, Resolve(state, transition.right), next);
+}
+
+/**
+ * @brief makes successors of state by step of thread, where parameters are
+ * intervals: state is split only if guard can't be decided, assigned
+ * variable keeps number of parameter with several values
+ * @param state - packed state
+ * @param thread - number of thread
+ * @param next - place for successors, they are added
+ * @return number of added successors
+ */
+size_t Program::SymbolicSteps(const PackedState& state, size_t thread, vector<PackedState>& next) const
+{
+    size_t number = next.size();
+    const ThreadCode& code = m_threads[thread];
+    unsigned int pc = m_layout.Value(state, code.counter);
+    vector<PackedState> holding;
+    for(size_t i = code.first[pc]; i < code.first[pc + 1]; ++i)
+    {
+        const Transition& transition = m_transitions[i];
+        holding.clear();
+        SymbolicHolds(state, transition, holding);
+        for(size_t j = 0; j < holding.size(); ++j)
+        {
+            Operand source = Resolve(holding[j], transition.source);
+            if(transition.target != NoField && Undecided(holding[j], source) && !AliasNumber(transition.target, source.field))
+            {
+                // parameter, which target can't keep, is split to values
+                int min;
+                int max;
+                Bounds(holding[j], source.field, min, max);
+                for(int64_t value = min; value <= max; ++value)
+                {
+                    Operand constant = {NoField, int(value)};
+                    Narrow(holding[j], source.field, value, value, next);
+                    Assign(next.back(), thread, transition, constant);
+                }
+                continue;
+            }
+            next.push_back(holding[j]);
+            Assign(next.back(), thread, transition, source);
+        }
+    }
+    for(size_t i = number; i < next.size(); ++i)
+        Settle(next[i]);
+    return next.size() - number;
+}
+
+/**
+ * @brief prints number of removed transitions and ranges of variables,
+ * found before exploration
+ * @param stream - output stream
+ */
+void Program::PrintDomains(ostream& stream) const
+{
+    stream<<"Removed dead transitions: "<<m_removed<<endl;
+    for(size_t i = 0; i < m_layout.Fields(); ++i)
+    {
+        // uninitialized value takes one of values of variable
+        uint64_t values = m_layout.Values(i) - (m_layout.IsCounter(i) ? 0 : 1);
+        stream<<m_layout.Name(i)<<": ";
+        if(values == 0)
+            stream<<"never assigned";
+        else
+            stream<<m_layout.Min(i)<<".."<<int64_t(m_layout.Min(i)) + int64_t(values) - 1;
+        stream<<endl;
+    }
+    stream<<"Packed state words: "<<m_layout.Words()<<endl;
+}
+
+/**
+ * @brief makes program counters, where all steps access only variables of
+ * their thread, continuations of previous step
+ * @param breakpoints - comma separated list of thread:pc like "f:3,g:7",
+ * where other threads are scheduled anyway, thread is name of thread or
+ * of its function, NULL for none
+ * @return false if list is malformed or has unknown thread
+ */
+bool Program::FuseLocalSteps(const char* breakpoints)
+{
+    m_fused_points = 0;
+    for(size_t thread = 0; thread < m_threads.size(); ++thread)
+    {
+        ThreadCode& code = m_threads[thread];
+        uint64_t local = 0;
+        for(size_t i = 0; i < code.component.size(); ++i)
+            local |= uint64_t(1) << code.component[i];
+        // end and program counters without steps stay points of scheduling
+        code.fused.assign(code.end + 1, false);
+        for(unsigned int pc = 0; pc < code.end; ++pc)
+        {
+            bool fused = code.first[pc] < code.first[pc + 1];
+            for(size_t i = code.first[pc]; i < code.first[pc + 1] && fused; ++i)
+                fused = ((m_transitions[i].access.reads | m_transitions[i].access.writes) & ~local) == 0;
+            code.fused[pc] = fused;
+        }
+    }
+    while(breakpoints && *breakpoints)
+    {
+        const char* colon = strchr(breakpoints, ':');
+        if(!colon || colon == breakpoints)
+            return false;
+        string name(breakpoints, colon);
+        char* end;
+        long pc = strtol(colon + 1, &end, 10);
+        if(end == colon + 1 || pc < 0 || (*end != ',' && *end != '\0'))
+            return false;
+        bool found = false;
+        for(size_t thread = 0; thread < m_threads.size(); ++thread)
+        {
+            ThreadCode& code = m_threads[thread];
+            if(code.name != name && code.name.substr(0, code.name.find('[')) != name)
+                continue;
+            found = true;
+            if(size_t(pc) < code.fused.size())
+                code.fused[pc] = false;
+        }
+        if(!found)
+        {
+            cerr<<"Unknown thread "<<name<<" in breakpoints"<<endl;
+            return false;
+        }
+        breakpoints = *end ? end + 1 : end;
+    }
+    for(size_t thread = 0; thread < m_threads.size(); ++thread)
+        m_fused_points += count(m_threads[thread].fused.begin(), m_threads[thread].fused.end(), true);
+    return true;
+}
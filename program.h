@@ -0,0 +1,836 @@
+/******************************************************************************
+ * File: program.h
+ * Description: C program of several threads, compiled to table of transitions.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <deque>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "partial_order.h"
+#include "state_codec.h"
+
+/*
+ * Accepted subset of C:
+ *     int h, k = -1;                    global variables, optional constant
+ *                                       initializer, uninitialized otherwise
+ *     void f(int a, int b) { ... }      every function is thread, parameters
+ *                                       are constants, given to Load
+ * statements of function:
+ *     int x, y;                         local variables, uninitialized
+ *     x = 5;  x = y;  x = a;            assignment of constant, variable or
+ *                                       parameter
+ *     if (<cond>) <stmt> [else <stmt>]
+ *     while (<cond>) <stmt>
+ *     break;
+ *     { <stmt> ... }
+ * <cond> is <operand> [== != < > <= >= <operand>], operand alone is compared
+ * with 0. Comparison with uninitialized variable blocks thread.
+ * Every statement gets one value of program counter in order of text,
+ * value after last statement is end of thread.
+ * FuseLocalSteps makes large blocks: step, which accesses only variables
+ * of its thread, is done at once after previous step of thread, so it isn't
+ * separate point of scheduling.
+ * Before exploration values of variables are found by abstract
+ * interpretation of every function: transitions, which guards never hold,
+ * are removed, and ranges of variables are narrowed to found values.
+ * Function can be replicated to several threads f[0], f[1], ... with same
+ * code, values of parameters and own local variables. Replicas of function
+ * are interchangeable, so states, which differ only by permutation of them,
+ * are merged by Canonicalize.
+ * Parameters can be symbolic: every one is interval [min, max] in state,
+ * and SymbolicSteps splits interval only if guard depends on its value, so
+ * one exploration covers all values of parameters. Variable, assigned by
+ * parameter with several values, keeps number of parameter in field
+ * <variable>.alias instead of value, so it has interval of parameter, and
+ * guard of variable narrows parameter.
+ */
+
+/**
+ * @brief maximal number of threads of program
+ */
+const size_t MaxThreads = 32;
+
+/**
+ * @brief index of field, which means no field in operand or update
+ */
+const size_t NoField = ~size_t(0);
+
+/**
+ * @brief parses list of replicated functions like "worker=4,f=2"
+ * @param list - comma separated list of function=count, count > 0
+ * @param replicas - place for numbers of threads of functions
+ * @return false if list is malformed
+ */
+bool ParseReplicas(const char* list, std::map<std::string, size_t>& replicas);
+
+/**
+ * @brief range of values of symbolic parameters
+ */
+struct ParameterRange
+{
+    int min;
+    int max;
+};
+
+/**
+ * @brief comparison of guard, OP_TRUE is guard of unconditional transition
+ */
+enum Comparison
+{
+    OP_TRUE,
+    OP_EQUAL,
+    OP_NOT_EQUAL,
+    OP_LESS,
+    OP_GREATER,
+    OP_LESS_EQUAL,
+    OP_GREATER_EQUAL
+};
+
+/**
+ * @brief operand of guard or update: field of packed state or constant
+ */
+struct Operand
+{
+/**
+ * @brief index of field, NoField for constant
+ */
+    size_t field;
+/**
+ * @brief value of constant
+ */
+    int value;
+};
+
+/**
+ * @brief one transition of thread: if guard holds at program counter pc,
+ * update is done and program counter gets next
+ */
+struct Transition
+{
+/**
+ * @brief comparison of guard
+ */
+    Comparison comparison;
+/**
+ * @brief left operand of guard
+ */
+    Operand left;
+/**
+ * @brief right operand of guard
+ */
+    Operand right;
+/**
+ * @brief field, assigned by update, NoField if transition doesn't assign
+ */
+    size_t target;
+/**
+ * @brief assigned value
+ */
+    Operand source;
+/**
+ * @brief value of program counter before transition
+ */
+    unsigned int pc;
+/**
+ * @brief value of program counter after transition
+ */
+    unsigned int next;
+/**
+ * @brief text of step, for example "x=6;" or "!(y>2);"
+ */
+    const char* label;
+/**
+ * @brief line of statement in program text
+ */
+    int line;
+/**
+ * @brief variables, read and written by transition
+ */
+    Access access;
+};
+
+/**
+ * @brief threads of C program and their transitions. Program is parsed once,
+ * its variables get fields of packed state with ranges of assigned values,
+ * and exploration steps threads by table of transitions.
+ */
+class Program
+{
+public:
+/**
+ * @brief class constructor, makes empty program
+ */
+    Program();
+
+/**
+ * @brief class destructor
+ */
+    ~Program();
+
+/**
+ * @brief parses program and compiles it to transitions, prints error to cerr
+ * @param filename - name of file with program
+ * @param arguments - values of parameters of all functions in order of text,
+ * missing ones are 0
+ * @param replicas - numbers of threads of functions, 1 for missing ones
+ * @param symbolic - range of values of all parameters, which become
+ * intervals in state, NULL to use arguments
+ * @return false if file can't be read or program isn't accepted
+ */
+    bool Load(const char* filename, const std::vector<int>& arguments,
+              const std::map<std::string, size_t>& replicas = std::map<std::string, size_t>(),
+              const ParameterRange* symbolic = NULL);
+
+/**
+ * @brief placement of variables in packed state: counters of threads, global
+ * variables, local variables of threads
+ */
+    const StateLayout& Layout() const
+    {
+        return m_layout;
+    }
+
+/**
+ * @brief number of threads
+ */
+    size_t Threads() const
+    {
+        return m_threads.size();
+    }
+
+/**
+ * @brief name of thread, name of its function with index of replica
+ * @param thread - number of thread
+ */
+    const char* ThreadName(size_t thread) const
+    {
+        return m_threads[thread].name.c_str();
+    }
+
+/**
+ * @brief value of program counter after last statement of thread
+ * @param thread - number of thread
+ */
+    unsigned int End(size_t thread) const
+    {
+        return m_threads[thread].end;
+    }
+
+/**
+ * @brief value of program counter of thread
+ * @param state - packed state
+ * @param thread - number of thread
+ */
+    unsigned int Pc(const PackedState& state, size_t thread) const
+    {
+        return m_layout.Value(state, m_threads[thread].counter);
+    }
+
+/**
+ * @brief makes initial state: zero counters, initialized global variables
+ * @param state - place for state
+ */
+    void Initial(PackedState& state) const;
+
+/**
+ * @brief checks if program has interchangeable replicas of functions
+ */
+    bool Symmetric() const
+    {
+        return !m_symmetries.empty();
+    }
+
+/**
+ * @brief sorts local states of replicas of every function, so states, which
+ * differ by permutation of replicas, become equal
+ * @param state - packed state, changed in place
+ */
+    void Canonicalize(PackedState& state) const;
+
+/**
+ * @brief transition, which thread can do from state
+ * @param state - packed state
+ * @param thread - number of thread
+ * @return NULL if thread is finished or blocked
+ */
+    const Transition* Enabled(const PackedState& state, size_t thread) const
+    {
+        const ThreadCode& code = m_threads[thread];
+        unsigned int pc = m_layout.Value(state, code.counter);
+        // guards of one program counter exclude each other
+        for(size_t i = code.first[pc]; i < code.first[pc + 1]; ++i)
+            if(Holds(state, m_transitions[i]))
+                return &m_transitions[i];
+        return NULL;
+    }
+
+/**
+ * @brief do step by thread
+ * @param state - packed state, changed in place
+ * @param thread - number of thread
+ * @return done transition, NULL if thread is finished or blocked
+ */
+    const Transition* Step(PackedState& state, size_t thread) const
+    {
+        const Transition* transition = Enabled(state, thread);
+        if(!transition)
+            return NULL;
+        Update(state, thread, *transition);
+        return transition;
+    }
+
+/**
+ * @brief makes dead local variables of thread uninitialized, so states,
+ * which differ only by them, become equal. Dead variable is assigned before
+ * any read on every path from program counter of thread.
+ * @param state - packed state, changed in place
+ * @param thread - number of thread
+ * @param kept - mask of fields, which aren't reset even if dead
+ */
+    void ResetDead(PackedState& state, size_t thread, const PackedState& kept) const
+    {
+        const PackedState& live = m_threads[thread].live[Pc(state, thread)];
+        for(size_t i = 0; i < m_layout.Words(); ++i)
+            state.words[i] &= live.words[i] | kept.words[i];
+    }
+
+/**
+ * @brief checks if field is local variable, which is dead at some program
+ * counter of its thread
+ * @param field - index of field
+ */
+    bool Resettable(size_t field) const
+    {
+        return (m_resettable >> field) & 1;
+    }
+
+/**
+ * @brief checks if parameters are intervals, so SymbolicSteps is used
+ * instead of Step
+ */
+    bool Symbolic() const
+    {
+        return !m_parameters.empty();
+    }
+
+/**
+ * @brief lower bound fields of symbolic parameters, upper bound is next field
+ */
+    const std::vector<size_t>& Parameters() const
+    {
+        return m_parameters;
+    }
+
+/**
+ * @brief value of symbolic parameter, given by arguments of Load, 0 for
+ * missing one
+ * @param index - index of parameter in Parameters()
+ */
+    int ParameterValue(size_t index) const
+    {
+        return m_parameter_values[index];
+    }
+
+/**
+ * @brief interval of symbolic parameter
+ * @param state - packed state
+ * @param field - lower bound field of parameter
+ * @param min - place for lower bound
+ * @param max - place for upper bound
+ */
+    void Bounds(const PackedState& state, size_t field, int& min, int& max) const
+    {
+        min = m_layout.Value(state, field);
+        max = m_layout.Value(state, field + 1);
+    }
+
+/**
+ * @brief makes successors of state by step of thread, where parameters are
+ * intervals: state is split only if guard can't be decided, assigned
+ * variable keeps number of parameter with several values
+ * @param state - packed state
+ * @param thread - number of thread
+ * @param next - place for successors, they are added
+ * @return number of added successors
+ */
+    size_t SymbolicSteps(const PackedState& state, size_t thread, std::vector<PackedState>& next) const;
+
+/**
+ * @brief replaces numbers of parameters, which have one value, by value,
+ * so equal states have one form, for example after parameters are set to
+ * values of one input
+ * @param state - packed state, changed in place
+ */
+    void Settle(PackedState& state) const;
+
+/**
+ * @brief do step by thread and following steps, which are fused with it
+ * by FuseLocalSteps
+ * @param state - packed state, changed in place
+ * @param thread - number of thread
+ * @return first done transition, NULL if thread is finished or blocked
+ */
+    const Transition* StepBlock(PackedState& state, size_t thread) const
+    {
+        const Transition* transition = Step(state, thread);
+        const ThreadCode& code = m_threads[thread];
+        if(!transition || code.fused.empty())
+            return transition;
+        // loop of local steps is cut after number of program counters
+        for(unsigned int i = 0; i <= code.end && code.fused[Pc(state, thread)]; ++i)
+            if(!Step(state, thread))
+                break;
+        return transition;
+    }
+
+/**
+ * @brief makes program counters, where all steps access only variables of
+ * their thread, continuations of previous step
+ * @param breakpoints - comma separated list of thread:pc like "f:3,g:7",
+ * where other threads are scheduled anyway, thread is name of thread or
+ * of its function, NULL for none
+ * @return false if list is malformed or has unknown thread
+ */
+    bool FuseLocalSteps(const char* breakpoints);
+
+/**
+ * @brief number of program counters of all threads, which are fused
+ */
+    size_t FusedPoints() const
+    {
+        return m_fused_points;
+    }
+
+/**
+ * @brief variables, accessed by step of thread from state
+ * @param state - packed state
+ * @param thread - number of thread
+ */
+    const Access& Current(const PackedState& state, size_t thread) const
+    {
+        return m_threads[thread].access->Current(Pc(state, thread));
+    }
+
+/**
+ * @brief variables, accessed by all steps, which thread can do from state
+ * @param state - packed state
+ * @param thread - number of thread
+ */
+    const Access& Future(const PackedState& state, size_t thread) const
+    {
+        return m_threads[thread].access->Future(Pc(state, thread));
+    }
+
+/**
+ * @brief number of transitions of all threads
+ */
+    size_t Transitions() const
+    {
+        return m_transitions.size();
+    }
+
+/**
+ * @brief transition by index, transitions are sorted by thread and program
+ * counter
+ * @param index - index of transition
+ */
+    const Transition& GetTransition(size_t index) const
+    {
+        return m_transitions[index];
+    }
+
+/**
+ * @brief index of transition, returned by Step
+ * @param transition - transition of program
+ */
+    size_t TransitionIndex(const Transition& transition) const
+    {
+        return &transition - &m_transitions[0];
+    }
+
+/**
+ * @brief index of first transition of program counter of thread, transitions
+ * of pc are from First(thread, pc) to First(thread, pc + 1)
+ * @param thread - number of thread
+ * @param pc - value of program counter, not more than End(thread)
+ */
+    size_t First(size_t thread, unsigned int pc) const
+    {
+        return m_threads[thread].first[pc];
+    }
+
+/**
+ * @brief number of transitions of functions, which are removed before
+ * exploration, because their guards never hold
+ */
+    size_t Removed() const
+    {
+        return m_removed;
+    }
+
+/**
+ * @brief prints number of removed transitions and ranges of variables,
+ * found before exploration
+ * @param stream - output stream
+ */
+    void PrintDomains(std::ostream& stream) const;
+
+/**
+ * @brief index of program counter field of thread
+ * @param thread - number of thread
+ */
+    size_t CounterField(size_t thread) const
+    {
+        return m_threads[thread].counter;
+    }
+private:
+/**
+ * @brief compiled code of one thread
+ */
+    struct ThreadCode
+    {
+/**
+ * @brief name of function
+ */
+        std::string name;
+/**
+ * @brief index of program counter field
+ */
+        size_t counter;
+/**
+ * @brief value of program counter after last statement
+ */
+        unsigned int end;
+/**
+ * @brief transitions of program counter pc are from first[pc] to
+ * first[pc + 1], end has no transitions
+ */
+        std::vector<size_t> first;
+/**
+ * @brief variables, accessed by statements of thread
+ */
+        ThreadAccess* access;
+/**
+ * @brief fields of local state of thread: counter and local variables
+ */
+        std::vector<size_t> component;
+/**
+ * @brief masks of fields, which aren't dead local variables of thread, by
+ * program counter
+ */
+        std::vector<PackedState> live;
+/**
+ * @brief flags of program counters, which are fused with previous step,
+ * empty if steps aren't fused
+ */
+        std::vector<bool> fused;
+    };
+
+/**
+ * @brief field of variable, which keeps number of parameter, whose value
+ * variable has, 0 if variable has own value
+ */
+    struct Alias
+    {
+/**
+ * @brief index of field, NoField if variable can't have value of parameter
+ */
+        size_t field;
+/**
+ * @brief index in m_parameters of parameter number 1, parameters of thread
+ * are numbered from its first one, so replicas are permuted with them
+ */
+        size_t base;
+/**
+ * @brief number of parameters, which variable can keep
+ */
+        size_t count;
+/**
+ * @brief flag, indicates if variable is global, so it isn't permuted with
+ * replicas and can't keep their parameters
+ */
+        bool global;
+    };
+
+/**
+ * @brief replicas of one function, which are permuted by Canonicalize
+ */
+    struct Symmetry
+    {
+/**
+ * @brief numbers of threads
+ */
+        std::vector<size_t> threads;
+/**
+ * @brief numbers of bits of fields of local state, fields are same for all
+ * replicas
+ */
+        std::vector<unsigned int> widths;
+/**
+ * @brief length of local state of one replica in bits, not more than 64
+ */
+        unsigned int bits;
+    };
+
+/**
+ * @brief local state of thread as one number, fields are concatenated
+ * @param state - packed state
+ * @param thread - number of thread
+ * @param symmetry - group of thread
+ */
+    uint64_t Component(const PackedState& state, size_t thread, const Symmetry& symmetry) const;
+
+/**
+ * @brief writes local state of thread, made by Component
+ * @param state - packed state
+ * @param thread - number of thread
+ * @param symmetry - group of thread
+ * @param component - local state
+ */
+    void SetComponent(PackedState& state, size_t thread, const Symmetry& symmetry, uint64_t component) const;
+
+/**
+ * @brief does update of transition and moves program counter
+ * @param state - packed state, changed in place
+ * @param thread - number of thread
+ * @param transition - transition, which guard holds
+ */
+    void Update(PackedState& state, size_t thread, const Transition& transition) const
+    {
+        if(transition.target != NoField)
+        {
+            const Operand& source = transition.source;
+            if(source.field == NoField)
+                m_layout.Set(state, transition.target, source.value);
+            else
+                m_layout.Copy(state, transition.target, source.field);
+        }
+        m_layout.Set(state, m_threads[thread].counter, int(transition.next));
+    }
+
+/**
+ * @brief checks if operand is symbolic parameter with several values
+ * @param state - packed state
+ * @param operand - operand
+ */
+    bool Undecided(const PackedState& state, const Operand& operand) const
+    {
+        return operand.field != NoField && (m_parameter_mask >> operand.field & 1) &&
+               m_layout.Value(state, operand.field) != m_layout.Value(state, operand.field + 1);
+    }
+
+/**
+ * @brief operand, which is read instead of variable: lower bound field of
+ * parameter, whose value variable has, or variable itself
+ * @param state - packed state
+ * @param operand - operand
+ */
+    Operand Resolve(const PackedState& state, const Operand& operand) const
+    {
+        if(operand.field == NoField || m_aliases.empty())
+            return operand;
+        const Alias& alias = m_aliases[operand.field];
+        if(alias.field == NoField || !m_layout.IsInit(state, alias.field) || m_layout.Value(state, alias.field) == 0)
+            return operand;
+        Operand parameter = {m_parameters[alias.base + m_layout.Value(state, alias.field) - 1], 0};
+        return parameter;
+    }
+
+/**
+ * @brief number of parameter, which variable can keep instead of value
+ * @param target - assigned variable
+ * @param parameter - lower bound field of parameter
+ * @return 0 if parameter isn't kept by variable
+ */
+    size_t AliasNumber(size_t target, size_t parameter) const;
+
+/**
+ * @brief does assignment and step of program counter, variable keeps number
+ * of parameter with several values
+ * @param state - packed state, changed in place
+ * @param thread - number of thread
+ * @param transition - transition, which guard holds
+ * @param source - resolved source of assignment
+ */
+    void Assign(PackedState& state, size_t thread, const Transition& transition, const Operand& source) const;
+
+/**
+ * @brief states, where comparison of resolved operands holds, parameters
+ * are narrowed
+ * @param state - packed state
+ * @param left - left operand
+ * @param comparison - comparison
+ * @param right - right operand
+ * @param next - place for states
+ */
+    void SymbolicCompare(const PackedState& state, Operand left, Comparison comparison, Operand right,
+                         std::vector<PackedState>& next) const;
+
+/**
+ * @brief narrows interval of parameter, bounds are cut to its range
+ * @param state - packed state
+ * @param field - lower bound field of parameter
+ * @param min - lower bound
+ * @param max - upper bound
+ * @param next - place for narrowed state, added if interval isn't empty
+ */
+    void Narrow(const PackedState& state, size_t field, int64_t min, int64_t max, std::vector<PackedState>& next) const;
+
+/**
+ * @brief states, where guard of transition holds, parameters of guard are
+ * narrowed
+ * @param state - packed state
+ * @param transition - transition
+ * @param next - place for states
+ */
+    void SymbolicHolds(const PackedState& state, const Transition& transition, std::vector<PackedState>& next) const;
+
+/**
+ * @brief value of operand in state
+ * @param state - packed state
+ * @param operand - operand
+ * @param value - place for value
+ * @return false if operand is uninitialized variable
+ */
+    bool Read(const PackedState& state, const Operand& operand, int& value) const
+    {
+        if(operand.field == NoField)
+        {
+            value = operand.value;
+            return true;
+        }
+        if(!m_layout.IsInit(state, operand.field))
+            return false;
+        value = m_layout.Value(state, operand.field);
+        return true;
+    }
+
+/**
+ * @brief checks if guard of transition holds in state
+ * @param state - packed state
+ * @param transition - transition
+ */
+    bool Holds(const PackedState& state, const Transition& transition) const
+    {
+        if(transition.comparison == OP_TRUE)
+            return true;
+        int left;
+        int right;
+        if(!Read(state, transition.left, left) || !Read(state, transition.right, right))
+            return false;
+        switch(transition.comparison)
+        {
+            case OP_EQUAL:
+                return left == right;
+            case OP_NOT_EQUAL:
+                return left != right;
+            case OP_LESS:
+                return left < right;
+            case OP_GREATER:
+                return left > right;
+            case OP_LESS_EQUAL:
+                return left <= right;
+            case OP_GREATER_EQUAL:
+                return left >= right;
+            default:
+                return true;
+        }
+    }
+
+/**
+ * @brief removes compiled program
+ */
+    void Clear();
+
+/**
+ * @brief placement of variables in packed state
+ */
+    StateLayout m_layout;
+
+/**
+ * @brief names of fields, used by layout
+ */
+    std::vector<std::string> m_names;
+
+/**
+ * @brief initial values of global variables, field and value
+ */
+    std::vector<Operand> m_initial;
+
+/**
+ * @brief code of threads
+ */
+    std::vector<ThreadCode> m_threads;
+
+/**
+ * @brief transitions of all threads, sorted by thread and program counter
+ */
+    std::vector<Transition> m_transitions;
+
+/**
+ * @brief texts of steps, used by transitions
+ */
+    std::deque<std::string> m_labels;
+
+/**
+ * @brief groups of interchangeable threads
+ */
+    std::vector<Symmetry> m_symmetries;
+
+/**
+ * @brief lower bound fields of symbolic parameters
+ */
+    std::vector<size_t> m_parameters;
+
+/**
+ * @brief values of symbolic parameters from arguments
+ */
+    std::vector<int> m_parameter_values;
+
+/**
+ * @brief bits of lower bound fields of symbolic parameters
+ */
+    uint64_t m_parameter_mask;
+
+/**
+ * @brief bits of lower bound fields of parameters of replicated functions,
+ * they aren't kept by global variables, which aren't permuted
+ */
+    uint64_t m_replicated_parameters;
+
+/**
+ * @brief alias of every field, empty if parameters aren't symbolic
+ */
+    std::vector<Alias> m_aliases;
+
+/**
+ * @brief number of removed transitions
+ */
+    size_t m_removed;
+
+/**
+ * @brief bits of fields, which are dead somewhere
+ */
+    uint64_t m_resettable;
+
+/**
+ * @brief number of fused program counters
+ */
+    size_t m_fused_points;
+
+    friend class ProgramCompiler;
+// Copy isn't allowed
+    Program(Program&);
+    Program& operator=(Program&);
+};
+
+#endif //PROGRAM_H
@@ -0,0 +1,97 @@
+#!/bin/sh
+# Regression checks of state_maker and state_maker_v2, built as in README.
+# Usage: sh regression.sh [directory of binaries], run from directory of sources.
+BIN=${1:-.}
+FAILED=0
+
+# expect <status> <binary> <arguments...>: binary should exit with status
+expect()
+{
+    status=$1
+    shift
+    "$BIN/$@" > regression.out 2>&1
+    result=$?
+    if [ $result -ne $status ]
+    then
+        echo "FAILED (status $result instead of $status): $*"
+        FAILED=1
+    fi
+}
+
+# -check turns off reductions and projection, so every violation is found
+for binary in state_maker state_maker_v2
+do
+    expect 1 $binary 0 0 0 0 -program check_blocks.txt -check 'f.x==# || f.x!=6' -blocks -file regression.txt
+    expect 1 $binary 1 2 3 4 -check 'f.x==# || f.x!=5' -liveness -file regression.txt
+    expect 1 $binary 0 0 0 0 -replicate f=2 -symmetry -check 'f[0].counter==0 || f[1].counter!=0' -file regression.txt
+    expect 1 $binary 0 0 0 0 -program check_project.txt -check 'f.x==# || f.x!=1' -project f.counter,g.counter,h -file regression.txt
+    expect 0 $binary 1 2 3 4 -check 'h==# || h<100' -file regression.txt
+done
+rm -f regression.txt
+
+# any number of values, negative ones too, are given to parameters in order of text
+for binary in state_maker state_maker_v2
+do
+    expect 1 $binary -3 5 -program sweep.txt -check 'h!=-3' -file regression.txt
+    expect 0 $binary 3 5 0 7 -program sweep.txt -check 'h!=-3' -file regression.txt
+done
+rm -f regression.txt
+
+# table, shared by -threads, stores states exactly
+for binary in state_maker state_maker_v2
+do
+    expect 1 $binary 1 2 3 4 -threads 2 -bitstate 1 -file regression.txt
+    expect 1 $binary 1 2 3 4 -threads 2 -compact 32 -file regression.txt
+done
+rm -f regression.txt
+
+# errors in atoms of formula name formula, not invariant
+expect 1 state_maker 1 2 3 4 -ltl 'G (h ==)'
+if ! grep -q "at '' in LTL formula" regression.out
+then
+    echo "FAILED: error in atom of -ltl doesn't name LTL formula"
+    FAILED=1
+fi
+
+# steps of model, compiled from task.txt 0 0 0 0, give same states as table
+for flags in "" "-bfs" "-threads 2"
+do
+    "$BIN/state_maker" 0 0 0 0 $flags -count -file regression.txt > regression.out 2>&1
+    sort regression.txt >> regression.out
+    "$BIN/state_maker_model" $flags -count -file regression.txt > regression.model 2>&1
+    sort regression.txt >> regression.model
+    if ! cmp -s regression.out regression.model
+    then
+        echo "FAILED: states of state_maker_model $flags differ from state_maker"
+        FAILED=1
+    fi
+done
+expect 1 state_maker_model 1 2 3 4 -file regression.txt
+rm -f regression.txt regression.model
+
+# tuples of -sweep-merge have same states as tuples, explored one by one
+"$BIN/state_maker" 0 0 0 0 -program sweep.txt -sweep f.a=0..2,f.b=0..2,g.a=0..1 > regression.sweep 2>&1
+"$BIN/state_maker" 0 0 0 0 -program sweep.txt -sweep f.a=0..2,f.b=0..2,g.a=0..1 -sweep-merge > regression.merge 2>&1
+if ! cmp -s regression.sweep regression.merge
+then
+    echo "FAILED: table of -sweep-merge differs from -sweep on sweep.txt"
+    FAILED=1
+fi
+rm -f regression.sweep regression.merge
+
+# broken binary file is rejected by state_query with status 1
+"$BIN/state_maker" 1 2 3 4 -dump regression.bin > /dev/null 2>&1
+expect 0 state_query regression.bin -count
+printf '\377\377\377\377\377\377\377\377' | dd of=regression.bin bs=1 seek=30 conv=notrunc 2> /dev/null
+expect 1 state_query regression.bin -count
+"$BIN/state_maker" 1 2 3 4 -dump regression.bin > /dev/null 2>&1
+dd if=/dev/null of=regression.bin bs=1 seek=$(($(wc -c < regression.bin) - 5)) 2> /dev/null
+expect 1 state_query regression.bin -count
+rm -f regression.bin
+
+rm -f regression.out
+if [ $FAILED -eq 0 ]
+then
+    echo "All regression checks passed"
+fi
+exit $FAILED
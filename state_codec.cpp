@@ -0,0 +1,205 @@
+/******************************************************************************
+ * File: state_codec.cpp
+ * Description: packing of program states into machine words.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "state_codec.h"
+#include "output_writer.h"
+#include <string.h>
+#include <string>
+using namespace std;
+
+/**
+ * @brief number of bits in word of packed state
+ */
+const unsigned int WordBits = 64;
+
+/**
+ * @brief number of bits, needed to store values from 0 to range
+ * @param range - maximal value
+ */
+static unsigned int BitsFor(uint64_t range)
+{
+    unsigned int bits = 0;
+    while(bits < WordBits && (range >> bits) != 0)
+        ++bits;
+    return bits;
+}
+
+/**
+ * @brief class constructor, makes empty layout
+ */
+StateLayout::StateLayout(): m_fields()
+                          , m_words(0)
+                          , m_bits(WordBits)
+{
+}
+
+/**
+ * @brief adds program counter field
+ * @param name - name of field
+ * @param max - maximal value of counter
+ * @return index of field
+ */
+size_t StateLayout::AddCounter(const char* name, unsigned int max)
+{
+    return AddField(name, BitsFor(max), 0, false, uint64_t(max) + 1);
+}
+
+/**
+ * @brief adds variable field
+ * @param name - name of field
+ * @param min - minimal value of variable
+ * @param max - maximal value of variable
+ * @return index of field
+ */
+size_t StateLayout::AddVariable(const char* name, int min, int max)
+{
+    assert(min <= max);
+    uint64_t range = uint64_t(int64_t(max) - min);
+    // values from min to max and uninitialized value
+    return AddField(name, 1 + BitsFor(range), min, true, range + 2);
+}
+
+/**
+ * @brief adds field with specified number of bits
+ * @param name - name of field
+ * @param bits - number of bits
+ * @param min - minimal value
+ * @param flag - indicates if field has init flag
+ * @param values - number of values of field
+ * @return index of field
+ */
+size_t StateLayout::AddField(const char* name, unsigned int bits, int min, bool flag, uint64_t values)
+{
+    if(bits == 0)
+        bits = 1;
+    if(m_bits + bits > WordBits)
+    {
+        // field doesn't fit in last word
+        // layout, which doesn't fit in packed state, is rejected by
+        // caller, which checks Words()
+        ++m_words;
+        m_bits = 0;
+    }
+    Field field;
+    field.name = name;
+    field.word = m_words - 1;
+    field.shift = m_bits;
+    field.mask = bits == WordBits ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    field.min = min;
+    field.flag = flag;
+    field.values = values;
+    m_fields.push_back(field);
+    m_bits += bits;
+    return m_fields.size() - 1;
+}
+
+/**
+ * @brief finds field by name
+ * @param name - name of field
+ * @param field - place for index of field
+ * @return true if field is found
+ */
+bool StateLayout::Find(const char* name, size_t& field) const
+{
+    for(size_t i = 0; i < m_fields.size(); ++i)
+    {
+        if(strcmp(m_fields[i].name, name) == 0)
+        {
+            field = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief finds fields by comma separated list of names
+ * @param list - list of names, for example "f.counter,g.counter,h"
+ * @param fields - place for indexes of fields
+ * @return true if all names are found
+ */
+bool StateLayout::Find(const char* list, vector<size_t>& fields) const
+{
+    fields.clear();
+    string names(list);
+    size_t begin = 0;
+    while(begin <= names.size())
+    {
+        size_t end = names.find(',', begin);
+        if(end == string::npos)
+            end = names.size();
+        size_t field;
+        if(!Find(names.substr(begin, end - begin).c_str(), field))
+            return false;
+        fields.push_back(field);
+        begin = end + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief makes state with zero counters and uninitialized variables
+ * @param state - state to clear
+ */
+void StateLayout::Clear(PackedState& state) const
+{
+    memset(state.words, 0, sizeof(state.words));
+}
+
+/**
+ * @brief makes mask, which selects specified fields
+ * @param fields - indexes of fields
+ * @param mask - place for mask
+ */
+void StateLayout::Mask(const vector<size_t>& fields, PackedState& mask) const
+{
+    Clear(mask);
+    for(size_t i = 0; i < fields.size(); ++i)
+    {
+        const Field& desc = m_fields[fields[i]];
+        mask.words[desc.word] |= desc.mask << desc.shift;
+    }
+}
+
+/**
+ * @brief prints all fields in order of adding
+ * @param stream - output stream
+ * @param state - packed state
+ * @param separator - string between fields
+ */
+void StateLayout::Print(ostream& stream, const PackedState& state, const char* separator) const
+{
+    for(size_t i = 0; i < m_fields.size(); ++i)
+    {
+        if(i != 0)
+            stream<<separator;
+        if(IsInit(state, i))
+            stream<<Value(state, i);
+        else
+            stream<<"#";
+    }
+}
+
+/**
+ * @brief appends all fields in order of adding to text, as Print to stream
+ * @param text - text to append
+ * @param state - packed state
+ * @param separator - string between fields
+ */
+void StateLayout::Print(string& text, const PackedState& state, const char* separator) const
+{
+    for(size_t i = 0; i < m_fields.size(); ++i)
+    {
+        if(i != 0)
+            text += separator;
+        if(IsInit(state, i))
+            AppendNumber(text, Value(state, i));
+        else
+            text += '#';
+    }
+}
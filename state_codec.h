@@ -0,0 +1,346 @@
+/******************************************************************************
+ * File: state_codec.h
+ * Description: packing of program states into machine words.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef STATE_CODEC_H
+#define STATE_CODEC_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+/**
+ * @brief maximal number of machine words in packed state
+ */
+const size_t MaxStateWords = 2;
+
+/**
+ * @brief state of whole program, packed by StateLayout.
+ * Words, unused by layout, are always zero.
+ */
+struct PackedState
+{
+    uint64_t words[MaxStateWords];
+};
+
+/**
+ * @brief leaves in state only bits, selected by mask
+ * @param state - packed state
+ * @param mask - mask of fields
+ * @param key - place for result
+ */
+inline void MaskState(const PackedState& state, const PackedState& mask, PackedState& key)
+{
+    for(size_t i = 0; i < MaxStateWords; ++i)
+        key.words[i] = state.words[i] & mask.words[i];
+}
+
+/**
+ * @brief multiplier of Fibonacci hashing, 2^64 divided by golden ratio
+ */
+const uint64_t HashMultiplier = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * @brief calculates Fibonacci hash of key, hash is rotated before every
+ * next word, so equal words at different places give different hashes.
+ * High bits are mixed best, tables take slots from them.
+ * @param key - pointer to key words
+ * @param words - number of key words, at least one
+ */
+inline uint64_t HashWords(const uint64_t* key, size_t words)
+{
+    uint64_t hash = key[0] * HashMultiplier;
+    for(size_t i = 1; i < words; ++i)
+        hash = ((hash << 29 | hash >> 35) ^ key[i]) * HashMultiplier;
+    return hash;
+}
+
+/**
+ * @brief describes placement of program variables in packed state.
+ * Counter field stores value as is. Variable field stores init flag in
+ * lowest bit and offset of value from minimal one in other bits, so
+ * state of zero words has all counters zero and all variables
+ * uninitialized. Field never crosses word boundary.
+ */
+class StateLayout
+{
+public:
+/**
+ * @brief class constructor, makes empty layout
+ */
+    StateLayout();
+
+/**
+ * @brief adds program counter field
+ * @param name - name of field
+ * @param max - maximal value of counter
+ * @return index of field
+ */
+    size_t AddCounter(const char* name, unsigned int max);
+
+/**
+ * @brief adds variable field
+ * @param name - name of field
+ * @param min - minimal value of variable
+ * @param max - maximal value of variable
+ * @return index of field
+ */
+    size_t AddVariable(const char* name, int min, int max);
+
+/**
+ * @brief number of used words in packed state, layout is usable only if
+ * it isn't more than MaxStateWords
+ */
+    size_t Words() const
+    {
+        return m_words;
+    }
+
+/**
+ * @brief number of fields
+ */
+    size_t Fields() const
+    {
+        return m_fields.size();
+    }
+
+/**
+ * @brief name of field
+ * @param field - index of field
+ */
+    const char* Name(size_t field) const
+    {
+        return m_fields[field].name;
+    }
+
+/**
+ * @brief finds field by name
+ * @param name - name of field
+ * @param field - place for index of field
+ * @return true if field is found
+ */
+    bool Find(const char* name, size_t& field) const;
+
+/**
+ * @brief finds fields by comma separated list of names
+ * @param list - list of names, for example "f.counter,g.counter,h"
+ * @param fields - place for indexes of fields
+ * @return true if all names are found
+ */
+    bool Find(const char* list, std::vector<size_t>& fields) const;
+
+/**
+ * @brief makes state with zero counters and uninitialized variables
+ * @param state - state to clear
+ */
+    void Clear(PackedState& state) const;
+
+/**
+ * @brief checks if field is program counter without init flag
+ * @param field - index of field
+ */
+    bool IsCounter(size_t field) const
+    {
+        return !m_fields[field].flag;
+    }
+
+/**
+ * @brief minimal value of field
+ * @param field - index of field
+ */
+    int Min(size_t field) const
+    {
+        return m_fields[field].min;
+    }
+
+/**
+ * @brief number of values of field, uninitialized value is counted too
+ * @param field - index of field
+ */
+    uint64_t Values(size_t field) const
+    {
+        return m_fields[field].values;
+    }
+
+/**
+ * @brief word of packed state, which holds field
+ * @param field - index of field
+ */
+    size_t Word(size_t field) const
+    {
+        return m_fields[field].word;
+    }
+
+/**
+ * @brief position of lowest bit of field in its word
+ * @param field - index of field
+ */
+    unsigned int Shift(size_t field) const
+    {
+        return m_fields[field].shift;
+    }
+
+/**
+ * @brief mask of raw bits of field, shifted to lowest bits: variable stores
+ * init flag in lowest bit and offset from minimal value in other bits
+ * @param field - index of field
+ */
+    uint64_t RawMask(size_t field) const
+    {
+        return m_fields[field].mask;
+    }
+
+/**
+ * @brief number of value of field from 0 to Values(field) - 1,
+ * uninitialized variable has number 0
+ * @param state - packed state
+ * @param field - index of field
+ */
+    uint64_t Digit(const PackedState& state, size_t field) const
+    {
+        const Field& desc = m_fields[field];
+        uint64_t raw = (state.words[desc.word] >> desc.shift) & desc.mask;
+        if(desc.flag && (raw & 1))
+            return (raw >> 1) + 1;
+        return desc.flag ? 0 : raw;
+    }
+
+/**
+ * @brief checks if field is initialized, counters are always initialized
+ * @param state - packed state
+ * @param field - index of field
+ */
+    bool IsInit(const PackedState& state, size_t field) const
+    {
+        const Field& desc = m_fields[field];
+        return !desc.flag || ((state.words[desc.word] >> desc.shift) & 1);
+    }
+
+/**
+ * @brief value of initialized field
+ * @param state - packed state
+ * @param field - index of field
+ */
+    int Value(const PackedState& state, size_t field) const
+    {
+        const Field& desc = m_fields[field];
+        uint64_t raw = (state.words[desc.word] >> desc.shift) & desc.mask;
+        if(desc.flag)
+            raw >>= 1;
+        return int(int64_t(raw) + desc.min);
+    }
+
+/**
+ * @brief sets value of field in place
+ * @param state - packed state
+ * @param field - index of field
+ * @param value - new value, should be in range of field
+ */
+    void Set(PackedState& state, size_t field, int value) const
+    {
+        const Field& desc = m_fields[field];
+        uint64_t raw = uint64_t(int64_t(value) - desc.min);
+        if(desc.flag)
+            raw = raw << 1 | 1;
+        assert(value >= desc.min && raw <= desc.mask && "value out of field range");
+        uint64_t& word = state.words[desc.word];
+        word = (word & ~(desc.mask << desc.shift)) | (raw << desc.shift);
+    }
+
+/**
+ * @brief copies value of field to other field, uninitialized value too
+ * @param state - packed state
+ * @param target - index of assigned field
+ * @param source - index of copied field
+ */
+    void Copy(PackedState& state, size_t target, size_t source) const
+    {
+        if(IsInit(state, source))
+            Set(state, target, Value(state, source));
+        else
+            Reset(state, target);
+    }
+
+/**
+ * @brief makes variable uninitialized
+ * @param state - packed state
+ * @param field - index of field
+ */
+    void Reset(PackedState& state, size_t field) const
+    {
+        const Field& desc = m_fields[field];
+        assert(desc.flag && "counter can't be uninitialized");
+        state.words[desc.word] &= ~(desc.mask << desc.shift);
+    }
+
+/**
+ * @brief makes mask, which selects specified fields
+ * @param fields - indexes of fields
+ * @param mask - place for mask
+ */
+    void Mask(const std::vector<size_t>& fields, PackedState& mask) const;
+
+/**
+ * @brief prints all fields in order of adding
+ * @param stream - output stream
+ * @param state - packed state
+ * @param separator - string between fields
+ */
+    void Print(std::ostream& stream, const PackedState& state, const char* separator) const;
+
+/**
+ * @brief appends all fields in order of adding to text, as Print to stream
+ * @param text - text to append
+ * @param state - packed state
+ * @param separator - string between fields
+ */
+    void Print(std::string& text, const PackedState& state, const char* separator) const;
+private:
+/**
+ * @brief placement of one field
+ */
+    struct Field
+    {
+        const char* name;
+        size_t word;
+        unsigned int shift;
+        uint64_t mask;
+        int min;
+        bool flag;
+        uint64_t values;
+    };
+
+/**
+ * @brief adds field with specified number of bits
+ * @param name - name of field
+ * @param bits - number of bits
+ * @param min - minimal value
+ * @param flag - indicates if field has init flag
+ * @param values - number of values of field
+ * @return index of field
+ */
+    size_t AddField(const char* name, unsigned int bits, int min, bool flag, uint64_t values);
+
+/**
+ * @brief placement of fields
+ */
+    std::vector<Field> m_fields;
+
+/**
+ * @brief number of used words
+ */
+    size_t m_words;
+
+/**
+ * @brief number of used bits in last word
+ */
+    unsigned int m_bits;
+};
+
+#endif //STATE_CODEC_H
@@ -0,0 +1,316 @@
+/******************************************************************************
+ * File: state_dump.cpp
+ * Description: binary file of generated states and its reader.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "state_dump.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+/**
+ * @brief first bytes of dump
+ */
+const char DumpMagic[8] = {'S', 'T', 'A', 'T', 'E', 'D', 'M', 'P'};
+
+/**
+ * @brief version of dump format
+ */
+const uint32_t DumpVersion = 1;
+
+/**
+ * @brief offset of number of records in header
+ */
+const size_t RecordsOffset = 16;
+
+/**
+ * @brief size of description of field in header without its name: counter
+ * flag, minimal value, number of values and length of name
+ */
+const size_t FieldRecordSize = 15;
+
+/**
+ * @brief maximal number of records in compressed block
+ */
+const uint32_t BlockRecords = 4096;
+
+/**
+ * @brief appends little-endian number to data
+ * @param data - data to append
+ * @param value - number
+ * @param bytes - size of number
+ */
+static void AppendFixed(string& data, uint64_t value, size_t bytes)
+{
+    for(size_t i = 0; i < bytes; ++i)
+        data += char((value >> (8 * i)) & 0xff);
+}
+
+/**
+ * @brief reads little-endian number
+ * @param data - pointer to number
+ * @param bytes - size of number
+ */
+static uint64_t ReadFixed(const uint8_t* data, size_t bytes)
+{
+    uint64_t value = 0;
+    for(size_t i = 0; i < bytes; ++i)
+        value |= uint64_t(data[i]) << (8 * i);
+    return value;
+}
+
+/**
+ * @brief appends header of dump to data
+ * @param data - data to append
+ * @param layout - placement of variables in packed state
+ * @param delta - flag, indicates if records are compressed
+ */
+void AppendDumpHeader(string& data, const StateLayout& layout, bool delta)
+{
+    data.append(DumpMagic, sizeof(DumpMagic));
+    AppendFixed(data, DumpVersion, 4);
+    AppendFixed(data, delta ? DumpDelta : 0, 4);
+    // number of records is written, when dump is finished
+    AppendFixed(data, 0, 8);
+    AppendFixed(data, layout.Words(), 4);
+    AppendFixed(data, layout.Fields(), 4);
+    for(size_t i = 0; i < layout.Fields(); ++i)
+    {
+        const char* name = layout.Name(i);
+        AppendFixed(data, layout.IsCounter(i) ? 1 : 0, 1);
+        AppendFixed(data, uint32_t(layout.Min(i)), 4);
+        AppendFixed(data, layout.Values(i), 8);
+        AppendFixed(data, strlen(name), 2);
+        data += name;
+    }
+}
+
+/**
+ * @brief writes number of records to header of dump, which is already written
+ * @param stream - binary stream of dump
+ * @param records - number of records
+ */
+void WriteDumpRecords(ostream& stream, uint64_t records)
+{
+    string data;
+    AppendFixed(data, records, 8);
+    stream.seekp(RecordsOffset);
+    stream.write(data.data(), data.size());
+    stream.seekp(0, ios::end);
+    stream.flush();
+}
+
+/**
+ * @brief class constructor
+ * @param words - words of packed state
+ * @param delta - flag, indicates if records are compressed
+ */
+DumpEncoder::DumpEncoder(size_t words, bool delta): m_words(words)
+                                                  , m_delta(delta)
+                                                  , m_records(0)
+                                                  , m_previous()
+                                                  , m_block()
+{
+    memset(&m_previous, 0, sizeof(m_previous));
+}
+
+/**
+ * @brief appends record of state
+ * @param data - data to append, should get only records of this encoder
+ * since last EndBlock
+ * @param state - packed state
+ */
+void DumpEncoder::Append(string& data, const PackedState& state)
+{
+    if(!m_delta)
+    {
+        // words are written as is, so format expects little-endian host
+        data.append(reinterpret_cast<const char*>(state.words), m_words * sizeof(uint64_t));
+        return;
+    }
+    for(size_t i = 0; i < m_words; ++i)
+    {
+        // neighbour states differ in few fields, so difference is small
+        int64_t difference = int64_t(state.words[i] - m_previous.words[i]);
+        uint64_t zigzag = (uint64_t(difference) << 1) ^ uint64_t(difference >> 63);
+        while(zigzag >= 0x80)
+        {
+            m_block += char((zigzag & 0x7f) | 0x80);
+            zigzag >>= 7;
+        }
+        m_block += char(zigzag);
+    }
+    m_previous = state;
+    if(++m_records == BlockRecords)
+        EndBlock(data);
+}
+
+/**
+ * @brief appends collected compressed records as complete block,
+ * so data can be written in any order with blocks of other encoders
+ * @param data - data to append
+ */
+void DumpEncoder::EndBlock(string& data)
+{
+    if(m_records == 0)
+        return;
+    AppendFixed(data, m_records, 4);
+    AppendFixed(data, m_block.size(), 4);
+    data += m_block;
+    m_block.clear();
+    m_records = 0;
+    memset(&m_previous, 0, sizeof(m_previous));
+}
+
+/**
+ * @brief class constructor, makes closed reader
+ */
+DumpReader::DumpReader(): m_data(NULL)
+                        , m_size(0)
+                        , m_position(0)
+                        , m_block_end(0)
+                        , m_block_records(0)
+                        , m_previous()
+                        , m_layout()
+                        , m_names()
+                        , m_records(0)
+                        , m_read(0)
+                        , m_delta(false)
+{
+}
+
+/**
+ * @brief class destructor
+ */
+DumpReader::~DumpReader()
+{
+    if(m_data)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+/**
+ * @brief maps dump and reads its header
+ * @param filename - name of dump
+ * @return false if file can't be mapped or isn't dump
+ */
+bool DumpReader::Open(const char* filename)
+{
+    int file = open(filename, O_RDONLY);
+    if(file < 0)
+        return false;
+    struct stat info;
+    if(fstat(file, &info) != 0 || size_t(info.st_size) < RecordsOffset + 16)
+    {
+        close(file);
+        return false;
+    }
+    m_size = info.st_size;
+    void* memory = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if(memory == MAP_FAILED)
+        return false;
+    m_data = static_cast<const uint8_t*>(memory);
+    // records are read in order, so system can read ahead
+    madvise(memory, m_size, MADV_SEQUENTIAL);
+
+    if(memcmp(m_data, DumpMagic, sizeof(DumpMagic)) != 0 || ReadFixed(m_data + 8, 4) != DumpVersion)
+        return false;
+    m_delta = (ReadFixed(m_data + 12, 4) & DumpDelta) != 0;
+    m_records = ReadFixed(m_data + RecordsOffset, 8);
+    size_t words = ReadFixed(m_data + 24, 4);
+    size_t fields = ReadFixed(m_data + 28, 4);
+    m_position = 32;
+    // number of fields is checked by size of file before memory is reserved
+    if(fields > (m_size - m_position) / FieldRecordSize)
+        return false;
+    // layout keeps pointers to names, so names aren't moved after reserve
+    m_names.reserve(fields);
+    for(size_t i = 0; i < fields; ++i)
+    {
+        if(m_position + FieldRecordSize > m_size)
+            return false;
+        bool counter = m_data[m_position] != 0;
+        int min = int(uint32_t(ReadFixed(m_data + m_position + 1, 4)));
+        uint64_t values = ReadFixed(m_data + m_position + 5, 8);
+        size_t length = ReadFixed(m_data + m_position + 13, 2);
+        m_position += FieldRecordSize;
+        if(m_position + length > m_size || values < (counter ? 1 : 2))
+            return false;
+        m_names.push_back(string(reinterpret_cast<const char*>(m_data + m_position), length));
+        m_position += length;
+        if(counter)
+            m_layout.AddCounter(m_names.back().c_str(), unsigned(values - 1));
+        else
+            m_layout.AddVariable(m_names.back().c_str(), min, int(min + int64_t(values) - 2));
+    }
+    return m_layout.Words() == words && words <= MaxStateWords;
+}
+
+/**
+ * @brief reads varint from data
+ * @param value - place for value
+ * @return false if data is ended
+ */
+bool DumpReader::ReadVarint(uint64_t& value)
+{
+    value = 0;
+    for(unsigned int shift = 0; m_position < m_block_end && shift < 64; shift += 7)
+    {
+        uint8_t byte = m_data[m_position++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if(byte < 0x80)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief reads next record, records are read in order of writing
+ * @param state - place for packed state
+ * @return false if all records are read or dump is broken
+ */
+bool DumpReader::Next(PackedState& state)
+{
+    if(m_read == m_records)
+        return false;
+    size_t words = m_layout.Words();
+    memset(&state, 0, sizeof(state));
+    if(!m_delta)
+    {
+        if(m_position + words * 8 > m_size)
+            return false;
+        memcpy(state.words, m_data + m_position, words * 8);
+        m_position += words * 8;
+        ++m_read;
+        return true;
+    }
+    if(m_block_records == 0)
+    {
+        if(m_position + 8 > m_size)
+            return false;
+        m_block_records = ReadFixed(m_data + m_position, 4);
+        m_block_end = m_position + 8 + ReadFixed(m_data + m_position + 4, 4);
+        m_position += 8;
+        if(m_block_end > m_size || m_block_records == 0)
+            return false;
+        memset(&m_previous, 0, sizeof(m_previous));
+    }
+    for(size_t i = 0; i < words; ++i)
+    {
+        uint64_t zigzag;
+        if(!ReadVarint(zigzag))
+            return false;
+        uint64_t difference = (zigzag >> 1) ^ (0 - (zigzag & 1));
+        state.words[i] = m_previous.words[i] + difference;
+    }
+    m_previous = state;
+    --m_block_records;
+    ++m_read;
+    return true;
+}
@@ -0,0 +1,247 @@
+/******************************************************************************
+ * File: state_dump.h
+ * Description: binary file of generated states and its reader.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef STATE_DUMP_H
+#define STATE_DUMP_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "state_codec.h"
+
+/*
+ * Format of dump, all numbers are little-endian:
+ * header
+ *     char[8]  magic "STATEDMP"
+ *     uint32   version
+ *     uint32   flags, DumpDelta if records are compressed
+ *     uint64   number of records
+ *     uint32   words of packed state
+ *     uint32   number of fields
+ *     fields in order of layout
+ *         uint8    1 for counter, 0 for variable
+ *         int32    minimal value
+ *         uint64   number of values, uninitialized value is counted too
+ *         uint16   length of name
+ *         char[]   name
+ * records without DumpDelta
+ *     uint64[words] packed state, as is
+ * records with DumpDelta are split to independent blocks
+ *     uint32   number of records in block
+ *     uint32   bytes of block data
+ *     data: every word of every record is varint of zigzag difference with
+ *           same word of previous record, first record of block is
+ *           compared with zero state
+ */
+
+/**
+ * @brief flag of dump with compressed records
+ */
+const uint32_t DumpDelta = 1;
+
+/**
+ * @brief appends header of dump to data
+ * @param data - data to append
+ * @param layout - placement of variables in packed state
+ * @param delta - flag, indicates if records are compressed
+ */
+void AppendDumpHeader(std::string& data, const StateLayout& layout, bool delta);
+
+/**
+ * @brief writes number of records to header of dump, which is already written
+ * @param stream - binary stream of dump
+ * @param records - number of records
+ */
+void WriteDumpRecords(std::ostream& stream, uint64_t records);
+
+/**
+ * @brief appends records of dump to data
+ */
+class DumpEncoder
+{
+public:
+/**
+ * @brief class constructor
+ * @param words - words of packed state
+ * @param delta - flag, indicates if records are compressed
+ */
+    DumpEncoder(size_t words, bool delta);
+
+/**
+ * @brief appends record of state
+ * @param data - data to append, should get only records of this encoder
+ * since last EndBlock
+ * @param state - packed state
+ */
+    void Append(std::string& data, const PackedState& state);
+
+/**
+ * @brief appends collected compressed records as complete block,
+ * so data can be written in any order with blocks of other encoders
+ * @param data - data to append
+ */
+    void EndBlock(std::string& data);
+private:
+/**
+ * @brief words of packed state
+ */
+    size_t m_words;
+
+/**
+ * @brief flag, indicates if records are compressed
+ */
+    bool m_delta;
+
+/**
+ * @brief number of records in current block
+ */
+    uint32_t m_records;
+
+/**
+ * @brief previous record of current block
+ */
+    PackedState m_previous;
+
+/**
+ * @brief compressed records of current block
+ */
+    std::string m_block;
+};
+
+/**
+ * @brief reads dump, mapped to memory. Records without compression are
+ * read from mapped memory directly.
+ */
+class DumpReader
+{
+public:
+/**
+ * @brief class constructor, makes closed reader
+ */
+    DumpReader();
+
+/**
+ * @brief class destructor
+ */
+    ~DumpReader();
+
+/**
+ * @brief maps dump and reads its header
+ * @param filename - name of dump
+ * @return false if file can't be mapped or isn't dump
+ */
+    bool Open(const char* filename);
+
+/**
+ * @brief placement of variables in packed state
+ */
+    const StateLayout& Layout() const
+    {
+        return m_layout;
+    }
+
+/**
+ * @brief number of records
+ */
+    uint64_t Records() const
+    {
+        return m_records;
+    }
+
+/**
+ * @brief checks if records are compressed
+ */
+    bool Delta() const
+    {
+        return m_delta;
+    }
+
+/**
+ * @brief checks if all records are read
+ */
+    bool Finished() const
+    {
+        return m_read == m_records;
+    }
+
+/**
+ * @brief reads next record, records are read in order of writing
+ * @param state - place for packed state
+ * @return false if all records are read or dump is broken
+ */
+    bool Next(PackedState& state);
+private:
+/**
+ * @brief reads varint from data
+ * @param value - place for value
+ * @return false if data is ended
+ */
+    bool ReadVarint(uint64_t& value);
+
+/**
+ * @brief mapped file
+ */
+    const uint8_t* m_data;
+
+/**
+ * @brief size of mapped file
+ */
+    size_t m_size;
+
+/**
+ * @brief position of next record or block in file
+ */
+    size_t m_position;
+
+/**
+ * @brief end of current block
+ */
+    size_t m_block_end;
+
+/**
+ * @brief records, left in current block
+ */
+    uint32_t m_block_records;
+
+/**
+ * @brief previous record of current block
+ */
+    PackedState m_previous;
+
+/**
+ * @brief placement of variables in packed state
+ */
+    StateLayout m_layout;
+
+/**
+ * @brief names of fields, used by layout
+ */
+    std::vector<std::string> m_names;
+
+/**
+ * @brief number of records
+ */
+    uint64_t m_records;
+
+/**
+ * @brief number of read records
+ */
+    uint64_t m_read;
+
+/**
+ * @brief flag, indicates if records are compressed
+ */
+    bool m_delta;
+
+// Copy isn't allowed
+    DumpReader(DumpReader&);
+    DumpReader& operator=(DumpReader&);
+};
+
+#endif //STATE_DUMP_H
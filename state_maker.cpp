@@ -7,16 +7,97 @@
 *******************************************************************************/
 
 #include "state_maker.h"
+#include "input_sweep.h"
+#include "ltl_checker.h"
+#include "component_analysis.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <math.h>
 #include <ctype.h> 
+#ifdef MODEL
+// steps of program are generated by model_compiler before build, see README
+#include MODEL
+#ifndef MODEL_NAME
+#define MODEL_NAME Model
+#endif
+#endif
 using namespace std;
 
-const char* Info = "Usage: <binary name> <f::a> <f::b> <g::a> <g::b>\n"
+const char* Info = "Usage: <binary name> [values of parameters]\n"
+                   "Values are integers, which are given to parameters of functions in order\n"
+                   "of text, for example f::a f::b g::a g::b of task.txt, missing values are 0\n"
                    "Allowed flags:\n"
                    "-count: prints number of states in console\n"
-                   "-file <out file>: redirect output to specified file\n\n"
+                   "-count-full: -count, and with reductions also number of states without\n"
+                   "    them, which is found by additional exploration\n"
+                   "-file <out file>: redirect output to specified file\n"
+                   "-program <file>: C program of threads (task.txt by default)\n"
+                   "-dump <file>: write states to binary file instead of text, it is read\n"
+                   "    by state_query\n"
+                   "-delta: compress records of binary file by differences of states\n"
+                   "-sync: flush every printed state at once (output is buffered and\n"
+                   "    written by background thread by default)\n"
+                   "-bfs: explore states in breadth-first order (depth-first by default)\n"
+                   "-por: partial-order reduction, only one of independent steps of f and g\n"
+                   "    is taken, deadlocks and local states of threads are kept\n"
+                   "-symbolic <min>:<max>: parameters are intervals of values from min to\n"
+                   "    max instead of numbers, one exploration covers all of them, states\n"
+                   "    are split only where steps depend on values of parameters\n"
+                   "-sweep <ranges>: explore program for every tuple of values of listed\n"
+                   "    parameters, for example f.a=0..1000,g.b=2..3, other parameters have\n"
+                   "    values of numbers, table of tuples with numbers of states is printed\n"
+                   "-sweep-merge: explore tuples of -sweep together with intervals of\n"
+                   "    parameters, states are shared by tuples, which steps don't depend on\n"
+                   "    values of parameters\n"
+                   "-replicate <functions>: run several threads of function, for example\n"
+                   "    worker=4,f=2 makes threads worker[0]..worker[3], f[0], f[1]\n"
+                   "-liveness: reset local variables, which aren't read before next\n"
+                   "    assignment, to uninitialized, so states, which differ only by them,\n"
+                   "    are merged, -count-full prints states saved by every variable\n"
+                   "-check <invariant>: stop at first state, where invariant doesn't hold,\n"
+                   "    and print trace of steps to it instead of states, for example\n"
+                   "    'h<7 && (f.counter!=3 || g.y==#)', reductions and projection are\n"
+                   "    turned off, exit status is 1 if invariant is violated\n"
+                   "-violations <number>: stop -check after number of violations, every\n"
+                   "    violating state gets its trace (1 by default)\n"
+                   "-ltl <formula>: check LTL formula over infinite runs instead of\n"
+                   "    printing states, finished program repeats last state, operators are\n"
+                   "    X, F, G, U, R, !, &&, ||, ->, for example 'G (h<7 -> F g.pc==g.end)',\n"
+                   "    exit status is 1 if formula is violated\n"
+                   "-fair: check -ltl only on runs, where every thread, which is enabled\n"
+                   "    forever, makes steps infinitely often\n"
+                   "-components: print numbers of terminal and deadlocked states, of\n"
+                   "    cyclic components and longest acyclic path instead of states, and\n"
+                   "    path to first deadlock, exit status is 1 if deadlock is found\n"
+                   "-blocks: local steps of thread, which access only its variables, are\n"
+                   "    done at once with its previous step, so they aren't points of\n"
+                   "    scheduling, -count prints number of removed points\n"
+                   "-break <points>: keep points of scheduling before listed steps with\n"
+                   "    -blocks, for example f:3,g:7, where numbers are program counters\n"
+                   "-domains: print ranges of variables and number of dead transitions,\n"
+                   "    which are found by analysis of program before exploration\n"
+                   "-symmetry: symmetry reduction, states, which differ only by permutation\n"
+                   "    of replicas of function, are explored once\n"
+                   "-stateless <depth>: explore schedules of f and g without storing states,\n"
+                   "    schedules, which differ only in order of independent steps, are\n"
+                   "    pruned, final state of every schedule is printed, depth limits length\n"
+                   "    of schedule\n"
+                   "-threads <number>: explore states by several threads, order of states\n"
+                   "    in output isn't determined\n"
+                   "-capacity <states>: number of states, allocated before exploration,\n"
+                   "    maximal number of states with -threads\n"
+                   "-load <percent>: maximal load of table with generated states, 10..95\n"
+                   "-bitstate <MB>: store states as bits of array of specified size, some\n"
+                   "    states can be lost, coverage is estimated, not allowed with -threads\n"
+                   "-compact <32|64>: store only fingerprints of states of specified bits,\n"
+                   "    some states can be lost, collision probability is estimated, not\n"
+                   "    allowed with -threads\n"
+                   "-bitmap <MB>: maximal size of bitmap with bit for every possible state,\n"
+                   "    which is used instead of table, if domains of variables are small\n"
+                   "    enough, 0 to use table always (64 by default)\n"
+                   "-project <vars>: differ states only by listed variables, for example\n"
+                   "    f.counter,g.counter,h (all variables by default)\n\n"
                    "Author: Valery Bitsoev. March 2013\n";
 /**
  * @brief checks is string consist of only digits
@@ -29,36 +110,121 @@ bool isNumber(char * string)
             return false;
     return true;
 }
+
 /**
- * @brief overloaded output operator for IntVariable
- * @param stream - output stream
- * @param right - object to print
- * @return reference to stream
+ * @brief checks is string integer: digits with optional minus before them
+ * @param string - string to check
  */
-ostream& operator<<(ostream& stream, const IntVariable& right)
+bool isInteger(char * string)
 {
-    if(right.m_init_flag)
-    {
-        stream<<right.m_value;
-    }
-    else
-    {
-        stream<<"#";
-    }
-    return stream;
+    if(string[0] == '-')
+        ++string;
+    return string[0] != '\0' && isNumber(string);
 }
 
+/**
+ * @brief number of frontier items, allocated before exploration
+ */
+const size_t FrontierCapacity = 1024;
+
+/**
+ * @brief default number of states, allocated before exploration
+ */
+const size_t DefaultStatesCapacity = 1024;
+
+/**
+ * @brief default load factor of table with generated states, in percents
+ */
+const int DefaultMaxLoad = 70;
+
+/**
+ * @brief default number of states, which table shared by threads can store
+ */
+const size_t DefaultSharedCapacity = 1 << 22;
+
+/**
+ * @brief default maximal size of bitmap of generated states, in megabytes
+ */
+const size_t DefaultBitmapBudget = 64;
+
+/**
+ * @brief size of thread output, which is printed at once
+ */
+const size_t OutputBufferSize = 1 << 16;
+
 /**
  * @brief class constructor
+ * @param program - program of threads, which is explored
  * @param filename - name of output file
  * @param count_flag - flag, indicates if need print state number
+ * @param count_full - flag, indicates if states without reductions are
+ * counted by additional exploration
+ * @param dump_filename - name of binary file for states instead of text, NULL
+ * to print text
+ * @param delta - flag, indicates if records of binary file are compressed
+ * @param sync - flag, indicates if every printed state is flushed at once
+ * @param order - order of states exploration
+ * @param capacity - number of states, allocated before exploration
+ * @param max_load - maximal load factor of table with generated states
+ * @param projection - comma separated names of variables, which differ states,
+ * NULL to differ states by all variables
+ * @param threads - number of exploring threads
+ * @param por - flag, indicates if partial-order reduction is used
+ * @param symmetry - flag, indicates if states, which differ by permutation of
+ * replicas of function, are merged
+ * @param liveness - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if local steps are fused with previous
+ * step of thread
+ * @param stateless_depth - maximal length of schedule for exploration without
+ * set of generated states, 0 to store generated states
  */
-StateMaker::StateMaker(char* filename, bool count_flag): m_states_number(0)
+StateMaker::StateMaker(const Program& program, char* filename, bool count_flag, bool count_full, const char* dump_filename, bool delta, bool sync, SearchOrder order,
+                       size_t capacity, double max_load, const char* projection,
+                       size_t threads, bool por, bool symmetry, bool liveness, bool blocks, size_t bitmap_budget,
+                       size_t bitstate_size, unsigned int fingerprint_bits, size_t stateless_depth): m_states_number(0)
                                       , m_count_flag(count_flag) 
+                                      , m_count_full(count_full)
                                       , m_to_file_flag(false)
                                       , m_file(filename)
-                                      , m_old()
+                                      , m_writer(NULL)
+                                      , m_dump(false)
+                                      , m_dump_file()
+                                      , m_program(program)
+                                      , m_layout(program.Layout())
+                                      , m_old(NULL)
+                                      , m_frontier(order, FrontierCapacity)
+                                      , m_threads(threads)
+                                      , m_shared_old(m_layout.Words(), threads > 1 ? capacity : 0)
+                                      , m_buffers(threads > 1 ? threads : 0)
+                                      , m_encoders(threads, DumpEncoder(m_layout.Words(), delta))
+                                      , m_output_mutex()
+                                      , m_por(por)
+                                      , m_symmetry(symmetry)
+                                      , m_liveness(liveness)
+                                      , m_blocks(blocks)
+                                      , m_kept()
+                                      , m_reduced_states(0)
+                                      , m_stateless_depth(stateless_depth)
+                                      , m_inputs()
 {
+    m_layout.Clear(m_kept);
+    // states are differed by all variables, unless projection is specified
+    vector<size_t> key_fields;
+    if(projection && !m_layout.Find(projection, key_fields))
+    {
+        cerr<<"Unknown variable in projection, states are differed by all variables"<<endl;
+        projection = NULL;
+    }
+    if(!projection)
+    {
+        key_fields.clear();
+        for(size_t i = 0; i < m_layout.Fields(); ++i)
+            key_fields.push_back(i);
+    }
+    m_layout.Mask(key_fields, m_key_mask);
+    // set of several threads is m_shared_old
+    m_old = MakeStateSet(m_layout, key_fields, threads > 1 ? 0 : capacity, max_load, threads > 1 ? 0 : bitmap_budget,
+                         threads > 1 ? 0 : bitstate_size, threads > 1 ? 0 : fingerprint_bits, false);
     if(filename)
     {
         if(m_file.bad())
@@ -72,6 +238,23 @@ StateMaker::StateMaker(char* filename, bool count_flag): m_states_number(0)
             m_to_file_flag = true;
         }
     }
+    if(dump_filename)
+    {
+        m_dump_file.open(dump_filename, ios::binary);
+        if(!m_dump_file)
+            cerr<<"Can't open binary file, states are printed as text"<<endl;
+        else
+            m_dump = true;
+    }
+    if(m_dump)
+        m_writer = new OutputWriter(m_dump_file, sync);
+    else
+        m_writer = new OutputWriter(m_to_file_flag ? static_cast<ostream&>(m_file) : cout, sync);
+    if(m_dump)
+    {
+        AppendDumpHeader(m_writer->Buffer(), m_layout, delta);
+        m_writer->Commit();
+    }
 }
 
 /**
@@ -79,196 +262,530 @@ StateMaker::StateMaker(char* filename, bool count_flag): m_states_number(0)
  */
 StateMaker::~StateMaker()
 {
+    delete m_writer;
+    delete m_old;
     m_file.close();
 }
 
 /**
  * @brief generates and prints states in console or file
- * @param f_a initial value of f::a
- * @param f_b initial value of f::b
- * @param g_a initial value of g::a
- * @param g_b initial value of g::b
+ * @return false if table of states, shared by threads, is full, so some
+ * states are lost
  */
-void StateMaker::PrintStates(int f_a, int f_b, int g_a, int g_b)
+bool StateMaker::PrintStates()
 {
-    // fill f data
-    FuncVars f;
-    f.a = f_a;
-    f.b = f_b;
-    f.counter = 0;
-
-    // fill g data
-    FuncVars g;
-    g.a = g_a;
-    g.b = g.b;
-    g.counter = 0;
+    // parameters are constants of program, so they aren't stored in packed state
+    PackedState initial;
+    m_program.Initial(initial);
+    if(m_symmetry)
+        m_program.Canonicalize(initial);
 
-    // global variable
-    IntVariable h;
+    if(m_stateless_depth > 0)
+    {
+        GenerateSchedules(initial);
+        return true;
+    }
+    if(m_program.Symbolic())
+    {
+        GenerateSymbolic(initial);
+        FinishOutput(m_states_number);
+        if(m_count_flag)
+        {
+            cout<<"Abstract states number: "<<m_states_number<<endl;
+            PrintInputs();
+        }
+        return true;
+    }
 
     // start generating
-    GenerateStates(f, g, h);
+    if(m_threads > 1)
+        GenerateStatesParallel(initial);
+    else
+        GenerateStates(initial);
+    FinishOutput(m_states_number);
     if(m_count_flag) cout<<"Result states number: "<<m_states_number<<endl;
+    if(m_count_flag && m_threads == 1 && !m_old->Exact())
+    {
+        // states, taken for generated ones, are lost with their successors
+        double omissions = m_old->Omissions();
+        cout<<"Estimated coverage: "<<100.0 * m_states_number / (m_states_number + omissions)<<"%"<<endl;
+        cout<<"Collision probability: "<<1 - exp(-omissions)<<endl;
+    }
+    if(m_count_flag && m_por)
+        cout<<"States with reduced steps: "<<m_reduced_states<<endl;
+    if(m_count_flag && m_blocks)
+        cout<<"Removed scheduling points: "<<m_program.FusedPoints()<<endl;
+    if(m_count_full && (m_por || m_symmetry || m_liveness || m_blocks))
+    {
+        m_program.Initial(initial);
+        cout<<"States number without reduction: "<<CountFullStates(initial, false)<<endl;
+    }
+    if(m_count_full && m_liveness)
+        PrintSavedStates(initial);
+    return m_threads == 1 || !m_shared_old.Full();
 }
 
 /** 
- * @brief generates and prints all states after state described by f, g and h
- * @param f - state of function f
- * @param g - state of function g
- * @param h - state of global variable
+ * @brief generates and prints all states after specified state
+ * @param initial - packed state of program
  */
-void StateMaker::GenerateStates(FuncVars f, FuncVars g, IntVariable h)
+void StateMaker::GenerateStates(const PackedState& initial)
 {
-    if(m_old.count(StateDiff(f.counter, g.counter, h))!=0)
+    PackedState state = initial;
+    m_frontier.Push(state);
+    while(!m_frontier.Empty())
+    {
+        m_frontier.Pop(state);
+        if(!m_old->FindOrInsert(state))
+            continue;
+        ++m_states_number;
+        PrintState(state);
+        PackedState next[MaxThreads];
+        size_t number = Successors(state, next, m_por, m_symmetry, m_liveness, m_blocks);
+        // successors of first thread are taken first in both orders
+        for(size_t i = 0; i < number; ++i)
+            m_frontier.Push(next[m_frontier.Order() == DFS_ORDER ? number - 1 - i : i]);
+    }
+}
+
+/** 
+ * @brief generates and prints all states after specified state by several threads
+ * @param initial - packed state of program
+ */
+void StateMaker::GenerateStatesParallel(const PackedState& initial)
+{
+    ParallelExplorer<PackedState, StateMaker> explorer(*this, m_threads);
+    explorer.Run(initial);
+    for(size_t i = 0; i < m_threads; ++i)
+        Flush(i);
+    m_states_number = m_shared_old.Size();
+    if(m_shared_old.Full())
+        cerr<<"Table of generated states is full, states after it are lost, increase -capacity"<<endl;
+}
+
+/**
+ * @brief explores all schedules of threads without set of generated states,
+ * prints final state of every explored schedule
+ * @param initial - packed state of program
+ */
+void StateMaker::GenerateSchedules(const PackedState& initial)
+{
+    StatelessExplorer<StateMaker> explorer(*this, m_stateless_depth);
+    explorer.Run(initial);
+    const StatelessStats& stats = explorer.Stats();
+    FinishOutput(stats.schedules);
+    if(stats.cut > 0)
+        cerr<<"Some schedules are longer than -stateless depth and aren't finished"<<endl;
+    if(m_count_flag)
+    {
+        cout<<"Explored schedules: "<<stats.schedules<<endl;
+        cout<<"Schedules cut by sleep sets: "<<stats.sleep_blocked<<endl;
+        cout<<"Steps pruned by partial-order reduction: "<<stats.pruned_steps<<endl;
+        cout<<"Executed steps: "<<stats.steps<<endl;
+    }
+}
+
+/**
+ * @brief generates and prints all abstract states after specified state,
+ * parameters of program are intervals, which are split by steps
+ * @param initial - packed state of program
+ */
+void StateMaker::GenerateSymbolic(const PackedState& initial)
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    vector<int> bounds(2 * parameters.size());
+    vector<PackedState> next;
+    PackedState state = initial;
+    m_frontier.Push(state);
+    while(!m_frontier.Empty())
+    {
+        m_frontier.Pop(state);
+        if(!m_old->FindOrInsert(state))
+            continue;
+        ++m_states_number;
+        PrintState(state);
+        for(size_t i = 0; i < parameters.size(); ++i)
+            m_program.Bounds(state, parameters[i], bounds[2 * i], bounds[2 * i + 1]);
+        ++m_inputs[bounds];
+        next.clear();
+        for(size_t i = 0; i < m_program.Threads(); ++i)
+        {
+            size_t first = next.size();
+            m_program.SymbolicSteps(state, i, next);
+            for(size_t j = first; m_liveness && j < next.size(); ++j)
+                m_program.ResetDead(next[j], i, m_kept);
+        }
+        if(m_symmetry)
+            for(size_t i = 0; i < next.size(); ++i)
+                m_program.Canonicalize(next[i]);
+        // successors of first thread are taken first in both orders
+        for(size_t i = 0; i < next.size(); ++i)
+            m_frontier.Push(next[m_frontier.Order() == DFS_ORDER ? next.size() - 1 - i : i]);
+    }
+}
+
+/**
+ * @brief prints intervals of parameters, which abstract states cover, and
+ * numbers of states of every combination
+ */
+void StateMaker::PrintInputs()
+{
+    const vector<size_t>& parameters = m_program.Parameters();
+    cout<<"Inputs of abstract states: "<<m_inputs.size()<<endl;
+    for(map<vector<int>, size_t>::const_iterator input = m_inputs.begin(); input != m_inputs.end(); ++input)
+    {
+        for(size_t i = 0; i < parameters.size(); ++i)
+        {
+            // name of lower bound is <parameter>.min
+            string name = m_layout.Name(parameters[i]);
+            const vector<int>& bounds = input->first;
+            cout<<(i > 0 ? ", " : "    ")<<name.substr(0, name.size() - 4)<<" = ";
+            if(bounds[2 * i] == bounds[2 * i + 1])
+                cout<<bounds[2 * i];
+            else
+                cout<<"["<<bounds[2 * i]<<".."<<bounds[2 * i + 1]<<"]";
+        }
+        cout<<": "<<input->second<<" states"<<endl;
+    }
+}
+
+/**
+ * @brief checks if thread can do step
+ * @param state - state of program
+ * @param thread - number of thread
+ */
+bool StateMaker::Enabled(const PackedState& state, size_t thread) const
+{
+    return m_program.Enabled(state, thread) != NULL;
+}
+
+/**
+ * @brief variables, accessed by next step of thread
+ * @param state - state of program
+ * @param thread - number of thread
+ */
+const Access& StateMaker::Next(const PackedState& state, size_t thread) const
+{
+    return m_program.Current(state, thread);
+}
+
+/**
+ * @brief do step by thread
+ * @param state - state of program, changed in place
+ * @param thread - number of thread
+ */
+void StateMaker::Step(PackedState& state, size_t thread)
+{
+    m_program.Step(state, thread);
+}
+
+/**
+ * @brief prints final state of explored schedule
+ * @param state - state of program
+ */
+void StateMaker::Finish(const PackedState& state)
+{
+    PrintState(state);
+}
+
+/**
+ * @brief stores and prints state, generated by thread, and makes its successors
+ * @param worker - number of thread
+ * @param state - generated state
+ * @param next - place for successors
+ */
+void StateMaker::Expand(size_t worker, const PackedState& state, vector<PackedState>& next)
+{
+    PackedState key;
+    MaskState(state, m_key_mask, key);
+    if(!m_shared_old.FindOrInsert(key.words))
         return;
-    m_old.insert(StateDiff(f.counter, g.counter, h));
-    ++m_states_number;
-    if(m_to_file_flag)
+    AppendState(worker, state);
+    if(m_buffers[worker].size() > OutputBufferSize)
+        Flush(worker);
+    PackedState successors[MaxThreads];
+    size_t number = Successors(state, successors, false, m_symmetry, m_liveness, m_blocks);
+    next.insert(next.end(), successors, successors + number);
+}
+
+/**
+ * @brief prints generated state by single thread
+ * @param state - state of program
+ */
+void StateMaker::PrintState(const PackedState& state)
+{
+    if(m_dump)
     {
-        // print to file
-        m_file<<f.counter<<", "<<g.counter<<", "<<h<<", "<<f.x<<", "<<f.y<<", "<<g.x<<", "<<g.y<<endl;
+        m_encoders[0].Append(m_writer->Buffer(), state);
+        m_writer->Commit();
     }
     else
     {
-       // print to console
-       cout<<f.counter<<", "<<g.counter<<", "<<h<<", "<<f.x<<", "<<f.y<<", "<<g.x<<", "<<g.y<<endl;
+        m_layout.Print(m_writer->Buffer(), state, ", ");
+        m_writer->EndLine();
     }
-    // activated thread with f
-    if(f.counter < 11) StepInF(f,g,h);
-    // activated thread with g
-    if(g.counter < 17) StepInG(f,g,h);
 }
 
 /**
- * @brief do step by f code
- * @param f - state of function f
- * @param g - state of function g
- * @param g - state of global variable
+ * @brief adds generated state to output of thread
+ * @param worker - number of thread
+ * @param state - state of program
  */
-void StateMaker::StepInF(FuncVars f, FuncVars g, IntVariable h)
+void StateMaker::AppendState(size_t worker, const PackedState& state)
 {
+    if(m_dump)
+    {
+        m_encoders[worker].Append(m_buffers[worker], state);
+    }
+    else
+    {
+        m_layout.Print(m_buffers[worker], state, ", ");
+        m_buffers[worker] += '\n';
+    }
+}
 
-    switch(f.counter)
-    {
-        //int x,y
-        case 0:
-            ++f.counter;
-            break;
-        // x = 6
-        case 1:
-            f.x = 6;
-            ++f.counter;
-            break;
-        // y = 1
-        case 2:
-            f.y = 1;
-            ++f.counter;
-            break;
-        // h = 6
-        case 3: 
-            h = 6;
-            ++f.counter;
-            break;
-        // h = x
-        case 4:
-            h = f.x;
-            ++f.counter;
-            break;
-        // if (y>2)
-        case 5: 
-            f.counter = 7;
-            break;
-        // if (y<8)
-        case 7:
-            ++f.counter;
-            break;
-        // if (y>5)
-        case 8:
-            f.counter = 10;
-            break;
-        // x = 5
-        case 10:
-            f.x = 5;
-            ++f.counter;
-            break;
-        // end of f
-        case 11:
-        // in other cases
-        default:
-            assert(!"bad f.counter value)");
-        break;
-    }
-    GenerateStates(f,g,h);
+/**
+ * @brief writes all printed states, binary file gets number of records
+ * @param records - number of printed states
+ */
+void StateMaker::FinishOutput(uint64_t records)
+{
+    if(m_dump && m_threads == 1)
+        m_encoders[0].EndBlock(m_writer->Buffer());
+    m_writer->Finish();
+    if(m_dump)
+        WriteDumpRecords(m_dump_file, records);
 }
 
+/**
+ * @brief prints output of thread
+ * @param worker - number of thread
+ */
+void StateMaker::Flush(size_t worker)
+{
+    string& buffer = m_buffers[worker];
+    if(m_dump)
+        m_encoders[worker].EndBlock(buffer);
+    lock_guard<mutex> lock(m_output_mutex);
+    m_writer->Write(buffer);
+    buffer.clear();
+}
 
 /**
- * @brief do step by g code
- * @param f - state of function f
- * @param g - state of function g
- * @param g - state of global variable
+ * @brief counts states, generated without partial-order reduction
+ * @param initial - packed state of program
+ * @param live - flag, indicates if dead local variables are reset
  */
-void StateMaker::StepInG(FuncVars f, FuncVars g, IntVariable h)
+size_t StateMaker::CountFullStates(const PackedState& initial, bool live)
 {
-    switch(g.counter)
-    {
-        // int x,y
-        case 0:
-            ++g.counter;
-            break;
-        // x = 9
-        case 1:
-            g.x = 9;
-            ++g.counter;
-            break;
-        // y = 0;
-        case 2:
-            g.y = 10;
-            ++g.counter;
-            break;
-        // h = 1
-        case 3:
-            h = 1;
-            ++g.counter;
-            break;
-        // if(x<2)
-        case 4:
-            g.counter = 6;
-            break;
-        // h = 2
-        case 6: 
-            h = 2;
-            ++g.counter;
-            break;
-        // if(h>7)
-        case 7:
-            g.counter = 9;
-            break;
-        // y = 4
-        case 9: 
-            g.y = 4;
-            ++g.counter;
-            break;
-        // while (x>7)
-        case 10:
-            ++g.counter;
-            break;
-        // if (h>0)
-        case 11:
-            ++g.counter;
-            break;
-        // break
-        case 12:
-            g.counter = 17;
-            break;
-        // end of g
-        case 17:
-        // in other cases
-        default:
-            assert(!"bad g.counter value");
-            break;
-    }
-    GenerateStates(f,g,h);
+    VisitedStore old(m_layout.Words(), m_old->Size(), DefaultMaxLoad / 100.0);
+    Frontier<PackedState> frontier(DFS_ORDER, FrontierCapacity);
+    PackedState state = initial;
+    PackedState key;
+    frontier.Push(state);
+    while(!frontier.Empty())
+    {
+        frontier.Pop(state);
+        MaskState(state, m_key_mask, key);
+        if(!old.FindOrInsert(key.words))
+            continue;
+        PackedState next[MaxThreads];
+        size_t number = Successors(state, next, false, false, live, false);
+        for(size_t i = 0; i < number; ++i)
+            frontier.Push(next[i]);
+    }
+    return old.Size();
+}
+
+/**
+ * @brief prints numbers of states, which are merged by reset of every dead
+ * variable
+ * @param initial - packed state of program
+ */
+void StateMaker::PrintSavedStates(const PackedState& initial)
+{
+    size_t states = CountFullStates(initial, true);
+    for(size_t i = 0; i < m_layout.Fields(); ++i)
+    {
+        if(!m_program.Resettable(i))
+            continue;
+        // variable is kept, other dead variables are reset
+        vector<size_t> field(1, i);
+        m_layout.Mask(field, m_kept);
+        cout<<"States saved by dead "<<m_layout.Name(i)<<": "<<CountFullStates(initial, true) - states<<endl;
+    }
+    m_layout.Clear(m_kept);
+}
+
+/**
+ * @brief makes successors of state in order of threads
+ * @param state - state of program
+ * @param next - place for MaxThreads successors
+ * @param reduce - flag, indicates if only ample set of steps is taken
+ * @param symmetric - flag, indicates if successors are canonicalized
+ * @param live - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if fused local steps are done at once
+ * @return number of successors
+ */
+size_t StateMaker::Successors(const PackedState& state, PackedState* next, bool reduce, bool symmetric, bool live, bool blocks)
+{
+#ifdef MODEL
+    if(!reduce && !symmetric && !live && !blocks)
+    {
+        // compiled steps don't interpret table, reductions still need it
+        size_t number = 0;
+        for(size_t i = 0; i < MODEL_NAME::Threads(); ++i)
+        {
+            next[number] = state;
+            if(MODEL_NAME::Step(next[number], i))
+                ++number;
+        }
+        return number;
+    }
+#endif
+    Reductions reductions = {symmetric, live, blocks};
+    size_t thread;
+    if(reduce && AmpleStep(m_program, state, *m_old, reductions, m_kept, next[0], thread))
+    {
+        ++m_reduced_states;
+        return 1;
+    }
+    size_t number = 0;
+    for(size_t i = 0; i < m_program.Threads(); ++i)
+    {
+        next[number] = state;
+        if(MoveThread(m_program, next[number], i, reductions, m_kept))
+            ++number;
+    }
+    return number;
+}
+
+/**
+ * @brief generates states until invariant is violated, prints traces from
+ * initial state to violating states instead of states
+ * @param invariant - property of all states
+ * @param limit - number of violations, after which exploration is stopped
+ * @return number of found violations
+ */
+size_t StateMaker::CheckStates(const Invariant& invariant, size_t limit)
+{
+    InvariantChecker checker(m_program, invariant, *m_old, *m_writer);
+    size_t violations = checker.Run(m_frontier.Order(), limit);
+    FinishOutput(0);
+    checker.Print(m_count_flag);
+    return violations;
+}
+
+/**
+ * @brief opens file for report of mode, which doesn't print states
+ * @param filename - file for report, NULL for console
+ * @param file - stream of file, opened if filename is given
+ * @return file or console, if file isn't given or can't be opened
+ */
+ostream& OpenReport(const char* filename, ofstream& file)
+{
+    if(!filename)
+        return cout;
+    file.open(filename);
+    if(file)
+        return file;
+    cerr<<"Can't open file, redirecting output to console"<<endl;
+    return cout;
+}
+
+/**
+ * @brief explores program for every tuple of swept parameters and prints
+ * table of tuples
+ * @param program - empty program
+ * @param program_filename - file of program
+ * @param arguments - values of parameters, which aren't swept
+ * @param replicas - numbers of threads of functions
+ * @param sweep - swept parameters
+ * @param threads - number of exploring threads
+ * @param merge - flag, indicates if tuples are explored together
+ * @param filename - file for table, NULL for console
+ * @param count_flag - flag, indicates if totals are printed
+ * @return exit code of program
+ */
+int Sweep(Program& program, const char* program_filename, const vector<int>& arguments,
+          const map<string, size_t>& replicas, const vector<SweepRange>& sweep, size_t threads,
+          bool merge, const char* filename, bool count_flag)
+{
+    // parameters are compiled once as intervals, which cover all values
+    ParameterRange range = {0, 0};
+    for(size_t i = 0; i < arguments.size(); ++i)
+    {
+        range.min = min(range.min, arguments[i]);
+        range.max = max(range.max, arguments[i]);
+    }
+    for(size_t i = 0; i < sweep.size(); ++i)
+    {
+        range.min = min(range.min, sweep[i].min);
+        range.max = max(range.max, sweep[i].max);
+    }
+    if(!program.Load(program_filename, arguments, replicas, &range))
+        return 1;
+    InputSweep explorer(program, sweep, threads, merge);
+    if(!explorer.Run())
+        return 1;
+    ofstream file;
+    explorer.Print(OpenReport(filename, file));
+    if(count_flag)
+    {
+        cout<<"Tuples number: "<<explorer.Tuples()<<endl;
+        if(merge)
+            cout<<"Abstract states number: "<<explorer.AbstractStates()<<endl;
+    }
+    return 0;
+}
+
+/**
+ * @brief checks LTL formula by product of program and Buchi automaton of
+ * its negation
+ * @param program - loaded program
+ * @param formula - text of formula
+ * @param fair - flag, indicates if only weakly fair runs are checked
+ * @param capacity - number of product states, allocated before exploration
+ * @param filename - file for counterexample, NULL for console
+ * @param count_flag - flag, indicates if number of product states is printed
+ * @return exit code of program, 1 if counterexample is found
+ */
+int CheckFormula(const Program& program, const char* formula, bool fair, size_t capacity,
+                 const char* filename, bool count_flag)
+{
+    BuchiAutomaton automaton;
+    if(!automaton.Parse(program.Layout(), formula))
+        return 1;
+    LtlChecker checker(program, automaton, fair, capacity);
+    bool holds = checker.Run();
+    ofstream file;
+    ostream& stream = OpenReport(filename, file);
+    if(holds)
+        stream<<"Formula "<<automaton.Text()<<" holds"<<endl;
+    else
+        checker.PrintCounterexample(stream);
+    if(count_flag)
+    {
+        cout<<"Automaton states number: "<<automaton.States()<<endl;
+        cout<<"Product states number: "<<checker.States()<<endl;
+    }
+    return holds ? 0 : 1;
+}
+
+/**
+ * @brief finds deadlocks, cycles and longest path by one exploration
+ * @param program - loaded program
+ * @param capacity - number of states, allocated before exploration
+ * @param filename - file for report, NULL for console
+ * @return exit code of program, 1 if deadlock is found
+ */
+int AnalyzeComponents(const Program& program, size_t capacity, const char* filename)
+{
+    ComponentAnalysis analysis(program, capacity);
+    analysis.Run();
+    ofstream file;
+    analysis.Print(OpenReport(filename, file));
+    return analysis.Deadlocks() > 0 ? 1 : 0;
 }
 
 int main(int argc, char** argv)
@@ -277,12 +794,43 @@ int main(int argc, char** argv)
     bool bad_args = false;
     char* filename = NULL;
     bool count_flag = false;
-    int f_a = 0;
-    int f_b = 0;
-    int g_a = 0;
-    int g_b = 0;
+    bool count_full = false;
+    bool sync = false;
+    const char* dump_filename = NULL;
+    bool delta = false;
+    SearchOrder order = DFS_ORDER;
+    size_t capacity = 0;
+    int max_load = DefaultMaxLoad;
+    size_t bitmap_budget = DefaultBitmapBudget;
+    size_t bitstate_size = 0;
+    unsigned int fingerprint_bits = 0;
+    const char* projection = NULL;
+    size_t threads = 1;
+    bool por = false;
+    bool symmetry = false;
+    bool domains = false;
+    bool liveness = false;
+    bool blocks = false;
+    const char* breakpoints = NULL;
+    const char* check = NULL;
+    size_t violations = 1;
+    const char* ltl = NULL;
+    bool fair = false;
+    bool components = false;
+    map<string, size_t> replicas;
+    ParameterRange range = {0, 0};
+    bool symbolic = false;
+    vector<SweepRange> sweep;
+    bool sweep_merge = false;
+    size_t stateless_depth = 0;
+#ifdef MODEL
+    const char* program_filename = MODEL_NAME::Source();
+#else
+    const char* program_filename = "task.txt";
+#endif
+    vector<int> arguments;
     //parse argv
-    if(argc > 4 && argc < 9)
+    if(argc > 1)
     {
         while(--argc>0)
         {
@@ -299,27 +847,294 @@ int main(int argc, char** argv)
                 count_flag = true;
                 ++i;
             }
-            else if(isNumber(argv[i]))
+            else if(strcmp(argv[i], "-count-full") == 0)
+            {
+                // flag to count states without reductions by additional exploration
+                count_flag = true;
+                count_full = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-program") == 0)
             {
-                if(argc < 4)
+                // flag for file of program
+                if(argc < 2)
                 {
-                    // too little args
                     bad_args = true;
                     break;
                 }
-                if(!isNumber(argv[i+1]) || !isNumber(argv[i+2]) || !isNumber(argv[i+3]))
+                program_filename = argv[i+1];
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-symbolic") == 0)
+            {
+                // flag for range of symbolic parameters
+                char* end = NULL;
+                if(argc >= 2)
+                {
+                    range.min = strtol(argv[i+1], &end, 10);
+                    if(*end == ':')
+                        range.max = strtol(end + 1, &end, 10);
+                }
+                if(argc < 2 || *end != '\0' || range.min > range.max)
+                {
+                    bad_args = true;
+                    break;
+                }
+                symbolic = true;
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-sweep") == 0)
+            {
+                // flag for swept parameters
+                if(argc < 2 || !ParseSweep(argv[i+1], sweep))
+                {
+                    bad_args = true;
+                    break;
+                }
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-sweep-merge") == 0)
+            {
+                // flag to explore swept tuples together
+                sweep_merge = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-replicate") == 0)
+            {
+                // flag for numbers of threads of functions
+                if(argc < 2 || !ParseReplicas(argv[i+1], replicas))
+                {
+                    bad_args = true;
+                    break;
+                }
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-liveness") == 0)
+            {
+                // flag to reset dead local variables
+                liveness = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-check") == 0)
+            {
+                // flag for invariant, which is checked during exploration
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                check = argv[i+1];
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-violations") == 0)
+            {
+                // flag for number of violations before stop
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
+                {
+                    bad_args = true;
+                    break;
+                }
+                violations = atol(argv[i+1]);
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-ltl") == 0)
+            {
+                // flag for LTL formula, which is checked instead of printing states
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                ltl = argv[i+1];
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-fair") == 0)
+            {
+                // flag to check formula only on weakly fair runs
+                fair = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-components") == 0)
+            {
+                // flag to find deadlocks and cycles instead of printing states
+                components = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-blocks") == 0)
+            {
+                // flag to fuse local steps with previous step of thread
+                blocks = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-break") == 0)
+            {
+                // flag for points of scheduling, which aren't fused
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                blocks = true;
+                breakpoints = argv[i+1];
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-domains") == 0)
+            {
+                // flag to print ranges of variables, found before exploration
+                domains = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-symmetry") == 0)
+            {
+                // flag to merge states with permuted replicas
+                symmetry = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-dump") == 0)
+            {
+                // flag for binary file of states
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                dump_filename = argv[i+1];
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-delta") == 0)
+            {
+                // flag to compress records of binary file
+                delta = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-sync") == 0)
+            {
+                // flag to flush every printed state
+                sync = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-por") == 0)
+            {
+                // flag to use partial-order reduction
+                por = true;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-bfs") == 0)
+            {
+                // flag to explore states in breadth-first order
+                order = BFS_ORDER;
+                ++i;
+            }
+            else if(strcmp(argv[i], "-project") == 0)
+            {
+                // flag for names of variables, which differ states
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                projection = argv[i+1];
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-stateless") == 0)
+            {
+                // flag for exploration of schedules without generated states
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
                 {
-                    // should be 4 number is a row
                     bad_args = true;
                     break;
                 }
-                // fill values
-                f_a = atoi(argv[i]);
-                f_b = atoi(argv[i+1]);
-                g_a = atoi(argv[i+2]);
-                g_b = atoi(argv[i+3]);
-                argc-=3;
-                i+=4;
+                stateless_depth = atol(argv[i+1]);
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-threads") == 0)
+            {
+                // flag for number of exploring threads
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
+                {
+                    bad_args = true;
+                    break;
+                }
+                threads = atoi(argv[i+1]);
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-bitstate") == 0)
+            {
+                // flag for size of bit array of bitstate search
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
+                {
+                    bad_args = true;
+                    break;
+                }
+                bitstate_size = size_t(atol(argv[i+1])) << 20;
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-compact") == 0)
+            {
+                // flag for bits of fingerprints of states
+                if(argc < 2 || (strcmp(argv[i+1], "32") != 0 && strcmp(argv[i+1], "64") != 0))
+                {
+                    bad_args = true;
+                    break;
+                }
+                fingerprint_bits = atoi(argv[i+1]);
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-bitmap") == 0)
+            {
+                // flag for maximal size of bitmap of generated states
+                if(argc < 2 || !isNumber(argv[i+1]))
+                {
+                    bad_args = true;
+                    break;
+                }
+                bitmap_budget = atol(argv[i+1]);
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-capacity") == 0 || strcmp(argv[i], "-load") == 0)
+            {
+                // flags to tune table with generated states
+                if(argc < 2 || !isNumber(argv[i+1]))
+                {
+                    bad_args = true;
+                    break;
+                }
+                if(strcmp(argv[i], "-capacity") == 0)
+                {
+                    capacity = atol(argv[i+1]);
+                }
+                else
+                {
+                    max_load = atoi(argv[i+1]);
+                    if(max_load < 10 || max_load > 95)
+                    {
+                        bad_args = true;
+                        break;
+                    }
+                }
+                --argc;
+                i+=2;
+            }
+            else if(isInteger(argv[i]))
+            {
+                // value of next parameter of program in order of text
+                arguments.push_back(atoi(argv[i]));
+                ++i;
             }
             else
             {
@@ -339,6 +1154,120 @@ int main(int argc, char** argv)
         cout<<Info<<endl;
         return 1;
     }
-    StateMaker state_maker(filename, count_flag);
-    state_maker.PrintStates(f_a, f_b, g_a, g_b);
+    if((bitstate_size > 0 || fingerprint_bits > 0) && threads > 1)
+    {
+        // table, shared by threads, stores states exactly
+        cerr<<"Bit array and fingerprints of states aren't supported with several threads"<<endl;
+        return 1;
+    }
+    if(capacity == 0)
+        capacity = threads > 1 ? DefaultSharedCapacity : DefaultStatesCapacity;
+    if(por && threads > 1)
+    {
+        cerr<<"Partial-order reduction isn't supported with several threads"<<endl;
+        por = false;
+    }
+    if(stateless_depth > 0 && (threads > 1 || por || symmetry))
+    {
+        cerr<<"Exploration without generated states is done by one thread with its own reduction"<<endl;
+        threads = 1;
+        por = false;
+        symmetry = false;
+    }
+    if(symbolic && (threads > 1 || por || stateless_depth > 0))
+    {
+        cerr<<"Exploration with symbolic parameters is done by one thread without partial-order reduction"<<endl;
+        threads = 1;
+        por = false;
+        stateless_depth = 0;
+    }
+    if(check && TurnOffForCheck(symbolic || stateless_depth > 0 || !sweep.empty(), "symbolic parameters and binary file",
+                                threads, por, symmetry, liveness, blocks, projection, dump_filename))
+    {
+        symbolic = false;
+        stateless_depth = 0;
+        sweep.clear();
+    }
+    if(ltl && (check || threads > 1 || por || symmetry || liveness || blocks || symbolic || stateless_depth > 0 ||
+               !sweep.empty() || dump_filename))
+    {
+        cerr<<"Formula is checked by one thread on all states of program without reductions,"
+              " invariant and binary file"<<endl;
+        check = NULL;
+        threads = 1;
+        por = false;
+        symmetry = false;
+        liveness = false;
+        blocks = false;
+        symbolic = false;
+        stateless_depth = 0;
+        sweep.clear();
+        dump_filename = NULL;
+    }
+    if(components && (ltl || check || threads > 1 || por || symmetry || liveness || blocks || symbolic ||
+                      stateless_depth > 0 || !sweep.empty() || dump_filename))
+    {
+        cerr<<"Components are found by one thread on all states of program without reductions,"
+              " formula, invariant and binary file"<<endl;
+        ltl = NULL;
+        check = NULL;
+        threads = 1;
+        por = false;
+        symmetry = false;
+        liveness = false;
+        blocks = false;
+        symbolic = false;
+        stateless_depth = 0;
+        sweep.clear();
+        dump_filename = NULL;
+    }
+    if(blocks && (symbolic || stateless_depth > 0 || !sweep.empty()))
+    {
+        cerr<<"Local steps are fused only by exploration with generated states"<<endl;
+        blocks = false;
+    }
+#ifdef MODEL
+    // steps of model are compiled for one program with its values and replicas
+    map<string, size_t> model_replicas;
+    ParseReplicas(MODEL_NAME::Replicas(), model_replicas);
+    if(arguments.empty())
+        arguments = MODEL_NAME::Arguments();
+    if(replicas.empty())
+        replicas = model_replicas;
+    if(strcmp(program_filename, MODEL_NAME::Source()) != 0 || arguments != MODEL_NAME::Arguments() ||
+       replicas != model_replicas || symbolic || !sweep.empty())
+    {
+        cerr<<"Binary explores only "<<MODEL_NAME::Source()<<" with values and replicas of its model,"
+              " without symbolic parameters and sweep"<<endl;
+        return 1;
+    }
+#endif
+    Program program;
+    if(!sweep.empty())
+        return Sweep(program, program_filename, arguments, replicas, sweep, threads, sweep_merge, filename, count_flag);
+    if(!program.Load(program_filename, arguments, replicas, symbolic ? &range : NULL))
+        return 1;
+    if(domains)
+        program.PrintDomains(cout);
+    if(components)
+        return AnalyzeComponents(program, capacity, filename);
+    if(ltl)
+        return CheckFormula(program, ltl, fair, capacity, filename, count_flag);
+    Invariant invariant;
+    if(check && !invariant.Parse(program.Layout(), check))
+        return 1;
+    if(blocks && !program.FuseLocalSteps(breakpoints))
+    {
+        cerr<<"Bad list of breakpoints"<<endl;
+        return 1;
+    }
+    if(symmetry && !program.Symmetric())
+        cerr<<"Program has no replicated functions, symmetry reduction does nothing"<<endl;
+    StateMaker state_maker(program, filename, count_flag, count_full, dump_filename, delta, sync, order, stateless_depth > 0 ? 0 : capacity,
+                           max_load / 100.0, projection, threads, por, symmetry, liveness, blocks, bitmap_budget << 20, bitstate_size,
+                           fingerprint_bits, stateless_depth);
+    if(check)
+        return state_maker.CheckStates(invariant, violations) > 0 ? 1 : 0;
+    else if(!state_maker.PrintStates())
+        return 1;
 }
@@ -10,194 +10,319 @@
 
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <utility>
-#include <set>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+#include "concurrent_store.h"
+#include "frontier.h"
+#include "invariant_checker.h"
+#include "output_writer.h"
+#include "parallel_explorer.h"
+#include "program.h"
+#include "state_codec.h"
+#include "state_dump.h"
+#include "state_set.h"
+#include "stateless_explorer.h"
+#include "successors.h"
+#include "visited_store.h"
 /**
- * @brief structure to store vars of functions
+ * @brief class for getting all states of C program.
  */
-class IntVariable
+class StateMaker
 {
 public:
 /**
- * @brief default constructor
+ * @brief class constructor
+ * @param program - program of threads, which is explored
+ * @param filename - name of output file
+ * @param count flag - flag, indicates if need print states number
+ * @param dump_filename - name of binary file for states instead of text, NULL
+ * to print text
+ * @param delta - flag, indicates if records of binary file are compressed
+ * @param sync - flag, indicates if every printed state is flushed at once
+ * @param order - order of states exploration
+ * @param capacity - number of states, allocated before exploration
+ * @param max_load - maximal load factor of table with generated states
+ * @param projection - comma separated names of variables, which differ states,
+ * NULL to differ states by all variables
+ * @param threads - number of exploring threads
+ * @param por - flag, indicates if partial-order reduction is used
+ * @param symmetry - flag, indicates if states, which differ by permutation of
+ * replicas of function, are merged
+ * @param liveness - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if local steps are fused with previous
+ * step of thread
+ * @param bitmap_budget - maximal size of bitmap of generated states in bytes
+ * @param bitstate_size - size of bit array for bitstate search in bytes, 0 to
+ * store states exactly
+ * @param fingerprint_bits - 32 or 64 to store only fingerprints of states, 0 to
+ * store states exactly
+ * @param stateless_depth - maximal length of schedule for exploration without
+ * set of generated states, 0 to store generated states
  */
-    IntVariable():m_value(0),m_init_flag(false){}
+    StateMaker(const Program& program, char* filename, bool count_flag, bool count_full, const char* dump_filename, bool delta, bool sync, SearchOrder order,
+               size_t capacity, double max_load, const char* projection, size_t threads, bool por,
+               bool symmetry, bool liveness, bool blocks, size_t bitmap_budget, size_t bitstate_size, unsigned int fingerprint_bits, size_t stateless_depth);
 /**
- * @brief Assigment operator <IntVar> = <IntVar>
- * @param right right part of assigment operator
- * @return self object
+ * @brief class destructor
  */
-    IntVariable& operator=(const IntVariable & right)
-    {
-        this->m_value = right.m_value;
-        this->m_init_flag = right.m_init_flag;
-        return *this;
-    }
-
+    ~StateMaker();
 /**
- * @brief Assigment operator <IntVar> = <Int>
- * @param right right part of assigment operator
- * @return self object
+ * @brief generate and print states in console or file
+ * @return false if table of states, shared by threads, is full, so some
+ * states are lost
  */
-    IntVariable& operator=(int right)
-    {
-        this->m_value = right;
-        this->m_init_flag = true;
-        return *this;
-    }
+    bool PrintStates();
 
 /**
- * @brief overloaded output operator for IntVariable
- * @param stream output stream
- * @param right object to printing
- * @return Reference to stream
+ * @brief generates states until invariant is violated, prints traces from
+ * initial state to violating states instead of states
+ * @param invariant - property of all states
+ * @param limit - number of violations, after which exploration is stopped
+ * @return number of found violations
  */
-    friend std::ostream& operator<<(std::ostream& stream, const IntVariable& right);
-
+    size_t CheckStates(const Invariant& invariant, size_t limit);
+private:
 /**
- * @brief operator less
- * @param right - right part of operator
+ * @brief number of generated states
  */
-    const bool operator<(const IntVariable& right) const
-    {
-        if(m_init_flag == right.m_init_flag)
-            return m_value < right.m_value;
-        return false;
-    }
-private:
+  unsigned int m_states_number;
+/** 
+ * @brief flag, indicates if need print states number
+ */
+  unsigned int m_count_flag;
 /**
- * @brief stored value
+ * @brief flag, indicates if states without reductions are counted by
+ * additional exploration
  */
-    int m_value;
-
+  bool m_count_full;
 /**
- * @brief indicates initialization of variable
+ * @brief flag, indicates if output should be to file
  */
-    bool m_init_flag;
-};
-struct FuncVars
-{
-    IntVariable a;
-    IntVariable b;
-    IntVariable x;
-    IntVariable y;
-    unsigned int counter;
-};
-
+    bool m_to_file_flag;
+/**
+ * @brief stream for output file
+ */
+    std::ofstream m_file;
 /**
- * @brief class to differ states in set
+ * @brief buffered writer of printed states
  */
-class StateDiff
-{
-public:
+    OutputWriter* m_writer;
 /**
- * @brief class constructor
- * @param fCounter - counter of f
- * @param gCounter - counter of g
- * @param h - value of global variable
+ * @brief flag, indicates if states are written to binary file
  */
-    StateDiff(unsigned int fCounter, unsigned int gCounter, IntVariable h):m_fCounter(fCounter),m_gCounter(gCounter),m_h(h){}
-
+    bool m_dump;
 /**
- * @brief operator less
- * @param right - right part of operator
- * @return true if left < right, false otherwise
+ * @brief stream for binary file of states
  */
-const bool operator< (const StateDiff& right) const
-{
-    if (m_fCounter < right.m_fCounter) return true;
-    if (m_fCounter > right.m_fCounter) return false;
-    
-    if (m_gCounter < right.m_gCounter) return true;
-    if (m_gCounter > right.m_gCounter) return false;
+    std::ofstream m_dump_file;
+/**
+ * @brief program of threads, which is explored
+ */
+    const Program& m_program;
+/**
+ * @brief placement of variables in packed state
+ */
+    StateLayout m_layout;
+/**
+ * @brief mask of fields, which differ states in set
+ */
+    PackedState m_key_mask;
+/** 
+ * @brief stores pairs of counters, already generated by program
+ */
+    StateSet* m_old;
+/**
+ * @brief states, waiting for exploration
+ */
+    Frontier<PackedState> m_frontier;
+/**
+ * @brief number of exploring threads
+ */
+    size_t m_threads;
+/**
+ * @brief stores states, generated by several threads
+ */
+    ConcurrentStore m_shared_old;
+/**
+ * @brief output of threads, waiting for printing
+ */
+    std::vector<std::string> m_buffers;
+/**
+ * @brief encoders of binary records, one for every thread
+ */
+    std::vector<DumpEncoder> m_encoders;
+/**
+ * @brief guard of output stream
+ */
+    std::mutex m_output_mutex;
+/**
+ * @brief flag, indicates if partial-order reduction is used
+ */
+    bool m_por;
+/**
+ * @brief flag, indicates if states are canonicalized by symmetry of replicas
+ */
+    bool m_symmetry;
+/**
+ * @brief flag, indicates if dead local variables are reset after steps
+ */
+    bool m_liveness;
+/**
+ * @brief flag, indicates if local steps are done with previous step of thread
+ */
+    bool m_blocks;
+/**
+ * @brief mask of fields, which aren't reset even if dead
+ */
+    PackedState m_kept;
+/**
+ * @brief number of states, where only one thread made step
+ */
+    size_t m_reduced_states;
+/**
+ * @brief maximal length of schedule for exploration without set of
+ * generated states, 0 if generated states are stored
+ */
+    size_t m_stateless_depth;
+/**
+ * @brief numbers of abstract states by intervals of parameters
+ */
+    std::map<std::vector<int>, size_t> m_inputs;
+/** 
+ * @brief generates and prints all states after specified state
+ * @param initial - packed state of program
+ */
+    void GenerateStates(const PackedState& initial);
 
-    return m_h < right.m_h;
-}
+/** 
+ * @brief generates and prints all states after specified state by several threads
+ * @param initial - packed state of program
+ */
+    void GenerateStatesParallel(const PackedState& initial);
 
-private:
 /**
- * @brief counter of function f
+ * @brief explores all schedules of threads without set of generated states,
+ * prints final state of every explored schedule
+ * @param initial - packed state of program
  */
-    unsigned int m_fCounter;
+    void GenerateSchedules(const PackedState& initial);
 
 /**
- * @brief counter of function g
+ * @brief generates and prints all abstract states after specified state,
+ * parameters of program are intervals, which are split by steps
+ * @param initial - packed state of program
  */
-    unsigned int m_gCounter;
+    void GenerateSymbolic(const PackedState& initial);
 
 /**
- * @brief global variable
+ * @brief prints intervals of parameters, which abstract states cover, and
+ * numbers of states of every combination
  */
-    IntVariable m_h;
-};
+    void PrintInputs();
+
 /**
- * @brief class for getting all states of C program.
+ * @brief number of threads for stateless exploration
  */
-class StateMaker
-{
-public:
+    size_t Threads() const
+    {
+        return m_program.Threads();
+    }
+
 /**
- * @brief class constructor
- * @param filename - name of output file
- * @param count flag - flag, indicates if need print states number
+ * @brief checks if thread can do step
+ * @param state - state of program
+ * @param thread - number of thread
  */
-    StateMaker(char* filename, bool count_flag);
+    bool Enabled(const PackedState& state, size_t thread) const;
+
 /**
- * @brief class destructor
+ * @brief variables, accessed by next step of thread
+ * @param state - state of program
+ * @param thread - number of thread
  */
-    ~StateMaker();
+    const Access& Next(const PackedState& state, size_t thread) const;
+
 /**
- * @brief generate and print states in console or file
- * @param f_a initial value of f::a
- * @param f_b initial value of f::b
- * @param g_a initial value of g::a
- * @param g_b initial value of g::b
+ * @brief do step by thread
+ * @param state - state of program, changed in place
+ * @param thread - number of thread
  */
-    void PrintStates(int f_a, int f_b, int g_a, int g_b);
-private:
+    void Step(PackedState& state, size_t thread);
+
 /**
- * @brief number of generated states
+ * @brief prints final state of explored schedule
+ * @param state - state of program
  */
-  unsigned int m_states_number;
-/** 
- * @brief flag, indicates if need print states number
+    void Finish(const PackedState& state);
+
+/**
+ * @brief stores and prints state, generated by thread, and makes its successors
+ * @param worker - number of thread
+ * @param state - generated state
+ * @param next - place for successors
  */
-  unsigned int m_count_flag;
+    void Expand(size_t worker, const PackedState& state, std::vector<PackedState>& next);
+
 /**
- * @brief flag, indicates if output should be to file
+ * @brief prints generated state by single thread
+ * @param state - state of program
  */
-    bool m_to_file_flag;
+    void PrintState(const PackedState& state);
+
 /**
- * @brief stream for output file
+ * @brief adds generated state to output of thread
+ * @param worker - number of thread
+ * @param state - state of program
  */
-    std::ofstream m_file;
-/** 
- * @brief stores pairs of counters, already generated by program
+    void AppendState(size_t worker, const PackedState& state);
+
+/**
+ * @brief writes all printed states, binary file gets number of records
+ * @param records - number of printed states
  */
-    std::set<StateDiff> m_old;
-/** 
- * @brief generates and prints all states after state, described by f, g and h
- * @param f - state of function f
- * @param g - state of function g
- * @param h - value of global variable
+    void FinishOutput(uint64_t records);
+
+/**
+ * @brief prints output of thread
+ * @param worker - number of thread
+ */
+    void Flush(size_t worker);
+
+/**
+ * @brief counts states, generated without partial-order reduction
+ * @param initial - packed state of program
+ * @param live - flag, indicates if dead local variables are reset
  */
-    void GenerateStates(FuncVars f, FuncVars g, IntVariable h);
+    size_t CountFullStates(const PackedState& initial, bool live);
 
 /**
- * @brief do step by f code
- * @param f - state of function f
- * @param g - state of function g
- * @param h - state of global variable
+ * @brief prints numbers of states, which are merged by reset of every dead
+ * variable
+ * @param initial - packed state of program
  */
-    void StepInF(FuncVars f, FuncVars g, IntVariable h);
+    void PrintSavedStates(const PackedState& initial);
 
 /**
- * @brief do step by g code
- * @param f - state of function f
- * @param g - state of function g
- * @param h - state of global variable
+ * @brief makes successors of state in order of threads
+ * @param state - state of program
+ * @param next - place for MaxThreads successors
+ * @param reduce - flag, indicates if only ample set of steps is taken
+ * @param symmetric - flag, indicates if successors are canonicalized
+ * @param live - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if fused local steps are done at once
+ * @return number of successors
  */
-    void StepInG(FuncVars f, FuncVars g, IntVariable h);
+    size_t Successors(const PackedState& state, PackedState* next, bool reduce, bool symmetric, bool live, bool blocks);
+
+
+
+
+    friend class ParallelExplorer<PackedState, StateMaker>;
+    friend class StatelessExplorer<StateMaker>;
 // Copy isn't allowed
     StateMaker(StateMaker&);
     StateMaker& operator=(StateMaker&);
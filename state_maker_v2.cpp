@@ -10,13 +10,65 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <math.h>
 #include <ctype.h> 
 using namespace std;
 
-const char* Info = "Usage: <binary name> <f::a> <f::b> <g::a> <g::b>\n"
+const char* Info = "Usage: <binary name> [values of parameters]\n"
+                   "Values are integers, which are given to parameters of functions in order\n"
+                   "of text, for example f::a f::b g::a g::b of task.txt, missing values are 0\n"
                    "Allowed flags:\n"
                    "-count: prints number of states in console\n"
-                   "-file <out file>: redirect output to specified file\n\n"
+                   "-count-full: -count, and with reductions also number of states without\n"
+                   "    them, which is found by additional exploration\n"
+                   "-file <out file>: redirect output to specified file\n"
+                   "-program <file>: C program of threads (task.txt by default)\n"
+                   "-dump <file>: write states to binary file instead of text, it is read\n"
+                   "    by state_query\n"
+                   "-delta: compress records of binary file by differences of states\n"
+                   "-sync: flush every printed line at once (output is buffered and\n"
+                   "    written by background thread by default)\n"
+                   "-lts <lts file>: print labelled transition system in dot format\n"
+                   "-lts-format <dot|aut|binary>: format of lts file, Aldebaran text or\n"
+                   "    binary edge list for big systems (dot by default)\n"
+                   "-bfs: explore states in breadth-first order (depth-first by default)\n"
+                   "-por: partial-order reduction, only one of independent steps of f and g\n"
+                   "    is taken, deadlocks and local states of threads are kept\n"
+                   "-replicate <functions>: run several threads of function, for example\n"
+                   "    worker=4,f=2 makes threads worker[0]..worker[3], f[0], f[1]\n"
+                   "-liveness: reset local variables, which aren't read before next\n"
+                   "    assignment, to uninitialized, so states, which differ only by them,\n"
+                   "    are merged, -count-full prints states saved by every variable\n"
+                   "-check <invariant>: stop at first state, where invariant doesn't hold,\n"
+                   "    and print trace of steps to it instead of states, for example\n"
+                   "    'h<7 && (f.counter!=3 || g.y==#)', reductions and projection are\n"
+                   "    turned off, exit status is 1 if invariant is violated\n"
+                   "-violations <number>: stop -check after number of violations, every\n"
+                   "    violating state gets its trace (1 by default)\n"
+                   "-blocks: local steps of thread, which access only its variables, are\n"
+                   "    done at once with its previous step, so they aren't points of\n"
+                   "    scheduling, -count prints number of removed points\n"
+                   "-break <points>: keep points of scheduling before listed steps with\n"
+                   "    -blocks, for example f:3,g:7, where numbers are program counters\n"
+                   "-domains: print ranges of variables and number of dead transitions,\n"
+                   "    which are found by analysis of program before exploration\n"
+                   "-symmetry: symmetry reduction, states, which differ only by permutation\n"
+                   "    of replicas of function, are explored once\n"
+                   "-threads <number>: explore states by several threads, order of states\n"
+                   "    in output isn't determined\n"
+                   "-capacity <states>: number of states, allocated before exploration,\n"
+                   "    maximal number of states with -threads\n"
+                   "-load <percent>: maximal load of table with generated states, 10..95\n"
+                   "-bitstate <MB>: store states as bits of array of specified size, some\n"
+                   "    states can be lost, coverage is estimated, not allowed with -threads\n"
+                   "-compact <32|64>: store only fingerprints of states of specified bits,\n"
+                   "    some states can be lost, collision probability is estimated, not\n"
+                   "    allowed with -threads\n"
+                   "-bitmap <MB>: maximal size of bitmap with bit for every possible state,\n"
+                   "    which is used instead of table, if domains of variables are small\n"
+                   "    enough, 0 to use table always (64 by default)\n"
+                   "-project <vars>: differ states only by listed variables, for example\n"
+                   "    f.counter,g.counter,h (all variables by default)\n\n"
                    "Author: Valery Bitsoev. March 2013\n";
 /**
  * @brief checks is string consist of only digits
@@ -29,44 +81,146 @@ bool isNumber(char * string)
             return false;
     return true;
 }
+
 /**
- * @brief overloaded output operator for IntVariable
- * @param stream - output stream
- * @param right - object to print
- * @return reference to stream
+ * @brief checks is string integer: digits with optional minus before them
+ * @param string - string to check
  */
-ostream& operator<<(ostream& stream, const IntVariable& right)
+bool isInteger(char * string)
 {
-    if(right.m_init_flag)
-    {
-        stream<<right.m_value;
-    }
-    else
-    {
-        stream<<"#";
-    }
-    return stream;
+    if(string[0] == '-')
+        ++string;
+    return string[0] != '\0' && isNumber(string);
 }
 
+/**
+ * @brief number of frontier items, allocated before exploration
+ */
+const size_t FrontierCapacity = 1024;
+
+/**
+ * @brief default number of states, allocated before exploration
+ */
+const size_t DefaultStatesCapacity = 1024;
+
+/**
+ * @brief default load factor of table with generated states, in percents
+ */
+const int DefaultMaxLoad = 70;
+
+/**
+ * @brief default number of states, which table shared by threads can store
+ */
+const size_t DefaultSharedCapacity = 1 << 22;
+
+/**
+ * @brief default maximal size of bitmap of generated states, in megabytes
+ */
+const size_t DefaultBitmapBudget = 64;
+
+/**
+ * @brief size of thread output, which is printed at once
+ */
+const size_t OutputBufferSize = 1 << 16;
+
+/**
+ * @brief colors of transitions of threads in dot format
+ */
+const char* const ThreadColors[] = {"red", "blue", "darkgreen", "orange", "purple", "brown"};
+
 /**
  * @brief class constructor
+ * @param program - program of threads, which is explored
  * @param filename - name of output file
  * @param count_flag - flag, indicates if need print state number
+ * @param count_full - flag, indicates if states without reductions are
+ * counted by additional exploration
+ * @param dump_filename - name of binary file for states instead of text, NULL
+ * to print text
+ * @param delta - flag, indicates if records of binary file are compressed
+ * @param sync - flag, indicates if every printed line is flushed at once
+ * @param lts_filename - name of lts file
+ * @param lts_format - format of lts file
+ * @param order - order of states exploration
+ * @param capacity - number of states, allocated before exploration
+ * @param max_load - maximal load factor of table with generated states
+ * @param projection - comma separated names of variables, which differ states,
+ * NULL to differ states by all variables
+ * @param threads - number of exploring threads
+ * @param por - flag, indicates if partial-order reduction is used
+ * @param symmetry - flag, indicates if states, which differ by permutation of
+ * replicas of function, are merged
+ * @param liveness - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if local steps are fused with previous
+ * step of thread
+ * @param bitmap_budget - maximal size of bitmap of generated states in bytes
+ * @param bitstate_size - size of bit array for bitstate search in bytes, 0 to
+ * store states exactly
+ * @param fingerprint_bits - 32 or 64 to store only fingerprints of states, 0 to
+ * store states exactly
  */
-StateMaker::StateMaker(char* filename, bool count_flag, char* lts_filename): m_states_number(0)
+StateMaker::StateMaker(const Program& program, char* filename, bool count_flag, bool count_full, const char* dump_filename, bool delta, bool sync,
+                       char* lts_filename, LtsFormat lts_format, SearchOrder order, size_t capacity, double max_load, const char* projection,
+                       size_t threads, bool por, bool symmetry, bool liveness, bool blocks, size_t bitmap_budget,
+                       size_t bitstate_size, unsigned int fingerprint_bits): m_states_number(0)
                                       , m_count_flag(count_flag) 
+                                      , m_count_full(count_full)
                                       , m_file(filename)
-                                      , m_old()
+                                      , m_writer(NULL)
+                                      , m_dump(false)
+                                      , m_dump_file()
+                                      , m_program(program)
+                                      , m_layout(program.Layout())
+                                      , m_old(NULL)
                                       , m_lts(false)
-                                      , m_lts_file(lts_filename)
+                                      , m_lts_file()
+                                      , m_lts_writer(NULL)
+                                      , m_frontier(order, FrontierCapacity)
+                                      , m_threads(threads)
+                                      , m_shared_old(m_layout.Words(), threads > 1 ? capacity : 0)
+                                      , m_buffers(threads > 1 ? threads : 0)
+                                      , m_encoders(threads, DumpEncoder(m_layout.Words(), delta))
+                                      , m_lts_buffers(threads > 1 ? threads : 0)
+                                      , m_output_mutex()
+                                      , m_por(por)
+                                      , m_symmetry(symmetry)
+                                      , m_liveness(liveness)
+                                      , m_blocks(blocks)
+                                      , m_kept()
+                                      , m_reduced_states(0)
 {
-    if(!filename)
+    m_layout.Clear(m_kept);
+    // states are differed by all variables, unless projection is specified
+    vector<size_t> key_fields;
+    if(projection && !m_layout.Find(projection, key_fields))
+    {
+        cerr<<"Unknown variable in projection, states are differed by all variables"<<endl;
+        projection = NULL;
+    }
+    if(!projection)
+    {
+        key_fields.clear();
+        for(size_t i = 0; i < m_layout.Fields(); ++i)
+            key_fields.push_back(i);
+    }
+    m_layout.Mask(key_fields, m_key_mask);
+    if(dump_filename)
+    {
+        m_dump_file.open(dump_filename, ios::binary);
+        if(!m_dump_file)
+            cerr<<"Can't open binary file, states are printed as text"<<endl;
+        else
+            m_dump = true;
+    }
+    if(!filename && !m_dump)
     {
         m_file.open("states.txt");
     }
     if(lts_filename)
     {
-        if(m_lts_file.bad())
+        // aut and binary headers are rewritten at the end, so file is binary
+        m_lts_file.open(lts_filename, ios::binary);
+        if(!m_lts_file)
         {
             // filename specified, but can't open file for write
             cerr<<"Can't create lts file"<<endl;
@@ -77,6 +231,17 @@ StateMaker::StateMaker(char* filename, bool count_flag, char* lts_filename): m_s
             m_lts = true;
         }
     }
+    // set of several threads is m_shared_old, ids of states are nodes of lts
+    m_old = MakeStateSet(m_layout, key_fields, threads > 1 ? 0 : capacity, max_load, threads > 1 ? 0 : bitmap_budget,
+                         threads > 1 ? 0 : bitstate_size, threads > 1 ? 0 : fingerprint_bits, m_lts);
+    m_writer = new OutputWriter(m_dump ? m_dump_file : m_file, sync);
+    if(m_dump)
+    {
+        AppendDumpHeader(m_writer->Buffer(), m_layout, delta);
+        m_writer->Commit();
+    }
+    if(m_lts)
+        m_lts_writer = new LtsWriter(m_lts_file, lts_format, m_layout, sync);
 }
 
 /**
@@ -84,367 +249,645 @@ StateMaker::StateMaker(char* filename, bool count_flag, char* lts_filename): m_s
  */
 StateMaker::~StateMaker()
 {
+    delete m_lts_writer;
+    delete m_writer;
+    delete m_old;
     m_file.close();
 }
 
 /**
  * @brief generates and prints states in console or file
- * @param f_a initial value of f::a
- * @param f_b initial value of f::b
- * @param g_a initial value of g::a
- * @param g_b initial value of g::b
+ * @return false if table of states, shared by threads, is full, so some
+ * states are lost
  */
-void StateMaker::PrintStates(int f_a, int f_b, int g_a, int g_b)
+bool StateMaker::PrintStates()
 {
-    // fill f data
-    FuncVars f;
-    f.a = f_a;
-    f.b = f_b;
-    f.counter = 0;
+    // parameters are constants of program, so they aren't stored in packed state
+    PackedState initial;
+    m_program.Initial(initial);
+    if(m_symmetry)
+        m_program.Canonicalize(initial);
+    // start generating
+    if(m_threads > 1)
+        GenerateStatesParallel(initial);
+    else
+        GenerateStates(initial);
+    FinishOutput(m_states_number);
+    if(m_count_flag) cout<<"Result states number: "<<m_states_number<<endl;
+    if(m_count_flag && m_threads == 1 && !m_old->Exact())
+    {
+        // states, taken for generated ones, are lost with their successors
+        double omissions = m_old->Omissions();
+        cout<<"Estimated coverage: "<<100.0 * m_states_number / (m_states_number + omissions)<<"%"<<endl;
+        cout<<"Collision probability: "<<1 - exp(-omissions)<<endl;
+    }
+    if(m_count_flag && m_por)
+        cout<<"States with reduced steps: "<<m_reduced_states<<endl;
+    if(m_count_flag && m_blocks)
+        cout<<"Removed scheduling points: "<<m_program.FusedPoints()<<endl;
+    if(m_count_full && (m_por || m_symmetry || m_liveness || m_blocks))
+    {
+        m_program.Initial(initial);
+        cout<<"States number without reduction: "<<CountFullStates(initial, false)<<endl;
+    }
+    if(m_count_full && m_liveness)
+        PrintSavedStates(initial);
+    if (m_lts)
+        m_lts_writer->Finish();
+    return m_threads == 1 || !m_shared_old.Full();
+}
 
-    // fill g data
-    FuncVars g;
-    g.a = g_a;
-    g.b = g.b;
-    g.counter = 0;
+/** 
+ * @brief generates and prints all states after specified state
+ * @param initial - packed state of program
+ */
+void StateMaker::GenerateStates(const PackedState& initial)
+{
+    State state;
+    state.packed = initial;
+    state.from = 0;
+    state.thread = NULL;
+    state.label = NULL;
+    state.color = NULL;
+    m_frontier.Push(state);
+    while(!m_frontier.Empty())
+    {
+        m_frontier.Pop(state);
+        // ids are stored only for lts
+        size_t id = 0;
+        bool is_new = m_lts ? m_old->FindOrInsert(state.packed, id) : m_old->FindOrInsert(state.packed);
+        if(m_lts)
+            PrintLts(state, id, is_new);
+        if(!is_new)
+            continue;
+        ++m_states_number;
+        // print to file
+        PrintState(state.packed);
+        State next[MaxThreads];
+        size_t number = Successors(state, next, m_por, m_symmetry, m_liveness, m_blocks);
+        // successors of first thread are taken first in both orders
+        for(size_t i = 0; i < number; ++i)
+        {
+            State& successor = next[m_frontier.Order() == DFS_ORDER ? number - 1 - i : i];
+            successor.from = id;
+            m_frontier.Push(successor);
+        }
+    }
+}
 
-    // global variable
-    IntVariable h;
-    if (m_lts)
+/** 
+ * @brief generates and prints all states after specified state by several threads
+ * @param initial - packed state of program
+ */
+void StateMaker::GenerateStatesParallel(const PackedState& initial)
+{
+    State state;
+    state.packed = initial;
+    state.from = 0;
+    state.thread = NULL;
+    state.label = NULL;
+    state.color = NULL;
+    ParallelExplorer<State, StateMaker> explorer(*this, m_threads);
+    explorer.Run(state);
+    for(size_t i = 0; i < m_threads; ++i)
+        Flush(i);
+    m_states_number = m_shared_old.Size();
+    if(m_shared_old.Full())
+        cerr<<"Table of generated states is full, states after it are lost, increase -capacity"<<endl;
+}
+
+/**
+ * @brief stores and prints state, generated by thread, and makes its successors
+ * @param worker - number of thread
+ * @param state - generated state
+ * @param next - place for successors
+ */
+void StateMaker::Expand(size_t worker, const State& state, vector<State>& next)
+{
+    PackedState key;
+    MaskState(state.packed, m_key_mask, key);
+    size_t id;
+    bool is_new = m_shared_old.FindOrInsert(key.words, id);
+    if(m_lts && !m_shared_old.Full())
     {
-        m_lts_file<<"digraph G{"<<endl;
+        LtsRecord record = {state, id, is_new};
+        m_lts_buffers[worker].push_back(record);
     }
-    // start generating
-    GenerateStates(f, g, h);
-    if(m_count_flag) cout<<"Result states number: "<<m_states_number<<endl;
-    if (m_lts)
+    if(is_new)
     {
-        m_lts_file<<"}"<<endl;
+        AppendState(worker, state.packed);
+        State successors[MaxThreads];
+        size_t number = Successors(state, successors, false, m_symmetry, m_liveness, m_blocks);
+        for(size_t i = 0; i < number; ++i)
+            successors[i].from = id;
+        next.insert(next.end(), successors, successors + number);
     }
+    if(m_buffers[worker].size() > OutputBufferSize || m_lts_buffers[worker].size() * sizeof(LtsRecord) > OutputBufferSize)
+        Flush(worker);
 }
 
+/**
+ * @brief prints generated state by single thread
+ * @param state - state of program
+ */
+void StateMaker::PrintState(const PackedState& state)
+{
+    if(m_dump)
+    {
+        m_encoders[0].Append(m_writer->Buffer(), state);
+        m_writer->Commit();
+    }
+    else
+    {
+        m_layout.Print(m_writer->Buffer(), state, ", ");
+        m_writer->EndLine();
+    }
+}
 
-int StateMaker::CalcHash(unsigned int fcounter, unsigned int gcounter, IntVariable h)
+/**
+ * @brief adds generated state to output of thread
+ * @param worker - number of thread
+ * @param state - state of program
+ */
+void StateMaker::AppendState(size_t worker, const PackedState& state)
 {
-    int tmp;
-    if (!h.m_init_flag)
-        tmp = 19;
+    if(m_dump)
+    {
+        m_encoders[worker].Append(m_buffers[worker], state);
+    }
     else
-        tmp = h.m_value;
-    return tmp + fcounter*20 + gcounter*20*20;
+    {
+        m_layout.Print(m_buffers[worker], state, ", ");
+        m_buffers[worker] += '\n';
+    }
 }
-/** 
- * @brief generates and prints all states after state described by f, g and h
- * @param f - state of function f
- * @param g - state of function g
- * @param h - state of global variable
+
+/**
+ * @brief writes all printed states, binary file gets number of records
+ * @param records - number of printed states
  */
-void StateMaker::GenerateStates(FuncVars f, FuncVars g, IntVariable h)
+void StateMaker::FinishOutput(uint64_t records)
 {
-    if(m_old.count(StateDiff(f.counter, g.counter, h))!=0)
-        return;
-    m_old.insert(StateDiff(f.counter, g.counter, h));
+    if(m_dump && m_threads == 1)
+        m_encoders[0].EndBlock(m_writer->Buffer());
+    m_writer->Finish();
+    if(m_dump)
+        WriteDumpRecords(m_dump_file, records);
+}
+
+/**
+ * @brief prints output of thread
+ * @param worker - number of thread
+ */
+void StateMaker::Flush(size_t worker)
+{
+    lock_guard<mutex> lock(m_output_mutex);
+    if(m_dump)
+        m_encoders[worker].EndBlock(m_buffers[worker]);
+    m_writer->Write(m_buffers[worker]);
+    m_buffers[worker].clear();
     if(m_lts)
     {
-        m_lts_file<<"    "<<CalcHash(f.counter, g.counter, h)<<" [label=\""<<f.counter<<" ";
-        m_lts_file<<g.counter<<" "<<h<<" "<<f.x<<" "<<f.y<<" "<<g.x<<" "<<g.y<<"\"];"<<endl;
+        const vector<LtsRecord>& records = m_lts_buffers[worker];
+        for(size_t i = 0; i < records.size(); ++i)
+            PrintLts(records[i].state, records[i].id, records[i].is_new);
+        m_lts_buffers[worker].clear();
     }
-    ++m_states_number;
-    // print to file
-    m_file<<f.counter<<", "<<g.counter<<", "<<h<<", "<<f.x<<", "<<f.y<<", "<<g.x<<", "<<g.y<<endl;
-    // activated thread with f
-    if(f.counter < 11) StepInF(f,g,h);
-    // activated thread with g
-    if(g.counter < 17) StepInG(f,g,h);
 }
 
 /**
- * @brief do step by f code
- * @param f - state of function f
- * @param g - state of function g
- * @param g - state of global variable
+ * @brief prints transition to state and state itself in lts format
+ * @param state - generated state
+ * @param id - id of state
+ * @param is_new - flag, indicates if state wasn't generated before
  */
-void StateMaker::StepInF(FuncVars f, FuncVars g, IntVariable h)
+void StateMaker::PrintLts(const State& state, size_t id, bool is_new)
 {
-    if(m_lts)
+    if(state.label)
+        m_lts_writer->Edge(state.from, id, state.thread, state.label, state.color);
+    if(is_new)
+        m_lts_writer->Node(id, state.packed);
+}
+
+/**
+ * @brief counts states, generated without partial-order reduction
+ * @param initial - packed state of program
+ * @param live - flag, indicates if dead local variables are reset
+ */
+size_t StateMaker::CountFullStates(const PackedState& initial, bool live)
+{
+    VisitedStore old(m_layout.Words(), m_old->Size(), DefaultMaxLoad / 100.0);
+    Frontier<State> frontier(DFS_ORDER, FrontierCapacity);
+    State state;
+    state.packed = initial;
+    state.from = 0;
+    state.thread = NULL;
+    state.label = NULL;
+    state.color = NULL;
+    PackedState key;
+    frontier.Push(state);
+    while(!frontier.Empty())
+    {
+        frontier.Pop(state);
+        MaskState(state.packed, m_key_mask, key);
+        if(!old.FindOrInsert(key.words))
+            continue;
+        State next[MaxThreads];
+        size_t number = Successors(state, next, false, false, live, false);
+        for(size_t i = 0; i < number; ++i)
+            frontier.Push(next[i]);
+    }
+    return old.Size();
+}
+
+/**
+ * @brief prints numbers of states, which are merged by reset of every dead
+ * variable
+ * @param initial - packed state of program
+ */
+void StateMaker::PrintSavedStates(const PackedState& initial)
+{
+    size_t states = CountFullStates(initial, true);
+    for(size_t i = 0; i < m_layout.Fields(); ++i)
+    {
+        if(!m_program.Resettable(i))
+            continue;
+        // variable is kept, other dead variables are reset
+        vector<size_t> field(1, i);
+        m_layout.Mask(field, m_kept);
+        cout<<"States saved by dead "<<m_layout.Name(i)<<": "<<CountFullStates(initial, true) - states<<endl;
+    }
+    m_layout.Clear(m_kept);
+}
+
+/**
+ * @brief makes successors of state in order of threads
+ * @param state - state of program
+ * @param next - place for MaxThreads successors
+ * @param reduce - flag, indicates if only ample set of steps is taken
+ * @param symmetric - flag, indicates if successors are canonicalized
+ * @param live - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if fused local steps are done at once
+ * @return number of successors
+ */
+size_t StateMaker::Successors(const State& state, State* next, bool reduce, bool symmetric, bool live, bool blocks)
+{
+    Reductions reductions = {symmetric, live, blocks};
+    size_t thread;
+    next[0] = state;
+    const Transition* transition = reduce ? AmpleStep(m_program, state.packed, *m_old, reductions, m_kept, next[0].packed, thread) : NULL;
+    if(transition)
+    {
+        Label(next[0], thread, *transition);
+        ++m_reduced_states;
+        return 1;
+    }
+    size_t number = 0;
+    for(size_t i = 0; i < m_program.Threads(); ++i)
     {
-        m_lts_file<<"    "<<CalcHash(f.counter, g.counter, h)<<" -> ";
+        next[number] = state;
+        transition = MoveThread(m_program, next[number].packed, i, reductions, m_kept);
+        if(!transition)
+            continue;
+        Label(next[number], i, *transition);
+        ++number;
     }
-    switch(f.counter)
+    return number;
+}
+
+/**
+ * @brief generates states until invariant is violated, prints traces from
+ * initial state to violating states instead of states
+ * @param invariant - property of all states
+ * @param limit - number of violations, after which exploration is stopped
+ * @return number of found violations
+ */
+size_t StateMaker::CheckStates(const Invariant& invariant, size_t limit)
+{
+    InvariantChecker checker(m_program, invariant, *m_old, *m_writer);
+    size_t violations = checker.Run(m_frontier.Order(), limit);
+    FinishOutput(0);
+    checker.Print(m_count_flag);
+    return violations;
+}
+
+/**
+ * @brief gives state label of step, which made it
+ * @param state - successor of step
+ * @param thread - number of thread
+ * @param transition - first done transition of step
+ */
+void StateMaker::Label(State& state, size_t thread, const Transition& transition) const
+{
+    state.thread = m_program.ThreadName(thread);
+    state.label = transition.label;
+    state.color = ThreadColors[thread % (sizeof(ThreadColors) / sizeof(ThreadColors[0]))];
+}
+
+int main(int argc, char** argv)
+{
+    int i = 1;
+    bool bad_args = false;
+    char* filename = NULL;
+    char* lts_filename = NULL;
+    LtsFormat lts_format = LTS_DOT;
+    bool count_flag = false;
+    bool count_full = false;
+    bool sync = false;
+    const char* dump_filename = NULL;
+    bool delta = false;
+    SearchOrder order = DFS_ORDER;
+    size_t capacity = 0;
+    int max_load = DefaultMaxLoad;
+    size_t bitmap_budget = DefaultBitmapBudget;
+    size_t bitstate_size = 0;
+    unsigned int fingerprint_bits = 0;
+    const char* projection = NULL;
+    size_t threads = 1;
+    bool por = false;
+    bool symmetry = false;
+    bool domains = false;
+    bool liveness = false;
+    bool blocks = false;
+    const char* breakpoints = NULL;
+    const char* check = NULL;
+    size_t violations = 1;
+    map<string, size_t> replicas;
+    const char* program_filename = "task.txt";
+    vector<int> arguments;
+    //parse argv
+    if(argc > 1)
     {
-        //int x,y
-        case 0:
-            ++f.counter;
-            if(m_lts)
+        while(--argc>0)
+        {
+            if(strcmp(argv[i],"-file") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"int x,y;\" color = \"red\"];"<<endl;
+                // flag for filename
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                filename = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // x = 6
-        case 1:
-            f.x = 6;
-            ++f.counter;
-            if(m_lts)
+            else if(strcmp(argv[i],"-lts") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"x=6;\" color = \"red\"];"<<endl;
+                // flag for filename
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                lts_filename = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // y = 1
-        case 2:
-            f.y = 1;
-            ++f.counter;
-            if(m_lts)
+            else if(strcmp(argv[i],"-lts-format") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"y=1;\" color = \"red\"];"<<endl;
+                // flag for format of lts file
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                if(strcmp(argv[i+1], "dot") == 0)
+                    lts_format = LTS_DOT;
+                else if(strcmp(argv[i+1], "aut") == 0)
+                    lts_format = LTS_AUT;
+                else if(strcmp(argv[i+1], "binary") == 0)
+                    lts_format = LTS_BINARY;
+                else
+                {
+                    bad_args = true;
+                    break;
+                }
+                --argc;
+                i+=2;
             }
-            break;
-        // h = 6
-        case 3: 
-            h = 6;
-            ++f.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-count") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"h=6;\" color = \"red\"];"<<endl;
+                // flag to print states number
+                count_flag = true;
+                ++i;
             }
-            break;
-        // h = x
-        case 4:
-            h = f.x;
-            ++f.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-count-full") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"h=x;\" color = \"red\"];"<<endl;
+                // flag to count states without reductions by additional exploration
+                count_flag = true;
+                count_full = true;
+                ++i;
             }
-            break;
-        // if (y>2)
-        case 5: 
-            f.counter = 7;
-            if(m_lts)
+            else if(strcmp(argv[i], "-program") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"!(y>2);\" color = \"red\"];"<<endl;
+                // flag for file of program
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                program_filename = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // if (y<8)
-        case 7:
-            ++f.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-replicate") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"y<8;\" color = \"red\"];"<<endl;
+                // flag for numbers of threads of functions
+                if(argc < 2 || !ParseReplicas(argv[i+1], replicas))
+                {
+                    bad_args = true;
+                    break;
+                }
+                --argc;
+                i+=2;
             }
-            break;
-        // if (y>5)
-        case 8:
-            f.counter = 10;
-            if(m_lts)
+            else if(strcmp(argv[i], "-liveness") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"!(y>5);\" color = \"red\"];"<<endl;
+                // flag to reset dead local variables
+                liveness = true;
+                ++i;
             }
-            break;
-        // x = 5
-        case 10:
-            f.x = 5;
-            ++f.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-check") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"x=5;\" color = \"red\"];"<<endl;
+                // flag for invariant, which is checked during exploration
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                check = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // end of f
-        case 11:
-        // in other cases
-        default:
-            assert(!"bad f.counter value)");
-        break;
-    }
-    GenerateStates(f,g,h);
-}
-
-
-/**
- * @brief do step by g code
- * @param f - state of function f
- * @param g - state of function g
- * @param g - state of global variable
- */
-void StateMaker::StepInG(FuncVars f, FuncVars g, IntVariable h)
-{
-    if(m_lts)
-    {
-        m_lts_file<<"    "<<CalcHash(f.counter, g.counter, h)<<" -> ";
-    }
-    switch(g.counter)
-    {
-        // int x,y
-        case 0:
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-violations") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"int x,y;\" color = \"blue\"];"<<endl;
+                // flag for number of violations before stop
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
+                {
+                    bad_args = true;
+                    break;
+                }
+                violations = atol(argv[i+1]);
+                --argc;
+                i+=2;
             }
-            break;
-        // x = 9
-        case 1:
-            g.x = 9;
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-blocks") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"x = 9;\" color = \"blue\"];"<<endl;
+                // flag to fuse local steps with previous step of thread
+                blocks = true;
+                ++i;
             }
-            break;
-        // y = 0;
-        case 2:
-            g.y = 10;
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-break") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"y = 0;\" color = \"blue\"];"<<endl;
+                // flag for points of scheduling, which aren't fused
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                blocks = true;
+                breakpoints = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // h = 1
-        case 3:
-            h = 1;
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-domains") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"h = 1;\" color = \"blue\"];"<<endl;
+                // flag to print ranges of variables, found before exploration
+                domains = true;
+                ++i;
             }
-            break;
-        // if(x<2)
-        case 4:
-            g.counter = 6;
-            if(m_lts)
+            else if(strcmp(argv[i], "-symmetry") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"!(x<2);\" color = \"blue\"];"<<endl;
+                // flag to merge states with permuted replicas
+                symmetry = true;
+                ++i;
             }
-            break;
-        // h = 2
-        case 6: 
-            h = 2;
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-dump") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"h = 2;\" color = \"blue\"];"<<endl;
+                // flag for binary file of states
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                dump_filename = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // if(h>7)
-        case 7:
-            g.counter = 9;
-            if(m_lts)
+            else if(strcmp(argv[i], "-delta") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"!(h>7);\" color = \"blue\"];"<<endl;
+                // flag to compress records of binary file
+                delta = true;
+                ++i;
             }
-            break;
-        // y = 4
-        case 9: 
-            g.y = 4;
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-sync") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"y = 4;\" color = \"blue\"];"<<endl;
+                // flag to flush every printed line
+                sync = true;
+                ++i;
             }
-            break;
-        // while (x>7)
-        case 10:
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-por") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"x>7;\" color = \"blue\"];"<<endl;
+                // flag to use partial-order reduction
+                por = true;
+                ++i;
             }
-            break;
-        // if (h>0)
-        case 11:
-            ++g.counter;
-            if(m_lts)
+            else if(strcmp(argv[i], "-bfs") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"h>0;\" color = \"blue\"];"<<endl;
+                // flag to explore states in breadth-first order
+                order = BFS_ORDER;
+                ++i;
             }
-            break;
-        // break
-        case 12:
-            g.counter = 17;
-            if(m_lts)
+            else if(strcmp(argv[i], "-project") == 0)
             {
-                m_lts_file<<CalcHash(f.counter, g.counter, h)<<" [label = \"break;\" color = \"blue\"];"<<endl;
+                // flag for names of variables, which differ states
+                if(argc < 2)
+                {
+                    bad_args = true;
+                    break;
+                }
+                projection = argv[i+1];
+                --argc;
+                i+=2;
             }
-            break;
-        // end of g
-        case 17:
-        // in other cases
-        default:
-            assert(!"bad g.counter value");
-            break;
-    }
-    GenerateStates(f,g,h);
-}
-
-
-int main(int argc, char** argv)
-{
-    int i = 1;
-    bool bad_args = false;
-    char* filename = NULL;
-    char* lts_filename = NULL;
-    bool count_flag = false;
-    int f_a = 0;
-    int f_b = 0;
-    int g_a = 0;
-    int g_b = 0;
-    //parse argv
-    if(argc > 4 && argc < 11)
-    {
-        while(--argc>0)
-        {
-            if(strcmp(argv[i],"-file") == 0)
+            else if(strcmp(argv[i], "-threads") == 0)
             {
-                // flag for filename
-                if(argc < 2)
+                // flag for number of exploring threads
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
                 {
                     bad_args = true;
                     break;
                 }
-                filename = argv[i+1];
+                threads = atoi(argv[i+1]);
                 --argc;
                 i+=2;
             }
-            else if(strcmp(argv[i],"-lts") == 0)
+            else if(strcmp(argv[i], "-bitstate") == 0)
             {
-                // flag for filename
-                if(argc < 2)
+                // flag for size of bit array of bitstate search
+                if(argc < 2 || !isNumber(argv[i+1]) || atoi(argv[i+1]) < 1)
                 {
                     bad_args = true;
                     break;
                 }
-                lts_filename = argv[i+1];
+                bitstate_size = size_t(atol(argv[i+1])) << 20;
                 --argc;
                 i+=2;
             }
-            else if(strcmp(argv[i], "-count") == 0)
+            else if(strcmp(argv[i], "-compact") == 0)
             {
-                // flag to print states number
-                count_flag = true;
-                ++i;
+                // flag for bits of fingerprints of states
+                if(argc < 2 || (strcmp(argv[i+1], "32") != 0 && strcmp(argv[i+1], "64") != 0))
+                {
+                    bad_args = true;
+                    break;
+                }
+                fingerprint_bits = atoi(argv[i+1]);
+                --argc;
+                i+=2;
             }
-            else if(isNumber(argv[i]))
+            else if(strcmp(argv[i], "-bitmap") == 0)
             {
-                if(argc < 4)
+                // flag for maximal size of bitmap of generated states
+                if(argc < 2 || !isNumber(argv[i+1]))
                 {
-                    // too little args
                     bad_args = true;
                     break;
                 }
-                if(!isNumber(argv[i+1]) || !isNumber(argv[i+2]) || !isNumber(argv[i+3]))
+                bitmap_budget = atol(argv[i+1]);
+                --argc;
+                i+=2;
+            }
+            else if(strcmp(argv[i], "-capacity") == 0 || strcmp(argv[i], "-load") == 0)
+            {
+                // flags to tune table with generated states
+                if(argc < 2 || !isNumber(argv[i+1]))
                 {
-                    // should be 4 number is a row
                     bad_args = true;
                     break;
                 }
-                // fill values
-                f_a = atoi(argv[i]);
-                f_b = atoi(argv[i+1]);
-                g_a = atoi(argv[i+2]);
-                g_b = atoi(argv[i+3]);
-                argc-=3;
-                i+=4;
+                if(strcmp(argv[i], "-capacity") == 0)
+                {
+                    capacity = atol(argv[i+1]);
+                }
+                else
+                {
+                    max_load = atoi(argv[i+1]);
+                    if(max_load < 10 || max_load > 95)
+                    {
+                        bad_args = true;
+                        break;
+                    }
+                }
+                --argc;
+                i+=2;
+            }
+            else if(isInteger(argv[i]))
+            {
+                // value of next parameter of program in order of text
+                arguments.push_back(atoi(argv[i]));
+                ++i;
             }
             else
             {
@@ -464,6 +907,41 @@ int main(int argc, char** argv)
         cout<<Info<<endl;
         return 1;
     }
-    StateMaker state_maker(filename, count_flag, lts_filename);
-    state_maker.PrintStates(f_a, f_b, g_a, g_b);
+    if((bitstate_size > 0 || fingerprint_bits > 0) && threads > 1)
+    {
+        // table, shared by threads, stores states exactly
+        cerr<<"Bit array and fingerprints of states aren't supported with several threads"<<endl;
+        return 1;
+    }
+    if(capacity == 0)
+        capacity = threads > 1 ? DefaultSharedCapacity : DefaultStatesCapacity;
+    if(por && threads > 1)
+    {
+        cerr<<"Partial-order reduction isn't supported with several threads"<<endl;
+        por = false;
+    }
+    if(check && TurnOffForCheck(lts_filename != NULL, "binary file and lts", threads, por, symmetry, liveness, blocks, projection,
+                                dump_filename))
+        lts_filename = NULL;
+    Program program;
+    if(!program.Load(program_filename, arguments, replicas))
+        return 1;
+    if(domains)
+        program.PrintDomains(cout);
+    Invariant invariant;
+    if(check && !invariant.Parse(program.Layout(), check))
+        return 1;
+    if(blocks && !program.FuseLocalSteps(breakpoints))
+    {
+        cerr<<"Bad list of breakpoints"<<endl;
+        return 1;
+    }
+    if(symmetry && !program.Symmetric())
+        cerr<<"Program has no replicated functions, symmetry reduction does nothing"<<endl;
+    StateMaker state_maker(program, filename, count_flag, count_full, dump_filename, delta, sync, lts_filename, lts_format, order, capacity,
+                           max_load / 100.0, projection, threads, por, symmetry, liveness, blocks, bitmap_budget << 20, bitstate_size, fingerprint_bits);
+    if(check)
+        return state_maker.CheckStates(invariant, violations) > 0 ? 1 : 0;
+    else if(!state_maker.PrintStates())
+        return 1;
 }
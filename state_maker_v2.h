@@ -11,124 +11,67 @@
 #include <fstream>
 #include <iostream>
 #include <utility>
-#include <set>
+#include <string>
+#include <mutex>
+#include <stdint.h>
+#include "concurrent_store.h"
+#include "frontier.h"
+#include "invariant_checker.h"
+#include "lts_writer.h"
+#include "output_writer.h"
+#include "parallel_explorer.h"
+#include "program.h"
+#include "state_codec.h"
+#include "state_dump.h"
+#include "state_set.h"
+#include "successors.h"
+#include "visited_store.h"
 /**
- * @brief structure to store vars of functions
+ * @brief item of exploration frontier
  */
-class IntVariable
+struct State
 {
-public:
 /**
- * @brief default constructor
+ * @brief state of whole program
  */
-    IntVariable():m_value(0),m_init_flag(false){}
+    PackedState packed;
 /**
- * @brief Assigment operator <IntVar> = <IntVar>
- * @param right right part of assigment operator
- * @return self object
+ * @brief id of previous state, given by set of generated states
  */
-    IntVariable& operator=(const IntVariable & right)
-    {
-        this->m_value = right.m_value;
-        this->m_init_flag = right.m_init_flag;
-        return *this;
-    }
-
+    size_t from;
 /**
- * @brief Assigment operator <IntVar> = <Int>
- * @param right right part of assigment operator
- * @return self object
+ * @brief name of thread, which did step from previous state
  */
-    IntVariable& operator=(int right)
-    {
-        this->m_value = right;
-        this->m_init_flag = true;
-        return *this;
-    }
-
+    const char* thread;
 /**
- * @brief overloaded output operator for IntVariable
- * @param stream output stream
- * @param right object to printing
- * @return Reference to stream
+ * @brief label of transition from previous state
  */
-    friend std::ostream& operator<<(std::ostream& stream, const IntVariable& right);
-
+    const char* label;
 /**
- * @brief operator less
- * @param right - right part of operator
+ * @brief color of transition from previous state
  */
-    const bool operator<(const IntVariable& right) const
-    {
-        if(m_init_flag == right.m_init_flag)
-            return m_value < right.m_value;
-        return false;
-    }
-/**
- * @brief stored value
- */
-    int m_value;
-
-/**
- * @brief indicates initialization of variable
- */
-    bool m_init_flag;
-};
-struct FuncVars
-{
-    IntVariable a;
-    IntVariable b;
-    IntVariable x;
-    IntVariable y;
-    unsigned int counter;
+    const char* color;
 };
 
 /**
- * @brief class to differ states in set
- */
-class StateDiff
-{
-public:
-/**
- * @brief class constructor
- * @param fCounter - counter of f
- * @param gCounter - counter of g
- * @param h - value of global variable
- */
-    StateDiff(unsigned int fCounter, unsigned int gCounter, IntVariable h):m_fCounter(fCounter),m_gCounter(gCounter),m_h(h){}
-
-/**
- * @brief operator less
- * @param right - right part of operator
- * @return true if left < right, false otherwise
+ * @brief lts output of state, generated by thread, waiting for printing
  */
-const bool operator< (const StateDiff& right) const
+struct LtsRecord
 {
-    if (m_fCounter < right.m_fCounter) return true;
-    if (m_fCounter > right.m_fCounter) return false;
-    
-    if (m_gCounter < right.m_gCounter) return true;
-    if (m_gCounter > right.m_gCounter) return false;
-
-    return m_h < right.m_h;
-}
-
-private:
 /**
- * @brief counter of function f
+ * @brief generated state with transition to it
  */
-    unsigned int m_fCounter;
-
+    State state;
 /**
- * @brief counter of function g
+ * @brief id of state
  */
-    unsigned int m_gCounter;
-
+    size_t id;
 /**
- * @brief global variable
+ * @brief flag, indicates if state wasn't generated before
  */
-    IntVariable m_h;
+    bool is_new;
 };
+
 /**
  * @brief class for getting all states of C program.
  */
@@ -137,23 +80,55 @@ class StateMaker
 public:
 /**
  * @brief class constructor
+ * @param program - program of threads, which is explored
  * @param filename - name of output file
  * @param count flag - flag, indicates if need print states number
+ * @param dump_filename - name of binary file for states instead of text, NULL
+ * to print text
+ * @param delta - flag, indicates if records of binary file are compressed
+ * @param sync - flag, indicates if every printed line is flushed at once
  * @param lts_filename - name of lts file
+ * @param lts_format - format of lts file
+ * @param order - order of states exploration
+ * @param capacity - number of states, allocated before exploration
+ * @param max_load - maximal load factor of table with generated states
+ * @param projection - comma separated names of variables, which differ states,
+ * NULL to differ states by all variables
+ * @param threads - number of exploring threads
+ * @param por - flag, indicates if partial-order reduction is used
+ * @param symmetry - flag, indicates if states, which differ by permutation of
+ * replicas of function, are merged
+ * @param liveness - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if local steps are fused with previous
+ * step of thread
+ * @param bitmap_budget - maximal size of bitmap of generated states in bytes
+ * @param bitstate_size - size of bit array for bitstate search in bytes, 0 to
+ * store states exactly
+ * @param fingerprint_bits - 32 or 64 to store only fingerprints of states, 0 to
+ * store states exactly
  */
-    StateMaker(char* filename, bool count_flag, char* lts_filename);
+    StateMaker(const Program& program, char* filename, bool count_flag, bool count_full, const char* dump_filename, bool delta, bool sync, char* lts_filename,
+               LtsFormat lts_format, SearchOrder order, size_t capacity, double max_load, const char* projection, size_t threads, bool por,
+               bool symmetry, bool liveness, bool blocks, size_t bitmap_budget, size_t bitstate_size, unsigned int fingerprint_bits);
 /**
  * @brief class destructor
  */
     ~StateMaker();
 /**
  * @brief generate and print states in console or file
- * @param f_a initial value of f::a
- * @param f_b initial value of f::b
- * @param g_a initial value of g::a
- * @param g_b initial value of g::b
+ * @return false if table of states, shared by threads, is full, so some
+ * states are lost
  */
-    void PrintStates(int f_a, int f_b, int g_a, int g_b);
+    bool PrintStates();
+
+/**
+ * @brief generates states until invariant is violated, prints traces from
+ * initial state to violating states instead of states
+ * @param invariant - property of all states
+ * @param limit - number of violations, after which exploration is stopped
+ * @return number of found violations
+ */
+    size_t CheckStates(const Invariant& invariant, size_t limit);
 private:
 /**
  * @brief number of generated states
@@ -163,14 +138,43 @@ private:
  * @brief flag, indicates if need print states number
  */
   unsigned int m_count_flag;
+/**
+ * @brief flag, indicates if states without reductions are counted by
+ * additional exploration
+ */
+  bool m_count_full;
 /**
  * @brief stream for output file
  */
     std::ofstream m_file;
+/**
+ * @brief buffered writer of printed states
+ */
+    OutputWriter* m_writer;
+/**
+ * @brief flag, indicates if states are written to binary file
+ */
+    bool m_dump;
+/**
+ * @brief stream for binary file of states
+ */
+    std::ofstream m_dump_file;
+/**
+ * @brief program of threads, which is explored
+ */
+    const Program& m_program;
+/**
+ * @brief placement of variables in packed state
+ */
+    StateLayout m_layout;
+/**
+ * @brief mask of fields, which differ states in set
+ */
+    PackedState m_key_mask;
 /** 
  * @brief stores pairs of counters, already generated by program
  */
-    std::set<StateDiff> m_old;
+    StateSet* m_old;
 /**
  * @brief flag, indicates if lts file choosen"
  */
@@ -179,30 +183,153 @@ private:
  * @brief stream to lts file
  */
     std::ofstream m_lts_file;
+/**
+ * @brief writer of lts file
+ */
+    LtsWriter* m_lts_writer;
+/**
+ * @brief states, waiting for exploration
+ */
+    Frontier<State> m_frontier;
+/**
+ * @brief number of exploring threads
+ */
+    size_t m_threads;
+/**
+ * @brief stores states, generated by several threads
+ */
+    ConcurrentStore m_shared_old;
+/**
+ * @brief output of threads, waiting for printing
+ */
+    std::vector<std::string> m_buffers;
+/**
+ * @brief encoders of binary records, one for every thread
+ */
+    std::vector<DumpEncoder> m_encoders;
+/**
+ * @brief lts output of threads, waiting for printing
+ */
+    std::vector<std::vector<LtsRecord> > m_lts_buffers;
+/**
+ * @brief guard of output streams
+ */
+    std::mutex m_output_mutex;
+/**
+ * @brief flag, indicates if partial-order reduction is used
+ */
+    bool m_por;
+/**
+ * @brief flag, indicates if states are canonicalized by symmetry of replicas
+ */
+    bool m_symmetry;
+/**
+ * @brief flag, indicates if dead local variables are reset after steps
+ */
+    bool m_liveness;
+/**
+ * @brief flag, indicates if local steps are done with previous step of thread
+ */
+    bool m_blocks;
+/**
+ * @brief mask of fields, which aren't reset even if dead
+ */
+    PackedState m_kept;
+/**
+ * @brief number of states, where only one thread made step
+ */
+    size_t m_reduced_states;
 /** 
- * @brief generates and prints all states after state, described by f, g and h
- * @param f - state of function f
- * @param g - state of function g
- * @param h - value of global variable
+ * @brief generates and prints all states after specified state
+ * @param initial - packed state of program
+ */
+    void GenerateStates(const PackedState& initial);
+
+/** 
+ * @brief generates and prints all states after specified state by several threads
+ * @param initial - packed state of program
+ */
+    void GenerateStatesParallel(const PackedState& initial);
+
+/**
+ * @brief stores and prints state, generated by thread, and makes its successors
+ * @param worker - number of thread
+ * @param state - generated state
+ * @param next - place for successors
  */
-    void GenerateStates(FuncVars f, FuncVars g, IntVariable h);
+    void Expand(size_t worker, const State& state, std::vector<State>& next);
 
 /**
- * @brief do step by f code
- * @param f - state of function f
- * @param g - state of function g
- * @param h - state of global variable
+ * @brief prints generated state by single thread
+ * @param state - state of program
  */
-    void StepInF(FuncVars f, FuncVars g, IntVariable h);
+    void PrintState(const PackedState& state);
+
+/**
+ * @brief adds generated state to output of thread
+ * @param worker - number of thread
+ * @param state - state of program
+ */
+    void AppendState(size_t worker, const PackedState& state);
+
+/**
+ * @brief writes all printed states, binary file gets number of records
+ * @param records - number of printed states
+ */
+    void FinishOutput(uint64_t records);
+
+/**
+ * @brief prints output of thread
+ * @param worker - number of thread
+ */
+    void Flush(size_t worker);
+
+/**
+ * @brief prints transition to state and state itself in lts format
+ * @param state - generated state
+ * @param id - id of state
+ * @param is_new - flag, indicates if state wasn't generated before
+ */
+    void PrintLts(const State& state, size_t id, bool is_new);
+
+/**
+ * @brief counts states, generated without partial-order reduction
+ * @param initial - packed state of program
+ * @param live - flag, indicates if dead local variables are reset
+ */
+    size_t CountFullStates(const PackedState& initial, bool live);
+
+/**
+ * @brief prints numbers of states, which are merged by reset of every dead
+ * variable
+ * @param initial - packed state of program
+ */
+    void PrintSavedStates(const PackedState& initial);
+
+/**
+ * @brief makes successors of state in order of threads
+ * @param state - state of program
+ * @param next - place for MaxThreads successors
+ * @param reduce - flag, indicates if only ample set of steps is taken
+ * @param symmetric - flag, indicates if successors are canonicalized
+ * @param live - flag, indicates if dead local variables are reset
+ * @param blocks - flag, indicates if fused local steps are done at once
+ * @return number of successors
+ */
+    size_t Successors(const State& state, State* next, bool reduce, bool symmetric, bool live, bool blocks);
+
+
+
+
 
 /**
- * @brief do step by g code
- * @param f - state of function f
- * @param g - state of function g
- * @param h - state of global variable
+ * @brief gives state label of step, which made it
+ * @param state - successor of step
+ * @param thread - number of thread
+ * @param transition - first done transition of step
  */
-    void StepInG(FuncVars f, FuncVars g, IntVariable h);
-    int CalcHash(unsigned int fcounter, unsigned int gcounter, IntVariable h);
+    void Label(State& state, size_t thread, const Transition& transition) const;
+    friend class ParallelExplorer<State, StateMaker>;
 // Copy isn't allowed
     StateMaker(StateMaker&);
     StateMaker& operator=(StateMaker&);
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * File: state_query.cpp
+ * Description: filtering and printing of binary file of generated states.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "output_writer.h"
+#include "state_dump.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+using namespace std;
+
+const char* Info = "Usage: <binary name> <binary file of states>\n"
+                   "Allowed flags:\n"
+                   "-where <conditions>: print only states with listed values, for example\n"
+                   "    h=6,g.y=# (# is uninitialized value)\n"
+                   "-project <vars>: print only listed variables, for example\n"
+                   "    f.counter,g.counter,h (all variables by default)\n"
+                   "-file <out file>: redirect output to specified file\n"
+                   "-count: prints number of states in console instead of states\n"
+                   "-sync: flush every printed state at once\n\n"
+                   "Author: Valery Bitsoev. March 2013\n";
+
+/**
+ * @brief condition on value of field
+ */
+struct Condition
+{
+    size_t field;
+    bool init;
+    int value;
+};
+
+/**
+ * @brief parses comma separated conditions like h=6,g.y=#
+ * @param layout - placement of variables in packed state
+ * @param list - list of conditions
+ * @param conditions - place for conditions
+ * @return false if variable is unknown or value isn't number
+ */
+bool ParseConditions(const StateLayout& layout, const char* list, vector<Condition>& conditions)
+{
+    string text(list);
+    size_t begin = 0;
+    while(begin <= text.size())
+    {
+        size_t end = text.find(',', begin);
+        if(end == string::npos)
+            end = text.size();
+        string item = text.substr(begin, end - begin);
+        size_t equal = item.find('=');
+        if(equal == string::npos)
+            return false;
+        Condition condition;
+        if(!layout.Find(item.substr(0, equal).c_str(), condition.field))
+            return false;
+        string value = item.substr(equal + 1);
+        char* value_end = NULL;
+        condition.init = value != "#";
+        condition.value = condition.init ? int(strtol(value.c_str(), &value_end, 10)) : 0;
+        if(condition.init && (value.empty() || *value_end != '\0'))
+            return false;
+        conditions.push_back(condition);
+        begin = end + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief checks if state satisfies all conditions
+ * @param layout - placement of variables in packed state
+ * @param state - packed state
+ * @param conditions - conditions on fields
+ */
+bool Satisfies(const StateLayout& layout, const PackedState& state, const vector<Condition>& conditions)
+{
+    for(size_t i = 0; i < conditions.size(); ++i)
+    {
+        const Condition& condition = conditions[i];
+        if(layout.IsInit(state, condition.field) != condition.init)
+            return false;
+        if(condition.init && layout.Value(state, condition.field) != condition.value)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int i = 2;
+    bool bad_args = argc < 2;
+    char* filename = NULL;
+    char* where = NULL;
+    char* projection = NULL;
+    bool count_flag = false;
+    bool sync = false;
+    //parse argv
+    while(!bad_args && i < argc)
+    {
+        if(strcmp(argv[i], "-count") == 0)
+        {
+            count_flag = true;
+            ++i;
+        }
+        else if(strcmp(argv[i], "-sync") == 0)
+        {
+            sync = true;
+            ++i;
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-file") == 0)
+        {
+            filename = argv[i+1];
+            i+=2;
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-where") == 0)
+        {
+            where = argv[i+1];
+            i+=2;
+        }
+        else if(i + 1 < argc && strcmp(argv[i], "-project") == 0)
+        {
+            projection = argv[i+1];
+            i+=2;
+        }
+        else
+        {
+            bad_args = true;
+        }
+    }
+    if(bad_args)
+    {
+        // print info about program
+        cout<<Info<<endl;
+        return 1;
+    }
+
+    DumpReader reader;
+    if(!reader.Open(argv[1]))
+    {
+        cerr<<"Can't read binary file of states"<<endl;
+        return 1;
+    }
+    const StateLayout& layout = reader.Layout();
+    vector<Condition> conditions;
+    if(where && !ParseConditions(layout, where, conditions))
+    {
+        cerr<<"Bad condition in -where"<<endl;
+        return 1;
+    }
+    vector<size_t> fields;
+    if(projection && !layout.Find(projection, fields))
+    {
+        cerr<<"Unknown variable in projection"<<endl;
+        return 1;
+    }
+
+    ofstream file;
+    if(filename)
+    {
+        file.open(filename);
+        if(!file)
+        {
+            cerr<<"Can't open file, redirecting output to console"<<endl;
+            filename = NULL;
+        }
+    }
+    OutputWriter writer(filename ? static_cast<ostream&>(file) : cout, sync);
+    uint64_t selected = 0;
+    PackedState state;
+    while(reader.Next(state))
+    {
+        if(!Satisfies(layout, state, conditions))
+            continue;
+        ++selected;
+        if(count_flag)
+            continue;
+        if(!projection)
+        {
+            // same text as -file output of state_maker
+            layout.Print(writer.Buffer(), state, ", ");
+            writer.EndLine();
+            continue;
+        }
+        string& text = writer.Buffer();
+        for(size_t j = 0; j < fields.size(); ++j)
+        {
+            if(j != 0)
+                text += ", ";
+            if(layout.IsInit(state, fields[j]))
+                AppendNumber(text, layout.Value(state, fields[j]));
+            else
+                text += '#';
+        }
+        writer.EndLine();
+    }
+    writer.Finish();
+    if(count_flag)
+        cout<<"Result states number: "<<selected<<endl;
+    if(!reader.Finished())
+    {
+        cerr<<"Binary file is broken"<<endl;
+        return 1;
+    }
+}
@@ -0,0 +1,407 @@
+/******************************************************************************
+ * File: state_set.cpp
+ * Description: sets of already generated states, chosen by size of state space.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "state_set.h"
+#include <sys/mman.h>
+#include <assert.h>
+#include <iostream>
+using namespace std;
+
+/**
+ * @brief size of bitmap, from which huge pages are asked
+ */
+const size_t HugePageSize = 2 << 20;
+
+/**
+ * @brief number of hash functions of bitstate set
+ */
+const unsigned int BitstateHashes = 3;
+
+/**
+ * @brief seed of second hash function of bitstate set
+ */
+const uint64_t SecondHashSeed = 0x5BD1E9955BD1E995ULL;
+
+/**
+ * @brief maps zero filled memory, huge pages are asked for big size
+ * @param bytes - size of memory
+ * @return memory or NULL, if it can't be mapped
+ */
+static uint64_t* MapBits(size_t bytes)
+{
+    // anonymous mapping is zero filled and takes memory only for touched pages
+    void* memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED)
+        return NULL;
+#ifdef MADV_HUGEPAGE
+    if(bytes >= HugePageSize)
+        madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+    return static_cast<uint64_t*>(memory);
+}
+
+/**
+ * @brief class destructor
+ */
+StateSet::~StateSet()
+{
+}
+
+/**
+ * @brief calculates hash of masked state
+ * @param state - packed state
+ * @param mask - mask of fields, which differ states
+ * @param seed - seed of hash function, different seeds give independent hashes
+ */
+uint64_t StateHash(const PackedState& state, const PackedState& mask, uint64_t seed)
+{
+    // finalizer of MurmurHash3 mixes every bit of word into all bits of hash
+    uint64_t hash = seed;
+    for(size_t i = 0; i < MaxStateWords; ++i)
+    {
+        hash ^= state.words[i] & mask.words[i];
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33;
+    }
+    return hash;
+}
+
+/**
+ * @brief class constructor
+ * @param layout - placement of variables in packed state
+ * @param mask - mask of fields, which differ states
+ * @param capacity - number of states, which can be stored without growing
+ * @param max_load - maximal part of occupied slots, from 0.1 to 0.95
+ */
+HashStateSet::HashStateSet(const StateLayout& layout, const PackedState& mask, size_t capacity, double max_load)
+                          : m_mask(mask)
+                          , m_store(layout.Words(), capacity, max_load)
+{
+}
+
+/**
+ * @brief adds state to set, if it isn't stored yet
+ * @param state - packed state
+ * @return true if state was added, false if it was already stored
+ */
+bool HashStateSet::FindOrInsert(const PackedState& state)
+{
+    PackedState key;
+    MaskState(state, m_mask, key);
+    return m_store.FindOrInsert(key.words);
+}
+
+/**
+ * @brief adds state to set, if it isn't stored yet, and gives its id.
+ * States are numbered from zero in order of insertion.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it was already stored
+ */
+bool HashStateSet::FindOrInsert(const PackedState& state, size_t& id)
+{
+    PackedState key;
+    MaskState(state, m_mask, key);
+    return m_store.FindOrInsert(key.words, id);
+}
+
+/**
+ * @brief checks if state is stored
+ * @param state - packed state
+ */
+bool HashStateSet::Contains(const PackedState& state) const
+{
+    PackedState key;
+    MaskState(state, m_mask, key);
+    return m_store.Contains(key.words);
+}
+
+/**
+ * @brief number of stored states
+ */
+size_t HashStateSet::Size() const
+{
+    return m_store.Size();
+}
+
+/**
+ * @brief class constructor
+ * @param layout - placement of variables in packed state
+ * @param fields - indexes of fields, which differ states
+ * @param states - number of points in product of field domains
+ * @param numbered - flag, indicates if ids of states are stored
+ */
+BitmapStateSet::BitmapStateSet(const StateLayout& layout, const vector<size_t>& fields, uint64_t states, bool numbered)
+                              : m_layout(layout)
+                              , m_fields(fields)
+                              , m_size(0)
+                              , m_bytes((states + 63) / 64 * sizeof(uint64_t))
+                              , m_bits(MapBits(m_bytes))
+                              , m_id_bytes(numbered ? states * sizeof(uint32_t) : 0)
+                              , m_ids(numbered ? reinterpret_cast<uint32_t*>(MapBits(m_id_bytes)) : NULL)
+{
+}
+
+/**
+ * @brief class destructor
+ */
+BitmapStateSet::~BitmapStateSet()
+{
+    if(m_bits)
+        munmap(m_bits, m_bytes);
+    if(m_ids)
+        munmap(m_ids, m_id_bytes);
+}
+
+/**
+ * @brief adds state to set, if it isn't stored yet
+ * @param state - packed state
+ * @return true if state was added, false if it was already stored
+ */
+bool BitmapStateSet::FindOrInsert(const PackedState& state)
+{
+    uint64_t index = Index(state);
+    uint64_t& word = m_bits[index >> 6];
+    uint64_t bit = uint64_t(1) << (index & 63);
+    if(word & bit)
+        return false;
+    word |= bit;
+    ++m_size;
+    return true;
+}
+
+/**
+ * @brief adds state to set, if it isn't stored yet, and gives its id.
+ * States are numbered from zero in order of insertion, set should be
+ * made with ids.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it was already stored
+ */
+bool BitmapStateSet::FindOrInsert(const PackedState& state, size_t& id)
+{
+    uint64_t index = Index(state);
+    uint64_t& word = m_bits[index >> 6];
+    uint64_t bit = uint64_t(1) << (index & 63);
+    if(word & bit)
+    {
+        id = m_ids[index];
+        return false;
+    }
+    word |= bit;
+    id = m_size++;
+    m_ids[index] = uint32_t(id);
+    return true;
+}
+
+/**
+ * @brief checks if state is stored
+ * @param state - packed state
+ */
+bool BitmapStateSet::Contains(const PackedState& state) const
+{
+    uint64_t index = Index(state);
+    return (m_bits[index >> 6] >> (index & 63)) & 1;
+}
+
+/**
+ * @brief number of stored states
+ */
+size_t BitmapStateSet::Size() const
+{
+    return m_size;
+}
+
+/**
+ * @brief class constructor
+ * @param mask - mask of fields, which differ states
+ * @param bytes - size of bit array
+ * @param hashes - number of hash functions, from 1 to MaxBitstateHashes
+ */
+BitstateSet::BitstateSet(const PackedState& mask, size_t bytes, unsigned int hashes)
+                        : m_mask(mask)
+                        , m_bytes((bytes + 7) / 8 * 8)
+                        , m_bit_number(uint64_t(m_bytes) * 8)
+                        , m_hashes(hashes)
+                        , m_size(0)
+                        , m_filled(0)
+                        , m_omissions(0)
+                        , m_bits(MapBits(m_bytes))
+{
+    assert(hashes >= 1 && hashes <= MaxBitstateHashes);
+}
+
+/**
+ * @brief class destructor
+ */
+BitstateSet::~BitstateSet()
+{
+    if(m_bits)
+        munmap(m_bits, m_bytes);
+}
+
+/**
+ * @brief calculates bits of state by double hashing
+ * @param state - packed state
+ * @param bits - place for m_hashes numbers of bits
+ */
+void BitstateSet::Bits(const PackedState& state, uint64_t* bits) const
+{
+    // i-th function is first hash plus i multiples of second one, which
+    // behaves as independent functions for bit selection
+    uint64_t first = StateHash(state, m_mask, 0);
+    uint64_t second = StateHash(state, m_mask, SecondHashSeed) | 1;
+    for(unsigned int i = 0; i < m_hashes; ++i)
+        bits[i] = (first + i * second) % m_bit_number;
+}
+
+/**
+ * @brief adds state to set, if some of its bits aren't set
+ * @param state - packed state
+ * @return true if state was added, false if it is taken for stored
+ */
+bool BitstateSet::FindOrInsert(const PackedState& state)
+{
+    uint64_t bits[MaxBitstateHashes];
+    Bits(state, bits);
+    // new state is taken for stored, if all its bits are already set,
+    // what happens with probability of fill ratio in power of hashes
+    double fill = double(m_filled) / m_bit_number;
+    double collision = 1;
+    for(unsigned int i = 0; i < m_hashes; ++i)
+        collision *= fill;
+    bool is_new = false;
+    for(unsigned int i = 0; i < m_hashes; ++i)
+    {
+        uint64_t& word = m_bits[bits[i] >> 6];
+        uint64_t bit = uint64_t(1) << (bits[i] & 63);
+        if(word & bit)
+            continue;
+        word |= bit;
+        ++m_filled;
+        is_new = true;
+    }
+    if(!is_new)
+        return false;
+    m_omissions += collision;
+    ++m_size;
+    return true;
+}
+
+/**
+ * @brief adds state to set, if some of its bits aren't set. States aren't
+ * stored, so id of state, which is taken for stored, isn't known and
+ * number of stored states is given instead.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it is taken for stored
+ */
+bool BitstateSet::FindOrInsert(const PackedState& state, size_t& id)
+{
+    bool is_new = FindOrInsert(state);
+    id = is_new ? m_size - 1 : m_size;
+    return is_new;
+}
+
+/**
+ * @brief checks if all bits of state are set
+ * @param state - packed state
+ */
+bool BitstateSet::Contains(const PackedState& state) const
+{
+    uint64_t bits[MaxBitstateHashes];
+    Bits(state, bits);
+    for(unsigned int i = 0; i < m_hashes; ++i)
+        if(!((m_bits[bits[i] >> 6] >> (bits[i] & 63)) & 1))
+            return false;
+    return true;
+}
+
+/**
+ * @brief number of stored states
+ */
+size_t BitstateSet::Size() const
+{
+    return m_size;
+}
+
+/**
+ * @brief checks if different states are never taken for one state
+ */
+bool BitstateSet::Exact() const
+{
+    return false;
+}
+
+/**
+ * @brief expected number of new states, which were taken for stored ones
+ */
+double BitstateSet::Omissions() const
+{
+    return m_omissions;
+}
+
+/**
+ * @brief makes bitstate or compact set, if it is asked, otherwise bitmap
+ * set, if product of field domains fits in memory budget, and hash set
+ * @param layout - placement of variables in packed state
+ * @param fields - indexes of fields, which differ states
+ * @param capacity - number of states, allocated in hash set before exploration
+ * @param max_load - maximal load factor of hash set
+ * @param bitmap_budget - maximal size of bitmap in bytes, 0 to use hash set
+ * @param bitstate_size - size of bit array of bitstate set in bytes,
+ * 0 to store states exactly
+ * @param fingerprint_bits - 32 or 64 to store only fingerprints of states,
+ * 0 to store states exactly
+ * @param numbered - flag, indicates if ids of states are needed, bitstate
+ * set isn't made then
+ * @return set, which should be deleted by caller
+ */
+StateSet* MakeStateSet(const StateLayout& layout, const vector<size_t>& fields, size_t capacity, double max_load,
+                       size_t bitmap_budget, size_t bitstate_size, unsigned int fingerprint_bits, bool numbered)
+{
+    PackedState mask;
+    layout.Mask(fields, mask);
+    if(bitstate_size > 0 && numbered)
+        cerr<<"Bit array can't number states, states are stored exactly"<<endl;
+    else if(bitstate_size > 0)
+    {
+        BitstateSet* bitstate = new BitstateSet(mask, bitstate_size, BitstateHashes);
+        if(bitstate->Allocated())
+            return bitstate;
+        delete bitstate;
+        cerr<<"Can't allocate bit array, states are stored exactly"<<endl;
+    }
+    if(fingerprint_bits == 32)
+        return new CompactStateSet<uint32_t>(mask, capacity, max_load, numbered);
+    if(fingerprint_bits == 64)
+        return new CompactStateSet<uint64_t>(mask, capacity, max_load, numbered);
+
+    // product of domains is compared with budget before every
+    // multiplication, so it can't overflow; numbered point takes bit and id
+    uint64_t max_states = uint64_t(bitmap_budget) * 8 / (numbered ? 8 * sizeof(uint32_t) + 1 : 1);
+    uint64_t states = 1;
+    bool fits = true;
+    for(size_t i = 0; i < fields.size() && fits; ++i)
+    {
+        uint64_t values = layout.Values(fields[i]);
+        fits = values <= max_states / states;
+        states *= fits ? values : 1;
+    }
+    if(fits)
+    {
+        BitmapStateSet* bitmap = new BitmapStateSet(layout, fields, states, numbered);
+        if(bitmap->Allocated())
+            return bitmap;
+        delete bitmap;
+    }
+    return new HashStateSet(layout, mask, capacity, max_load);
+}
@@ -0,0 +1,577 @@
+/******************************************************************************
+ * File: state_set.h
+ * Description: sets of already generated states, chosen by size of state space.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef STATE_SET_H
+#define STATE_SET_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "state_codec.h"
+#include "visited_store.h"
+
+/**
+ * @brief set of generated states, used by single exploring thread
+ */
+class StateSet
+{
+public:
+/**
+ * @brief class destructor
+ */
+    virtual ~StateSet();
+
+/**
+ * @brief adds state to set, if it isn't stored yet
+ * @param state - packed state
+ * @return true if state was added, false if it was already stored
+ */
+    virtual bool FindOrInsert(const PackedState& state) = 0;
+
+/**
+ * @brief adds state to set, if it isn't stored yet, and gives its id.
+ * States are numbered from zero in order of insertion.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it was already stored
+ */
+    virtual bool FindOrInsert(const PackedState& state, size_t& id) = 0;
+
+/**
+ * @brief checks if state is stored
+ * @param state - packed state
+ */
+    virtual bool Contains(const PackedState& state) const = 0;
+
+/**
+ * @brief number of stored states
+ */
+    virtual size_t Size() const = 0;
+
+/**
+ * @brief checks if different states are never taken for one state
+ */
+    virtual bool Exact() const
+    {
+        return true;
+    }
+
+/**
+ * @brief expected number of new states, which were taken for stored ones
+ */
+    virtual double Omissions() const
+    {
+        return 0;
+    }
+};
+
+/**
+ * @brief calculates hash of masked state
+ * @param state - packed state
+ * @param mask - mask of fields, which differ states
+ * @param seed - seed of hash function, different seeds give independent hashes
+ */
+uint64_t StateHash(const PackedState& state, const PackedState& mask, uint64_t seed);
+
+/**
+ * @brief set of states in hash table, states are differed by masked fields
+ */
+class HashStateSet: public StateSet
+{
+public:
+/**
+ * @brief class constructor
+ * @param layout - placement of variables in packed state
+ * @param mask - mask of fields, which differ states
+ * @param capacity - number of states, which can be stored without growing
+ * @param max_load - maximal part of occupied slots, from 0.1 to 0.95
+ */
+    HashStateSet(const StateLayout& layout, const PackedState& mask, size_t capacity, double max_load);
+
+/**
+ * @brief adds state to set, if it isn't stored yet
+ * @param state - packed state
+ * @return true if state was added, false if it was already stored
+ */
+    virtual bool FindOrInsert(const PackedState& state);
+
+/**
+ * @brief adds state to set, if it isn't stored yet, and gives its id.
+ * States are numbered from zero in order of insertion.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it was already stored
+ */
+    virtual bool FindOrInsert(const PackedState& state, size_t& id);
+
+/**
+ * @brief checks if state is stored
+ * @param state - packed state
+ */
+    virtual bool Contains(const PackedState& state) const;
+
+/**
+ * @brief number of stored states
+ */
+    virtual size_t Size() const;
+private:
+/**
+ * @brief mask of fields, which differ states
+ */
+    PackedState m_mask;
+
+/**
+ * @brief table of masked states
+ */
+    VisitedStore m_store;
+};
+
+/**
+ * @brief set of states as bitmap with one bit per point of product of field
+ * domains. State is mapped to mixed-radix number of its field values, so
+ * lookup is one bit test without hashing and probing. Bitmap is mapped
+ * by mmap, pages are given by system at first touch, big bitmap uses
+ * huge pages where system supports them.
+ */
+class BitmapStateSet: public StateSet
+{
+public:
+/**
+ * @brief class constructor
+ * @param layout - placement of variables in packed state
+ * @param fields - indexes of fields, which differ states
+ * @param states - number of points in product of field domains
+ * @param numbered - flag, indicates if ids of states are stored
+ */
+    BitmapStateSet(const StateLayout& layout, const std::vector<size_t>& fields, uint64_t states, bool numbered);
+
+/**
+ * @brief class destructor
+ */
+    virtual ~BitmapStateSet();
+
+/**
+ * @brief checks if bitmap is allocated
+ */
+    bool Allocated() const
+    {
+        return m_bits != NULL && (m_id_bytes == 0 || m_ids != NULL);
+    }
+
+/**
+ * @brief adds state to set, if it isn't stored yet
+ * @param state - packed state
+ * @return true if state was added, false if it was already stored
+ */
+    virtual bool FindOrInsert(const PackedState& state);
+
+/**
+ * @brief adds state to set, if it isn't stored yet, and gives its id.
+ * States are numbered from zero in order of insertion.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it was already stored
+ */
+    virtual bool FindOrInsert(const PackedState& state, size_t& id);
+
+/**
+ * @brief checks if state is stored
+ * @param state - packed state
+ */
+    virtual bool Contains(const PackedState& state) const;
+
+/**
+ * @brief number of stored states
+ */
+    virtual size_t Size() const;
+private:
+/**
+ * @brief mixed-radix number of state
+ * @param state - packed state
+ */
+    uint64_t Index(const PackedState& state) const
+    {
+        uint64_t index = 0;
+        for(size_t i = 0; i < m_fields.size(); ++i)
+            index = index * m_layout.Values(m_fields[i]) + m_layout.Digit(state, m_fields[i]);
+        return index;
+    }
+
+/**
+ * @brief placement of variables in packed state
+ */
+    StateLayout m_layout;
+
+/**
+ * @brief indexes of fields, which differ states
+ */
+    std::vector<size_t> m_fields;
+
+/**
+ * @brief number of stored states
+ */
+    size_t m_size;
+
+/**
+ * @brief size of mapped bitmap in bytes
+ */
+    size_t m_bytes;
+
+/**
+ * @brief bitmap, NULL if it can't be mapped
+ */
+    uint64_t* m_bits;
+
+/**
+ * @brief size of mapped array of ids in bytes, 0 if ids aren't stored
+ */
+    size_t m_id_bytes;
+
+/**
+ * @brief ids of states by their numbers, NULL if ids aren't stored
+ */
+    uint32_t* m_ids;
+
+// Copy isn't allowed
+    BitmapStateSet(BitmapStateSet&);
+    BitmapStateSet& operator=(BitmapStateSet&);
+};
+
+/**
+ * @brief maximal number of hash functions of bitstate set
+ */
+const unsigned int MaxBitstateHashes = 8;
+
+/**
+ * @brief bitstate set (supertrace): state sets several bits of big bit
+ * array, selected by independent hash functions, and is taken for stored,
+ * if all its bits are set. Memory is fixed, but some new states can be
+ * taken for stored ones and aren't explored.
+ */
+class BitstateSet: public StateSet
+{
+public:
+/**
+ * @brief class constructor
+ * @param mask - mask of fields, which differ states
+ * @param bytes - size of bit array
+ * @param hashes - number of hash functions, from 1 to MaxBitstateHashes
+ */
+    BitstateSet(const PackedState& mask, size_t bytes, unsigned int hashes);
+
+/**
+ * @brief class destructor
+ */
+    virtual ~BitstateSet();
+
+/**
+ * @brief checks if bit array is allocated
+ */
+    bool Allocated() const
+    {
+        return m_bits != NULL;
+    }
+
+/**
+ * @brief adds state to set, if some of its bits aren't set
+ * @param state - packed state
+ * @return true if state was added, false if it is taken for stored
+ */
+    virtual bool FindOrInsert(const PackedState& state);
+
+/**
+ * @brief adds state to set, if some of its bits aren't set. States aren't
+ * stored, so id of state, which is taken for stored, isn't known and
+ * number of stored states is given instead.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it is taken for stored
+ */
+    virtual bool FindOrInsert(const PackedState& state, size_t& id);
+
+/**
+ * @brief checks if all bits of state are set
+ * @param state - packed state
+ */
+    virtual bool Contains(const PackedState& state) const;
+
+/**
+ * @brief number of stored states
+ */
+    virtual size_t Size() const;
+
+/**
+ * @brief checks if different states are never taken for one state
+ */
+    virtual bool Exact() const;
+
+/**
+ * @brief expected number of new states, which were taken for stored ones
+ */
+    virtual double Omissions() const;
+private:
+/**
+ * @brief calculates bits of state by double hashing
+ * @param state - packed state
+ * @param bits - place for m_hashes numbers of bits
+ */
+    void Bits(const PackedState& state, uint64_t* bits) const;
+
+/**
+ * @brief mask of fields, which differ states
+ */
+    PackedState m_mask;
+
+/**
+ * @brief size of bit array in bytes
+ */
+    size_t m_bytes;
+
+/**
+ * @brief number of bits in array
+ */
+    uint64_t m_bit_number;
+
+/**
+ * @brief number of hash functions
+ */
+    unsigned int m_hashes;
+
+/**
+ * @brief number of stored states
+ */
+    size_t m_size;
+
+/**
+ * @brief number of set bits
+ */
+    uint64_t m_filled;
+
+/**
+ * @brief sum of probabilities, that new state was taken for stored one
+ */
+    double m_omissions;
+
+/**
+ * @brief bit array, NULL if it can't be mapped
+ */
+    uint64_t* m_bits;
+
+// Copy isn't allowed
+    BitstateSet(BitstateSet&);
+    BitstateSet& operator=(BitstateSet&);
+};
+
+/**
+ * @brief hash compaction: only fingerprint of state is stored in open
+ * addressing table, states with equal fingerprints are taken for one.
+ * Fingerprint is 32 or 64 bit unsigned integer, zero marks empty slot.
+ */
+template <class Fingerprint>
+class CompactStateSet: public StateSet
+{
+public:
+/**
+ * @brief class constructor
+ * @param mask - mask of fields, which differ states
+ * @param capacity - number of states, which can be stored without growing
+ * @param max_load - maximal part of occupied slots, from 0.1 to 0.95
+ * @param numbered - flag, indicates if ids of states are stored
+ */
+    CompactStateSet(const PackedState& mask, size_t capacity, double max_load, bool numbered): m_mask(mask)
+                                                                                             , m_max_load(max_load)
+                                                                                             , m_size(0)
+                                                                                             , m_numbered(numbered)
+                                                                                             , m_slots()
+                                                                                             , m_ids()
+    {
+        if(m_max_load < 0.1) m_max_load = 0.1;
+        if(m_max_load > 0.95) m_max_load = 0.95;
+        size_t slots = 64;
+        while(slots * m_max_load < capacity)
+            slots *= 2;
+        m_slots.assign(slots, 0);
+        if(m_numbered)
+            m_ids.assign(slots, 0);
+    }
+
+/**
+ * @brief adds fingerprint of state to set, if it isn't stored yet
+ * @param state - packed state
+ * @return true if state was added, false if it is taken for stored
+ */
+    virtual bool FindOrInsert(const PackedState& state)
+    {
+        if(m_size >= m_slots.size() * m_max_load)
+            Grow();
+        Fingerprint print = Print(state);
+        size_t slot = Probe(print);
+        if(m_slots[slot] == print)
+            return false;
+        m_slots[slot] = print;
+        ++m_size;
+        return true;
+    }
+
+/**
+ * @brief adds fingerprint of state to set, if it isn't stored yet, and
+ * gives its id. States are numbered from zero in order of insertion,
+ * set should be made with ids.
+ * @param state - packed state
+ * @param id - place for id of state
+ * @return true if state was added, false if it is taken for stored
+ */
+    virtual bool FindOrInsert(const PackedState& state, size_t& id)
+    {
+        if(m_size >= m_slots.size() * m_max_load)
+            Grow();
+        Fingerprint print = Print(state);
+        size_t slot = Probe(print);
+        if(m_slots[slot] == print)
+        {
+            id = m_ids[slot];
+            return false;
+        }
+        m_slots[slot] = print;
+        id = m_size++;
+        m_ids[slot] = uint32_t(id);
+        return true;
+    }
+
+/**
+ * @brief checks if fingerprint of state is stored
+ * @param state - packed state
+ */
+    virtual bool Contains(const PackedState& state) const
+    {
+        Fingerprint print = Print(state);
+        return m_slots[Probe(print)] == print;
+    }
+
+/**
+ * @brief number of stored states
+ */
+    virtual size_t Size() const
+    {
+        return m_size;
+    }
+
+/**
+ * @brief checks if different states are never taken for one state
+ */
+    virtual bool Exact() const
+    {
+        return false;
+    }
+
+/**
+ * @brief expected number of new states, which were taken for stored ones:
+ * i-th state meets equal fingerprint with probability i / 2^bits
+ */
+    virtual double Omissions() const
+    {
+        double prints = 1.0;
+        for(size_t i = 0; i < sizeof(Fingerprint); ++i)
+            prints *= 256.0;
+        return double(m_size) * (double(m_size) - 1) / 2 / prints;
+    }
+private:
+/**
+ * @brief fingerprint of state, never zero
+ * @param state - packed state
+ */
+    Fingerprint Print(const PackedState& state) const
+    {
+        Fingerprint print = Fingerprint(StateHash(state, m_mask, 0));
+        return print != 0 ? print : 1;
+    }
+
+/**
+ * @brief finds slot of fingerprint or empty slot, where it should be placed
+ * @param print - fingerprint
+ */
+    size_t Probe(Fingerprint print) const
+    {
+        size_t mask = m_slots.size() - 1;
+        uint64_t key = print;
+        size_t slot = size_t(HashWords(&key, 1) >> 32) & mask;
+        while(m_slots[slot] != 0 && m_slots[slot] != print)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+/**
+ * @brief doubles number of slots
+ */
+    void Grow()
+    {
+        std::vector<Fingerprint> old(m_slots.size() * 2, 0);
+        std::vector<uint32_t> old_ids(m_numbered ? old.size() : 0, 0);
+        old.swap(m_slots);
+        old_ids.swap(m_ids);
+        for(size_t i = 0; i < old.size(); ++i)
+        {
+            if(old[i] == 0)
+                continue;
+            size_t slot = Probe(old[i]);
+            m_slots[slot] = old[i];
+            if(m_numbered)
+                m_ids[slot] = old_ids[i];
+        }
+    }
+
+/**
+ * @brief mask of fields, which differ states
+ */
+    PackedState m_mask;
+
+/**
+ * @brief maximal part of occupied slots
+ */
+    double m_max_load;
+
+/**
+ * @brief number of stored fingerprints
+ */
+    size_t m_size;
+
+/**
+ * @brief flag, indicates if ids of states are stored
+ */
+    bool m_numbered;
+
+/**
+ * @brief fingerprints, zero for empty slot
+ */
+    std::vector<Fingerprint> m_slots;
+
+/**
+ * @brief ids of fingerprints of slots, empty if ids aren't stored
+ */
+    std::vector<uint32_t> m_ids;
+};
+
+/**
+ * @brief makes bitstate or compact set, if it is asked, otherwise bitmap
+ * set, if product of field domains fits in memory budget, and hash set
+ * @param layout - placement of variables in packed state
+ * @param fields - indexes of fields, which differ states
+ * @param capacity - number of states, allocated in hash set before exploration
+ * @param max_load - maximal load factor of hash set
+ * @param bitmap_budget - maximal size of bitmap in bytes, 0 to use hash set
+ * @param bitstate_size - size of bit array of bitstate set in bytes,
+ * 0 to store states exactly
+ * @param fingerprint_bits - 32 or 64 to store only fingerprints of states,
+ * 0 to store states exactly
+ * @param numbered - flag, indicates if ids of states are needed, bitstate
+ * set isn't made then
+ * @return set, which should be deleted by caller
+ */
+StateSet* MakeStateSet(const StateLayout& layout, const std::vector<size_t>& fields, size_t capacity, double max_load,
+                       size_t bitmap_budget, size_t bitstate_size, unsigned int fingerprint_bits, bool numbered);
+
+#endif //STATE_SET_H
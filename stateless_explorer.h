@@ -0,0 +1,278 @@
+/******************************************************************************
+ * File: stateless_explorer.h
+ * Description: exploration of thread schedules without set of generated
+ *              states, with dynamic partial-order reduction and sleep sets.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef STATELESS_EXPLORER_H
+#define STATELESS_EXPLORER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "partial_order.h"
+#include "state_codec.h"
+
+/**
+ * @brief statistics of stateless exploration
+ */
+struct StatelessStats
+{
+/**
+ * @brief number of explored complete schedules
+ */
+    size_t schedules;
+/**
+ * @brief number of schedules, cut because all enabled steps are in sleep set
+ */
+    size_t sleep_blocked;
+/**
+ * @brief number of enabled steps, never taken because they commute with taken ones
+ */
+    size_t pruned_steps;
+/**
+ * @brief number of executed steps
+ */
+    size_t steps;
+/**
+ * @brief number of schedules, cut by depth limit
+ */
+    size_t cut;
+};
+
+/**
+ * @brief explores schedules of threads by depth-first search, keeping only
+ * current trace. Backtracking points are added where the last step of
+ * other thread conflicts with enabled step (Flanagan and Godefroid dynamic
+ * partial-order reduction), sleep sets skip steps, whose commuted orders
+ * are already explored. Memory is proportional to depth of trace.
+ * Model should have methods
+ * size_t Threads() const - number of threads, not more than 32,
+ * bool Enabled(const PackedState& state, size_t thread) const,
+ * const Access& Next(const PackedState& state, size_t thread) const -
+ *     access of step, which thread makes from state,
+ * void Step(PackedState& state, size_t thread) - step in place,
+ * void Finish(const PackedState& state) - called at the end of every schedule.
+ */
+template <class Model>
+class StatelessExplorer
+{
+public:
+/**
+ * @brief class constructor
+ * @param model - model of threads
+ * @param max_depth - maximal number of steps in schedule
+ */
+    StatelessExplorer(Model& model, size_t max_depth):m_model(model)
+                                                     ,m_max_depth(max_depth)
+                                                     ,m_trace()
+    {
+        StatelessStats stats = {0, 0, 0, 0, 0};
+        m_stats = stats;
+    }
+
+/**
+ * @brief explores all schedules from initial state
+ * @param initial - initial state
+ */
+    void Run(const PackedState& initial)
+    {
+        size_t threads = m_model.Threads();
+        m_trace.clear();
+        m_trace.push_back(Frame());
+        m_trace.back().Init(initial, 0, threads);
+        while(!m_trace.empty())
+        {
+            size_t depth = m_trace.size() - 1;
+            Frame& top = m_trace.back();
+            if(!top.visited)
+            {
+                top.visited = true;
+                top.enabled = 0;
+                for(size_t p = 0; p < threads; ++p)
+                    if(m_model.Enabled(top.state, p))
+                        top.enabled |= uint32_t(1) << p;
+                if(top.enabled == 0)
+                {
+                    ++m_stats.schedules;
+                    m_model.Finish(top.state);
+                    m_trace.pop_back();
+                    continue;
+                }
+                if(depth >= m_max_depth)
+                {
+                    ++m_stats.cut;
+                    m_trace.pop_back();
+                    continue;
+                }
+                for(size_t p = 0; p < threads; ++p)
+                    if(top.enabled & (uint32_t(1) << p))
+                        AddBacktrack(p);
+                uint32_t awake = top.enabled & ~top.sleep;
+                if(awake == 0)
+                {
+                    ++m_stats.sleep_blocked;
+                    m_trace.pop_back();
+                    continue;
+                }
+                top.backtrack |= awake & (~awake + 1);
+            }
+            uint32_t candidates = top.backtrack & ~top.done & ~top.sleep;
+            if(candidates == 0)
+            {
+                // steps, which were never taken from state
+                uint32_t skipped = top.enabled & ~top.done;
+                for(; skipped != 0; skipped &= skipped - 1)
+                    ++m_stats.pruned_steps;
+                m_trace.pop_back();
+                continue;
+            }
+            size_t thread = 0;
+            while(!(candidates & (uint32_t(1) << thread)))
+                ++thread;
+            top.done |= uint32_t(1) << thread;
+            top.thread = thread;
+            top.access = m_model.Next(top.state, thread);
+            // sleeping steps, independent with taken one, stay asleep after it
+            uint32_t sleep = 0;
+            for(size_t q = 0; q < threads; ++q)
+                if((top.sleep & (uint32_t(1) << q)) && Independent(m_model.Next(top.state, q), top.access))
+                    sleep |= uint32_t(1) << q;
+            top.sleep |= uint32_t(1) << thread;
+            UpdateClock(depth);
+            PackedState next = top.state;
+            m_model.Step(next, thread);
+            ++m_stats.steps;
+            m_trace.push_back(Frame());
+            m_trace.back().Init(next, sleep, threads);
+        }
+    }
+
+/**
+ * @brief statistics of last exploration
+ */
+    const StatelessStats& Stats() const
+    {
+        return m_stats;
+    }
+private:
+/**
+ * @brief state of trace and step, taken from it
+ */
+    struct Frame
+    {
+        PackedState state;
+        bool visited;
+        uint32_t enabled;
+        uint32_t backtrack;
+        uint32_t done;
+        uint32_t sleep;
+        size_t thread;
+        Access access;
+        std::vector<size_t> clock;
+
+        void Init(const PackedState& from, uint32_t sleep_set, size_t threads)
+        {
+            state = from;
+            visited = false;
+            enabled = 0;
+            backtrack = 0;
+            done = 0;
+            sleep = sleep_set;
+            thread = 0;
+            clock.assign(threads, 0);
+        }
+    };
+
+/**
+ * @brief checks if steps conflict
+ * @param left - access of first step
+ * @param right - access of second step
+ */
+    static bool Dependent(const Access& left, const Access& right)
+    {
+        return !Independent(left, right);
+    }
+
+/**
+ * @brief calculates vector clock of step, taken from trace frame:
+ * step happens after previous step of its thread and after all
+ * conflicting steps of other threads
+ * @param index - index of frame
+ */
+    void UpdateClock(size_t index)
+    {
+        Frame& frame = m_trace[index];
+        frame.clock.assign(frame.clock.size(), 0);
+        for(size_t j = 0; j < index; ++j)
+        {
+            const Frame& prev = m_trace[j];
+            if(prev.thread != frame.thread && !Dependent(prev.access, frame.access))
+                continue;
+            for(size_t p = 0; p < frame.clock.size(); ++p)
+                if(prev.clock[p] > frame.clock[p])
+                    frame.clock[p] = prev.clock[p];
+        }
+        // clock values are indexes of frames plus one, zero means no step
+        frame.clock[frame.thread] = index + 1;
+    }
+
+/**
+ * @brief adds backtracking point for enabled step of thread in last state:
+ * the last conflicting step of other thread, which doesn't happen before
+ * thread, should be tried in other order
+ * @param thread - enabled thread in last state of trace
+ */
+    void AddBacktrack(size_t thread)
+    {
+        size_t top = m_trace.size() - 1;
+        const Access& next = m_model.Next(m_trace[top].state, thread);
+        // clock of last step of thread
+        const std::vector<size_t>* last_clock = NULL;
+        for(size_t j = top; j > 0; --j)
+        {
+            if(m_trace[j - 1].thread == thread)
+            {
+                last_clock = &m_trace[j - 1].clock;
+                break;
+            }
+        }
+        for(size_t i = top; i > 0; --i)
+        {
+            Frame& frame = m_trace[i - 1];
+            if(frame.thread == thread || !Dependent(frame.access, next))
+                continue;
+            if(last_clock && i <= (*last_clock)[frame.thread])
+                return;
+            if(frame.enabled & (uint32_t(1) << thread))
+                frame.backtrack |= uint32_t(1) << thread;
+            else
+                frame.backtrack |= frame.enabled;
+            return;
+        }
+    }
+
+/**
+ * @brief model of threads
+ */
+    Model& m_model;
+
+/**
+ * @brief maximal number of steps in schedule
+ */
+    size_t m_max_depth;
+
+/**
+ * @brief current trace
+ */
+    std::vector<Frame> m_trace;
+
+/**
+ * @brief statistics of exploration
+ */
+    StatelessStats m_stats;
+};
+
+#endif //STATELESS_EXPLORER_H
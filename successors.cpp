@@ -0,0 +1,81 @@
+/******************************************************************************
+ * File: successors.cpp
+ * Description: steps of threads with reductions, shared by both state makers.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "successors.h"
+using namespace std;
+
+/**
+ * @brief do step of thread with active reductions of one successor
+ * @param program - explored program
+ * @param state - state of program, changed in place
+ * @param thread - number of thread
+ * @param reductions - reductions of successor
+ * @param kept - mask of fields, which aren't reset even if dead
+ * @return first done transition, NULL if thread is finished or blocked
+ */
+const Transition* MoveThread(const Program& program, PackedState& state, size_t thread, const Reductions& reductions,
+                             const PackedState& kept)
+{
+    const Transition* transition = reductions.blocks ? program.StepBlock(state, thread) : program.Step(state, thread);
+    if(!transition)
+        return NULL;
+    if(reductions.live)
+        program.ResetDead(state, thread, kept);
+    // replicas have equal code, so permuted successors are merged by table
+    if(reductions.symmetric)
+        program.Canonicalize(state);
+    return transition;
+}
+
+/**
+ * @brief finds step of one thread, which is enough by partial-order
+ * reduction: it commutes with everything other threads can still do and
+ * doesn't lead to generated state, so other steps aren't postponed forever
+ * @param program - explored program
+ * @param state - state of program
+ * @param visited - generated states
+ * @param reductions - reductions of successor
+ * @param kept - mask of fields, which aren't reset even if dead
+ * @param next - successor by found step
+ * @param thread - number of thread of found step
+ * @return first done transition of found step, NULL if steps of all
+ * threads are taken
+ */
+const Transition* AmpleStep(const Program& program, const PackedState& state, const StateSet& visited, const Reductions& reductions,
+                            const PackedState& kept, PackedState& next, size_t& thread)
+{
+    size_t threads = program.Threads();
+    size_t active = 0;
+    for(size_t i = 0; i < threads; ++i)
+        if(program.Pc(state, i) != program.End(i))
+            ++active;
+    if(active < 2)
+        return NULL;
+    for(size_t i = 0; i < threads; ++i)
+    {
+        next = state;
+        const Transition* transition = reductions.blocks ? program.StepBlock(next, i) : program.Step(next, i);
+        if(!transition)
+            continue;
+        if(reductions.live)
+            program.ResetDead(next, i, kept);
+        bool independent = true;
+        for(size_t j = 0; j < threads && independent; ++j)
+            independent = j == i || Independent(program.Current(state, i), program.Future(state, j));
+        if(!independent)
+            continue;
+        if(reductions.symmetric)
+            program.Canonicalize(next);
+        if(!visited.Contains(next))
+        {
+            thread = i;
+            return transition;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+ * File: successors.h
+ * Description: steps of threads with reductions, shared by both state makers.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef SUCCESSORS_H
+#define SUCCESSORS_H
+
+#include <stddef.h>
+#include "program.h"
+#include "state_codec.h"
+#include "state_set.h"
+
+/**
+ * @brief flags of reductions, which are applied to every successor
+ */
+struct Reductions
+{
+/**
+ * @brief flag, indicates if successors are canonicalized by symmetry of replicas
+ */
+    bool symmetric;
+/**
+ * @brief flag, indicates if dead local variables are reset
+ */
+    bool live;
+/**
+ * @brief flag, indicates if fused local steps are done at once
+ */
+    bool blocks;
+};
+
+/**
+ * @brief do step of thread with active reductions of one successor
+ * @param program - explored program
+ * @param state - state of program, changed in place
+ * @param thread - number of thread
+ * @param reductions - reductions of successor
+ * @param kept - mask of fields, which aren't reset even if dead
+ * @return first done transition, NULL if thread is finished or blocked
+ */
+const Transition* MoveThread(const Program& program, PackedState& state, size_t thread, const Reductions& reductions,
+                             const PackedState& kept);
+
+/**
+ * @brief finds step of one thread, which is enough by partial-order
+ * reduction: it commutes with everything other threads can still do and
+ * doesn't lead to generated state, so other steps aren't postponed forever
+ * @param program - explored program
+ * @param state - state of program
+ * @param visited - generated states
+ * @param reductions - reductions of successor
+ * @param kept - mask of fields, which aren't reset even if dead
+ * @param next - successor by found step
+ * @param thread - number of thread of found step
+ * @return first done transition of found step, NULL if steps of all
+ * threads are taken
+ */
+const Transition* AmpleStep(const Program& program, const PackedState& state, const StateSet& visited, const Reductions& reductions,
+                            const PackedState& kept, PackedState& next, size_t& thread);
+
+#endif //SUCCESSORS_H
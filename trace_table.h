@@ -0,0 +1,132 @@
+/******************************************************************************
+ * File: trace_table.h
+ * Description: parents of generated states for reconstruction of traces.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef TRACE_TABLE_H
+#define TRACE_TABLE_H
+
+#include <algorithm>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "state_codec.h"
+
+/**
+ * @brief id of initial state, which has no parent
+ */
+const uint32_t NoParent = ~uint32_t(0);
+
+/**
+ * @brief index of transition, which doesn't fit record of trace
+ */
+const uint16_t NoTransition = ~uint16_t(0);
+
+/**
+ * @brief state, waiting for exploration, with its parent
+ */
+struct TracedState
+{
+    PackedState state;
+/**
+ * @brief id of parent, NoParent for initial state
+ */
+    uint32_t parent;
+/**
+ * @brief number of thread, which made step from parent
+ */
+    size_t thread;
+/**
+ * @brief index of transition of step from parent
+ */
+    size_t transition;
+};
+
+/**
+ * @brief parent of generated state and step from it, 8 bytes per state
+ */
+struct TraceRecord
+{
+    uint32_t parent;
+/**
+ * @brief index of transition of step, NoTransition if it doesn't fit
+ */
+    uint16_t transition;
+    uint16_t thread;
+};
+
+/**
+ * @brief parents of generated states. States get dense ids in order of
+ * generation, and only record with 32-bit id of parent and step from it is
+ * kept for every state, so traces are found by steps of threads from
+ * initial state instead of stored paths.
+ */
+class TraceTable
+{
+public:
+/**
+ * @brief class constructor
+ * @param capacity - number of states, allocated before exploration
+ */
+    explicit TraceTable(size_t capacity): m_records()
+    {
+        m_records.reserve(capacity);
+    }
+
+/**
+ * @brief adds generated state
+ * @param parent - id of parent, NoParent for initial state
+ * @param thread - number of thread, which made step from parent
+ * @param transition - index of transition of step
+ * @param id - place for id of state
+ * @return false if ids are exhausted
+ */
+    bool Add(uint32_t parent, size_t thread, size_t transition, uint32_t& id)
+    {
+        if(m_records.size() >= NoParent)
+            return false;
+        id = uint32_t(m_records.size());
+        TraceRecord record = {parent, uint16_t(transition < NoTransition ? transition : NoTransition), uint16_t(thread)};
+        m_records.push_back(record);
+        return true;
+    }
+
+/**
+ * @brief finds steps from initial state to state
+ * @param id - id of state
+ * @param steps - place for records of steps in their order, initial state
+ * has no record
+ */
+    void Trace(uint32_t id, std::vector<TraceRecord>& steps) const
+    {
+        steps.clear();
+        for(; m_records[id].parent != NoParent; id = m_records[id].parent)
+            steps.push_back(m_records[id]);
+        std::reverse(steps.begin(), steps.end());
+    }
+
+/**
+ * @brief number of states
+ */
+    size_t Size() const
+    {
+        return m_records.size();
+    }
+
+/**
+ * @brief removes all states
+ */
+    void Clear()
+    {
+        m_records.clear();
+    }
+private:
+/**
+ * @brief records by ids of states
+ */
+    std::vector<TraceRecord> m_records;
+};
+
+#endif //TRACE_TABLE_H
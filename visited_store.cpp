@@ -0,0 +1,173 @@
+/******************************************************************************
+ * File: visited_store.cpp
+ * Description: hash table of already generated states.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+
+#include "visited_store.h"
+#include "state_codec.h"
+#include <algorithm>
+using namespace std;
+
+/**
+ * @brief control byte of empty slot
+ */
+const uint8_t EmptySlot = 0;
+
+/**
+ * @brief minimal number of slots in table
+ */
+const size_t MinSlots = 64;
+
+/**
+ * @brief class constructor
+ * @param key_words - number of 64-bit words in key
+ * @param capacity - number of states, which can be stored without growing
+ * @param max_load - maximal part of occupied slots, from 0.1 to 0.95
+ */
+VisitedStore::VisitedStore(size_t key_words, size_t capacity, double max_load): m_words(key_words)
+                                                                              , m_max_load(max_load)
+                                                                              , m_size(0)
+                                                                              , m_limit(0)
+                                                                              , m_shift(0)
+                                                                              , m_ctrl()
+                                                                              , m_keys()
+                                                                              , m_ids()
+{
+    if(m_max_load < 0.1) m_max_load = 0.1;
+    if(m_max_load > 0.95) m_max_load = 0.95;
+    size_t slots = MinSlots;
+    while(slots * m_max_load < capacity)
+        slots *= 2;
+    Rehash(slots);
+}
+
+/**
+ * @brief removes all keys, table keeps its slots for next exploration
+ */
+void VisitedStore::Clear()
+{
+    fill(m_ctrl.begin(), m_ctrl.end(), EmptySlot);
+    m_size = 0;
+}
+
+/**
+ * @brief calculates hash of key
+ * @param key - pointer to key words
+ */
+uint64_t VisitedStore::Hash(const uint64_t* key) const
+{
+    return HashWords(key, m_words);
+}
+
+/**
+ * @brief adds key to set, if it isn't stored yet
+ * @param key - pointer to key words
+ * @return true if key was added, false if it was already stored
+ */
+bool VisitedStore::FindOrInsert(const uint64_t* key)
+{
+    size_t id;
+    return FindOrInsert(key, id);
+}
+
+/**
+ * @brief adds key to set, if it isn't stored yet, and gives its id.
+ * Keys are numbered from zero in order of insertion.
+ * @param key - pointer to key words
+ * @param id - place for id of key
+ * @return true if key was added, false if it was already stored
+ */
+bool VisitedStore::FindOrInsert(const uint64_t* key, size_t& id)
+{
+    if(m_size >= m_limit)
+        Rehash(m_ctrl.size() * 2);
+    uint64_t hash = Hash(key);
+    size_t slot;
+    if(Probe(key, hash, slot))
+    {
+        id = m_ids[slot];
+        return false;
+    }
+    m_ctrl[slot] = Tag(hash);
+    for(size_t i = 0; i < m_words; ++i)
+        m_keys[slot * m_words + i] = key[i];
+    id = m_size++;
+    m_ids[slot] = uint32_t(id);
+    return true;
+}
+
+/**
+ * @brief checks if key is stored
+ * @param key - pointer to key words
+ */
+bool VisitedStore::Contains(const uint64_t* key) const
+{
+    size_t slot;
+    return Probe(key, Hash(key), slot);
+}
+
+/**
+ * @brief finds slot of key
+ * @param key - pointer to key words
+ * @param hash - hash of key
+ * @param slot - place for slot of key or empty slot, where key should be placed
+ * @return true if key is stored
+ */
+bool VisitedStore::Probe(const uint64_t* key, uint64_t hash, size_t& slot) const
+{
+    uint8_t tag = Tag(hash);
+    size_t mask = m_ctrl.size() - 1;
+    slot = hash >> m_shift;
+    while(m_ctrl[slot] != EmptySlot)
+    {
+        if(m_ctrl[slot] == tag)
+        {
+            const uint64_t* stored = &m_keys[slot * m_words];
+            size_t i = 0;
+            while(i < m_words && stored[i] == key[i])
+                ++i;
+            if(i == m_words)
+                return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+/**
+ * @brief allocates table with specified number of slots and moves keys there
+ * @param slots - number of slots, power of two
+ */
+void VisitedStore::Rehash(size_t slots)
+{
+    vector<uint8_t> old_ctrl(slots, EmptySlot);
+    vector<uint64_t> old_keys(slots * m_words);
+    vector<uint32_t> old_ids(slots);
+    old_ctrl.swap(m_ctrl);
+    old_keys.swap(m_keys);
+    old_ids.swap(m_ids);
+
+    unsigned int bits = 0;
+    while((size_t(1) << bits) < slots)
+        ++bits;
+    m_shift = 64 - bits;
+    m_limit = size_t(slots * m_max_load);
+    size_t mask = slots - 1;
+    for(size_t old_slot = 0; old_slot < old_ctrl.size(); ++old_slot)
+    {
+        if(old_ctrl[old_slot] == EmptySlot)
+            continue;
+        const uint64_t* key = &old_keys[old_slot * m_words];
+        uint64_t hash = Hash(key);
+        size_t slot = hash >> m_shift;
+        while(m_ctrl[slot] != EmptySlot)
+            slot = (slot + 1) & mask;
+        m_ctrl[slot] = Tag(hash);
+        for(size_t i = 0; i < m_words; ++i)
+            m_keys[slot * m_words + i] = key[i];
+        m_ids[slot] = old_ids[old_slot];
+    }
+}
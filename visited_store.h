@@ -0,0 +1,148 @@
+/******************************************************************************
+ * File: visited_store.h
+ * Description: hash table of already generated states.
+ * Date: March 2013
+ * Author: Valery Bitsoev
+ * Email: valner47@gmail.com
+*******************************************************************************/
+#ifndef VISITED_STORE_H
+#define VISITED_STORE_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief set of states with fixed-width keys.
+ * Open addressing table with linear probing. Every slot has one control
+ * byte (0 for empty slot, otherwise 7 bits of key hash), control bytes are
+ * stored apart from keys, so one cache line covers 64 slots of probe
+ * sequence and keys are touched only if hash bits match.
+ */
+class VisitedStore
+{
+public:
+/**
+ * @brief class constructor
+ * @param key_words - number of 64-bit words in key
+ * @param capacity - number of states, which can be stored without growing
+ * @param max_load - maximal part of occupied slots, from 0.1 to 0.95
+ */
+    VisitedStore(size_t key_words, size_t capacity, double max_load);
+
+/**
+ * @brief adds key to set, if it isn't stored yet
+ * @param key - pointer to key words
+ * @return true if key was added, false if it was already stored
+ */
+    bool FindOrInsert(const uint64_t* key);
+
+/**
+ * @brief adds key to set, if it isn't stored yet, and gives its id.
+ * Keys are numbered from zero in order of insertion.
+ * @param key - pointer to key words
+ * @param id - place for id of key
+ * @return true if key was added, false if it was already stored
+ */
+    bool FindOrInsert(const uint64_t* key, size_t& id);
+
+/**
+ * @brief checks if key is stored
+ * @param key - pointer to key words
+ */
+    bool Contains(const uint64_t* key) const;
+
+/**
+ * @brief removes all keys, table keeps its slots for next exploration
+ */
+    void Clear();
+
+/**
+ * @brief number of stored keys
+ */
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+/**
+ * @brief number of slots in table
+ */
+    size_t Capacity() const
+    {
+        return m_ctrl.size();
+    }
+private:
+/**
+ * @brief calculates hash of key
+ * @param key - pointer to key words
+ */
+    uint64_t Hash(const uint64_t* key) const;
+
+/**
+ * @brief control byte of slot with key: slot number is taken from high
+ * bits of hash, tag from next 7 bits
+ * @param hash - hash of key
+ */
+    uint8_t Tag(uint64_t hash) const
+    {
+        return 0x80 | ((hash >> (m_shift - 7)) & 0x7f);
+    }
+
+/**
+ * @brief finds slot of key
+ * @param key - pointer to key words
+ * @param hash - hash of key
+ * @param slot - place for slot of key or empty slot, where key should be placed
+ * @return true if key is stored
+ */
+    bool Probe(const uint64_t* key, uint64_t hash, size_t& slot) const;
+
+/**
+ * @brief allocates table with specified number of slots and moves keys there
+ * @param slots - number of slots, power of two
+ */
+    void Rehash(size_t slots);
+
+/**
+ * @brief number of 64-bit words in key
+ */
+    size_t m_words;
+
+/**
+ * @brief maximal part of occupied slots
+ */
+    double m_max_load;
+
+/**
+ * @brief number of stored keys
+ */
+    size_t m_size;
+
+/**
+ * @brief number of keys, which cause table growing
+ */
+    size_t m_limit;
+
+/**
+ * @brief shift of hash to get slot number
+ */
+    unsigned int m_shift;
+
+/**
+ * @brief control bytes of slots
+ */
+    std::vector<uint8_t> m_ctrl;
+
+/**
+ * @brief keys of slots, m_words words per slot
+ */
+    std::vector<uint64_t> m_keys;
+
+/**
+ * @brief ids of keys of slots
+ */
+    std::vector<uint32_t> m_ids;
+};
+
+#endif //VISITED_STORE_H